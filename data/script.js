@@ -26,7 +26,11 @@ const App = {
             datasets: { co: [], no2: [], c2h5oh: [], voc: [] }
         }
     },
-    MAX_CHART_DATA_POINTS: 90, // 与后端 HISTORICAL_DATA_POINTS 保持一致
+    MAX_CHART_DATA_POINTS: 128, // 与后端 HISTORICAL_DATA_POINTS 保持一致
+    SENSOR_FRAME_VERSION: 1,    // 与后端 SENSOR_FRAME_VERSION 保持一致
+    historyTier: 'raw',        // 当前图表显示的历史层级: raw / minute / hour
+    pendingHistory: [],        // 分片接收中的历史数据
+    liveData: null,            // 合并增量消息后的最新实时数据
 
     // 2. 初始化方法
     init() {
@@ -51,6 +55,9 @@ const App = {
         if (document.getElementById('tempHumChart')) { // 主页
             this.initTempHumChart();
             this.initGasChart();
+            document.querySelectorAll('.tier-button').forEach(btn => {
+                btn.addEventListener('click', () => this.setHistoryTier(btn.dataset.tier));
+            });
         }
         if (document.getElementById('wifiConfigForm')) { // 设置页
             this.setupSettingsPageListeners();
@@ -118,6 +125,7 @@ const App = {
         this.updateConnectionBanner('ws_connecting', 'connecting');
         console.log(`Attempting to connect to WebSocket at ${gateway}`);
         this.websocket = new WebSocket(gateway);
+        this.websocket.binaryType = 'arraybuffer';
 
         this.websocket.onopen = (event) => this.onWsOpen(event);
         this.websocket.onmessage = (event) => this.onWsMessage(event);
@@ -130,15 +138,24 @@ const App = {
         this.wsReconnectAttempts = 0;
         this.updateConnectionBanner('ws_connected', 'connected', true);
 
+        // 实时数据改用二进制帧 (服务器不支持该版本时继续发送 JSON)
+        this.sendMessage({ action: "setProtocol", binary: true, version: this.SENSOR_FRAME_VERSION });
+
         // 连接成功后根据页面请求初始数据
         if (document.getElementById('wifiConfigForm')) {
             this.sendMessage({ action: "getCurrentSettings" });
         } else if (document.getElementById('tempHumChart')) {
-            setTimeout(() => this.sendMessage({ action: "getHistoricalData" }), 500);
+            setTimeout(() => this.requestHistory(), 500);
         }
     },
 
     onWsMessage(event) {
+        if (event.data instanceof ArrayBuffer) {
+            const frame = this.decodeSensorFrame(event.data);
+            if (frame) this.handleSensorData(this.mergeSensorData(frame));
+            return;
+        }
+
         let data;
         try {
             data = JSON.parse(event.data);
@@ -148,9 +165,9 @@ const App = {
         }
 
         const handler = {
-            'sensorData': (d) => this.handleSensorData(d),
+            'sensorData': (d) => this.handleSensorData(this.mergeSensorData(d)),
             'wifiStatus': (d) => this.handleWifiStatus(d),
-            'historicalData': (d) => this.populateChartsWithHistoricalData(d.history),
+            'historicalData': (d) => this.handleHistoricalData(d),
             'settingsData': (d) => this.populateSettingsForm(d.settings),
             'wifiScanResults': (d) => this.displayWifiScanResults(d),
             'connectWifiStatus': (d) => this.updateStatusMessage('connect-wifi-status', d.message, d.success ? 'success' : 'failed'),
@@ -166,6 +183,7 @@ const App = {
                 this.updateStatusMessage('general-status', d.message, 'failed');
             },
             'scanStatus': (d) => this.updateStatusMessage('scan-status', d.message, 'neutral'),
+            'protocolAck': (d) => console.log(`Live data protocol: ${d.binary ? 'binary v' + d.version : 'JSON'}`),
         }[data.type];
 
         if (handler) {
@@ -192,6 +210,48 @@ const App = {
         this.updateConnectionBanner('ws_error', 'error');
     },
 
+    // 解码实时数据二进制帧 (布局见 src/sensor_frame.h), 返回与 JSON sensorData 相同结构的对象
+    decodeSensorFrame(buffer) {
+        if (buffer.byteLength < 36) return null;
+        const view = new DataView(buffer);
+        if (view.getUint8(0) !== 0x53 || view.getUint8(1) !== this.SENSOR_FRAME_VERSION || view.getUint8(2) !== 0x01) {
+            console.warn('Unknown binary frame ignored.');
+            return null;
+        }
+        const flags = view.getUint8(3);
+        const timeIsRelative = (flags & 0x01) !== 0;
+        const label = view.getUint32(8, true);
+        const statusNames = ['normal', 'warning', 'disconnected', 'initializing'];
+        const status = (offset, high) => {
+            const v = high ? view.getUint8(offset) >> 4 : view.getUint8(offset) & 0x0F;
+            return statusNames[v] || 'unknown';
+        };
+        const gas = (offset) => {
+            const v = view.getFloat32(offset, true);
+            return Number.isNaN(v) ? null : v;
+        };
+        const pad = (n) => String(n).padStart(2, '0');
+        const days = Math.floor(label / 86400);
+        const hh = pad(Math.floor(label % 86400 / 3600));
+        const mm = pad(Math.floor(label % 3600 / 60));
+        const timeStr = (timeIsRelative && days > 0) ? `D${days} ${hh}:${mm}` : `${hh}:${mm}:${pad(label % 60)}`;
+
+        return {
+            type: 'sensorData',
+            temperature: (flags & 0x02) ? view.getInt16(12, true) : null,
+            humidity: (flags & 0x04) ? view.getUint16(14, true) / 100 : null,
+            gasPpm: { co: gas(16), no2: gas(20), c2h5oh: gas(24), voc: gas(28) },
+            tempStatus: status(32, false),
+            humStatus: status(32, true),
+            gasCoStatus: status(33, false),
+            gasNo2Status: status(33, true),
+            gasC2h5ohStatus: status(34, false),
+            gasVocStatus: status(34, true),
+            timeIsRelative,
+            timeStr
+        };
+    },
+
     sendMessage(obj) {
         if (this.websocket && this.websocket.readyState === WebSocket.OPEN) {
             this.websocket.send(JSON.stringify(obj));
@@ -201,6 +261,18 @@ const App = {
     },
 
     // 4. 数据处理和UI更新
+    // 服务器只在数值超出死区时发送变化的字段 (delta: true), 与上一次的完整数据合并
+    mergeSensorData(data) {
+        if (!data.delta || !this.liveData) {
+            this.liveData = data;
+            return data;
+        }
+        const merged = { ...this.liveData, ...data, gasPpm: { ...this.liveData.gasPpm, ...(data.gasPpm || {}) } };
+        delete merged.delta;
+        this.liveData = merged;
+        return merged;
+    },
+
     handleSensorData(data) {
         this.updateElementText('tempVal', data.temperature !== null ? data.temperature : '--');
         this.updateElementText('humVal', data.humidity !== null ? data.humidity : '--');
@@ -216,7 +288,8 @@ const App = {
         this.updateStatusIndicator('gasC2h5oh-status-indicator', data.gasC2h5ohStatus);
         this.updateStatusIndicator('gasVoc-status-indicator', data.gasVocStatus);
 
-        if (data.timeStr) {
+        // 聚合层级的图表只显示历史数据, 实时数据点仅追加到原始层级
+        if (data.timeStr && this.historyTier === 'raw') {
             this.addDataToTempHumChart(data.timeStr, data.temperature, data.humidity);
             this.addDataToGasChart(data.timeStr, data.gasPpm);
         }
@@ -402,6 +475,38 @@ const App = {
         }
     },
 
+    setHistoryTier(tier) {
+        if (!tier || tier === this.historyTier) return;
+        this.historyTier = tier;
+        this.pendingHistory = [];
+        document.querySelectorAll('.tier-button').forEach(btn => {
+            btn.classList.toggle('active', btn.dataset.tier === tier);
+        });
+        this.requestHistory();
+    },
+
+    // 服务器按块返回; 原始层只请求图表能保留的最新点数
+    requestHistory() {
+        const request = { action: 'getHistoricalData', tier: this.historyTier };
+        if (this.historyTier === 'raw') request.limit = this.MAX_CHART_DATA_POINTS;
+        this.sendMessage(request);
+    },
+
+    // 历史数据分多条消息发送 (part 从0开始, final 表示最后一条)
+    handleHistoricalData(data) {
+        if ((data.tier || 'raw') !== this.historyTier) return;
+        if (data.part === undefined) {
+            this.populateChartsWithHistoricalData(data.history);
+            return;
+        }
+        if (data.part === 0) this.pendingHistory = [];
+        if (Array.isArray(data.history)) this.pendingHistory.push(...data.history);
+        if (data.final) {
+            this.populateChartsWithHistoricalData(this.pendingHistory);
+            this.pendingHistory = [];
+        }
+    },
+
     populateChartsWithHistoricalData(history) {
         if (!history || !Array.isArray(history)) return;
 
@@ -471,7 +576,7 @@ const App = {
     },
 
     handleStartCalibration() {
-        const confirmationText = this.translations[this.currentLang]?.calibration_confirm || "请确认设备已在洁净空气中且稳定。校准将开始，耗时约1分钟。";
+        const confirmationText = this.translations[this.currentLang]?.calibration_confirm || "请确认设备已在洁净空气中且稳定。校准将开始，读数稳定后自动完成。";
         if (confirm(confirmationText)) {
             this.sendMessage({ action: 'startCalibration' });
             this.updateStatusMessage('calibration-status', this.translations[this.currentLang]?.calibration_starting || '正在启动校准...', 'connecting');
@@ -503,11 +608,17 @@ const App = {
                 this.updateElementText('measured_r0_c2h5oh', data.measuredR0.c2h5oh?.toFixed(2) || '--');
                 this.updateElementText('measured_r0_voc', data.measuredR0.voc?.toFixed(2) || '--');
                 break;
-            case 2: // Completed
-                progressBar.style.width = '100%';
-                progressBar.textContent = '100%';
-                caliButton.disabled = true;
-                this.updateStatusMessage('calibration-status', this.translations[this.currentLang]?.calibration_success_reboot || '校准成功！设备将在3秒后重启。', 'success');
+            case 2: // Completed (新R0已在运行中生效, 无需重启)
+                progressContainer.style.display = 'none';
+                caliForm.classList.remove('calibrating');
+                caliButton.disabled = false;
+                this.updateStatusMessage('calibration-status', this.translations[this.currentLang]?.calibration_success || '校准成功！新的R0值已生效并保存。', 'success');
+                if (data.currentR0) {
+                    this.updateElementText('current_r0_co', data.currentR0.co?.toFixed(2) || '--');
+                    this.updateElementText('current_r0_no2', data.currentR0.no2?.toFixed(2) || '--');
+                    this.updateElementText('current_r0_c2h5oh', data.currentR0.c2h5oh?.toFixed(2) || '--');
+                    this.updateElementText('current_r0_voc', data.currentR0.voc?.toFixed(2) || '--');
+                }
                 break;
             case 3: // Failed
                 progressContainer.style.display = 'none';
@@ -622,10 +733,14 @@ const App = {
         }
         if (settings.r0Values) {
             const r0 = settings.r0Values;
-            this.updateElementText('current_r0_co', r0.co?.toFixed(2) || '--');
-            this.updateElementText('current_r0_no2', r0.no2?.toFixed(2) || '--');
-            this.updateElementText('current_r0_c2h5oh', r0.c2h5oh?.toFixed(2) || '--');
-            this.updateElementText('current_r0_voc', r0.voc?.toFixed(2) || '--');
+            const drift = settings.r0Drift || {};
+            // 基线跟踪产生的漂移显示在当前R0之后, 如 "21.30 (+6.5%)"
+            const formatR0 = (gas) => {
+                if (r0[gas] == null) return '--';
+                const d = drift[gas];
+                return (d != null && Math.abs(d) >= 0.05) ? `${r0[gas].toFixed(2)} (${d > 0 ? '+' : ''}${d.toFixed(1)}%)` : r0[gas].toFixed(2);
+            };
+            ['co', 'no2', 'c2h5oh', 'voc'].forEach(gas => this.updateElementText(`current_r0_${gas}`, formatR0(gas)));
         }
         this.updateElementValue('wifiSSID', settings.currentSSID);
         this.updateElementValue('ledBrightness', settings.ledBrightness);
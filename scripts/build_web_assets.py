@@ -0,0 +1,148 @@
+# =================================================================================
+# == 网页资源构建脚本 (PlatformIO extra_script, 也可直接用 python 运行) ==
+# == 职责: 将 data/ 下的网页资源 gzip 压缩到 .pio/web_data/ (SPIFFS 镜像目录),
+# ==       并生成包含内容哈希的资源清单 assets.json, 供服务器生成 ETag.
+# ==       HTML 中引用的 css/js 改写为带哈希版本号的 URL, 以便浏览器长期缓存.
+# ==       同时生成 .pio/web_embed/web_assets_data.h (压缩数据的 constexpr 数组),
+# ==       构建标志含 -DEMBED_WEB_ASSETS 时加入头文件路径, 网页资源随固件烧录到 flash.
+# =================================================================================
+
+import gzip
+import hashlib
+import json
+import os
+import re
+
+# 参与构建的资源. HTML 最后处理, 因为其内容依赖其他资源的哈希.
+VERSIONED_ASSETS = ["style.css", "script.js", "chart.min.js"]
+PLAIN_ASSETS = ["lang.json"]
+HTML_ASSETS = ["index.html", "settings.html"]
+
+MANIFEST_NAME = "assets.json"
+EMBED_HEADER_NAME = "web_assets_data.h"
+HASH_LEN = 16
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LEN]
+
+
+def write_if_changed(path, data):
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == data:
+                return
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def version_references(html, hashes):
+    # href="style.css" / src="script.js" -> href="style.css?v=<hash>"
+    for name, digest in hashes.items():
+        pattern = r'((?:href|src)=")(/?%s)(")' % re.escape(name)
+        html = re.sub(pattern, r"\g<1>\g<2>?v=%s\g<3>" % digest[:8], html)
+    return html
+
+
+def c_byte_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def write_embed_header(path, entries):
+    out = [
+        "// 由 scripts/build_web_assets.py 自动生成, 请勿手动编辑",
+        "#ifndef WEB_ASSETS_DATA_H",
+        "#define WEB_ASSETS_DATA_H",
+        "",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "// gzip 压缩后的网页资源. constexpr 数组位于 .rodata, 在 ESP32 上直接映射自 flash.",
+        "struct EmbeddedWebAssetData {",
+        "    const char* path;",
+        "    const char* etag;",
+        "    const uint8_t* data;",
+        "    size_t length;",
+        "};",
+        "",
+    ]
+    for index, (name, digest, compressed) in enumerate(entries):
+        out.append("// /%s (%d B gzip)" % (name, len(compressed)))
+        out.append("constexpr uint8_t WEB_ASSET_DATA_%d[] = {" % index)
+        out.append(c_byte_array(compressed))
+        out.append("};")
+        out.append("")
+    out.append("constexpr EmbeddedWebAssetData EMBEDDED_WEB_ASSETS[] = {")
+    for index, (name, digest, compressed) in enumerate(entries):
+        out.append('    { "/%s", "%s", WEB_ASSET_DATA_%d, sizeof(WEB_ASSET_DATA_%d) },' % (name, digest, index, index))
+    out.append("};")
+    out.append("constexpr size_t EMBEDDED_WEB_ASSET_COUNT = sizeof(EMBEDDED_WEB_ASSETS) / sizeof(EMBEDDED_WEB_ASSETS[0]);")
+    out.append("")
+    out.append("#endif // WEB_ASSETS_DATA_H")
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    write_if_changed(path, ("\n".join(out) + "\n").encode("utf-8"))
+
+
+def build_web_assets(source_dir, output_dir, embed_header_path):
+    os.makedirs(output_dir, exist_ok=True)
+    manifest = {}
+    hashes = {}
+    entries = []
+    total_raw = 0
+    total_gz = 0
+
+    for name in VERSIONED_ASSETS + PLAIN_ASSETS + HTML_ASSETS:
+        with open(os.path.join(source_dir, name), "rb") as f:
+            data = f.read()
+        if name in HTML_ASSETS:
+            data = version_references(data.decode("utf-8"), hashes).encode("utf-8")
+
+        digest = content_hash(data)
+        if name in VERSIONED_ASSETS:
+            hashes[name] = digest
+        # mtime=0 保证相同内容得到相同的压缩结果
+        compressed = gzip.compress(data, compresslevel=9, mtime=0)
+        write_if_changed(os.path.join(output_dir, name + ".gz"), compressed)
+
+        manifest["/" + name] = {"etag": digest, "size": len(data), "gz": len(compressed)}
+        entries.append((name, digest, compressed))
+        total_raw += len(data)
+        total_gz += len(compressed)
+
+    # 删除不再属于资源列表的旧文件, 避免被打包进 SPIFFS 镜像
+    expected = set(n + ".gz" for n in VERSIONED_ASSETS + PLAIN_ASSETS + HTML_ASSETS)
+    expected.add(MANIFEST_NAME)
+    for name in os.listdir(output_dir):
+        if name not in expected:
+            os.remove(os.path.join(output_dir, name))
+
+    manifest_data = json.dumps(manifest, separators=(",", ":"), sort_keys=True).encode("utf-8")
+    write_if_changed(os.path.join(output_dir, MANIFEST_NAME), manifest_data)
+    write_embed_header(embed_header_path, entries)
+    print("[web_assets] %d 个文件: %d B -> %d B (gzip)" % (len(manifest), total_raw, total_gz))
+    return manifest
+
+
+def embed_enabled(build_flags):
+    # PlatformIO 返回的 build_flags 为按行拆分的列表 (如 ["-DEMBED_WEB_ASSETS"]), 一行中可含多个标志
+    if isinstance(build_flags, str):
+        build_flags = [build_flags]
+    return any("EMBED_WEB_ASSETS" in flag for flag in build_flags)
+
+
+try:
+    Import("env")  # noqa: F821 (由 PlatformIO 的 SCons 环境提供)
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    env = None
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+EMBED_DIR = os.path.join(PROJECT_DIR, ".pio", "web_embed")
+build_web_assets(os.path.join(PROJECT_DIR, "data"), os.path.join(PROJECT_DIR, ".pio", "web_data"),
+                 os.path.join(EMBED_DIR, EMBED_HEADER_NAME))
+
+if env is not None and embed_enabled(env.GetProjectOption("build_flags", [])):
+    env.Append(CPPPATH=[EMBED_DIR])
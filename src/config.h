@@ -26,12 +26,16 @@
 #define I2C_SDA_PIN 8  // ESP32-S3 默认 I2C SDA
 #define I2C_SCL_PIN 9  // ESP32-S3 默认 I2C SCL
 #define GAS_SENSOR_I2C_ADDRESS 0x08 // Grove Multichannel Gas Sensor V2 默认地址
+#define GAS_SENSOR_RETRY_MIN_MS 2000   // 气体传感器离线后的首次重试间隔 (毫秒), 之后每次失败翻倍
+#define GAS_SENSOR_RETRY_MAX_MS 60000  // 离线重试间隔上限 (毫秒)
 
 // ==========================================================================
 // == 传感器引脚定义 ==
 // ==========================================================================
 #define DHT_PIN 4    // DHT11 数据引脚
-#define DHT_TYPE DHT11 // DHT传感器类型
+#define DHT_RMT_RX_CHANNEL 4       // DHT11 脉冲捕获使用的 RMT 接收通道 (ESP32-S3 为 4~7)
+#define DHT_START_SIGNAL_MS 20     // 主机起始信号 (拉低总线) 时长, DHT11 要求至少18ms
+#define DHT_RESPONSE_TIMEOUT_MS 50 // 释放总线后等待完整一帧的最长时间
 
 #define BUZZER_PIN 10 // 蜂鸣器引脚
 
@@ -48,8 +52,25 @@
 #define GAS_SENSOR_WARMUP_PERIOD_MS 60000 // 气体传感器物理预热时间 (毫秒, 60秒)
 #define SENSOR_VCC 3.3f                   // 传感器供电电压
 #define ADC_RESOLUTION 4095.0f            // Grove Gas Sensor v2 使用12位ADC, 0-4095
-#define CALIBRATION_SAMPLE_COUNT 100      // 校准时的采样次数
-#define CALIBRATION_SAMPLE_INTERVAL_MS 200 // 校准时每次采样的间隔 (毫larg)
+#define CALIBRATION_MIN_SAMPLES 100       // 在线校准判定稳定所需的最少样本数 (按过采样速率, 约5秒)
+#define CALIBRATION_WINDOW_SAMPLES 600    // 统计窗口: 样本数达到此值仍未稳定则重新统计 (约30秒)
+#define CALIBRATION_STABLE_CV 0.02f       // 各通道 Rs 变异系数 (标准差/均值) 不超过此值视为稳定
+#define CALIBRATION_TIMEOUT_MS 180000     // 预热结束后仍未稳定的最长等待时间 (毫秒)
+
+// 基线漂移跟踪: 在洁净空气 (通道状态正常) 的样本上估计 Rs 的分位数, 每个窗口结束时
+// 让 R0 向估计值缓慢靠拢, 累计漂移限制在校准值附近
+#define BASELINE_WINDOW_SAMPLES 10800      // 每个估计窗口的上报样本数 (2秒一次, 约6小时)
+#define BASELINE_MIN_CLEAN_FRACTION 0.5f   // 窗口内洁净样本比例低于此值时该通道本窗口不调整
+#define BASELINE_QUANTILE_REDUCING 0.9f    // 还原性气体通道 (Rs 随浓度下降): 洁净基线取高分位
+#define BASELINE_QUANTILE_OXIDIZING 0.1f   // 氧化性气体通道 (NO2, Rs 随浓度上升): 洁净基线取低分位
+#define BASELINE_ADJUST_GAIN 0.25f         // 每个窗口向估计值靠拢的比例
+#define BASELINE_MAX_STEP 0.02f            // 每个窗口 R0 的最大相对调整量
+#define BASELINE_MAX_DRIFT 0.3f            // 相对校准 R0 的最大累计漂移
+
+// 模拟数据源 (sensor_simulator.h): 不接传感器时调试网页、报警和历史. 可在构建标志中以 -DSENSOR_SIMULATION=1 开启
+#ifndef SENSOR_SIMULATION
+  #define SENSOR_SIMULATION 0
+#endif
 
 // ==========================================================================
 // == 默认气体传感器 R0 值 (在洁净空气中的电阻) ==
@@ -78,16 +99,90 @@
 // ==========================================================================
 // == SPIFFS 文件系统配置 ==
 // ==========================================================================
-#define SETTINGS_FILE "/settings_v4_cal.json"        // 配置文件名 (版本变更)
-#define HISTORICAL_DATA_FILE "/history_v4_cal.json"  // 历史数据文件名 (版本变更)
+#define LEGACY_SETTINGS_FILE "/settings_v4_cal.json" // 旧版JSON配置文件 (启动时迁移到二进制配置后删除)
+#define CONFIG_SLOT_A_FILE "/cfg_a.bin"              // 二进制配置记录 A/B 槽文件
+#define CONFIG_SLOT_B_FILE "/cfg_b.bin"
+#define CONFIG_RECORD_MAGIC 0x4643                   // 配置记录魔数 ('CF')
+#define CONFIG_SAVE_DEBOUNCE_MS 1500                 // 配置修改后等待此时长无新修改再写入 (合并连续修改)
+#define LEGACY_HISTORICAL_DATA_FILE "/history_v4_cal.json" // 旧版JSON历史数据文件 (启动时删除)
+#define HISTORY_LOG_PREFIX "/hist_v5"                // 历史数据日志分段文件前缀 (/hist_v5_0.bin ...)
+#define HISTORY_LOG_SEGMENT_COUNT 4                  // 历史数据日志分段数量
+#define HISTORY_LOG_RECORDS_PER_SEGMENT 48           // 每个分段的记录数 (轮转时最旧分段被整体覆盖)
+#define ROLLUP_LOG_PREFIX "/hour_v5"                 // 1小时聚合数据日志分段文件前缀
+#define ROLLUP_LOG_SEGMENT_COUNT 5                   // 1小时聚合数据日志分段数量
+#define ROLLUP_LOG_RECORDS_PER_SEGMENT 64            // 1小时聚合数据每个分段的记录数
+#define WEB_ASSET_MANIFEST "/assets.json"            // 网页资源清单 (由 scripts/build_web_assets.py 生成)
+#define WEB_ASSET_MAX_AGE_SEC 31536000               // 带版本号的静态资源缓存时间 (1年)
+
+// 后台存储任务: 串行执行所有 flash 写入, 调用方只提交作业不等待
+#define STORAGE_TASK_STACK_SIZE 4096                 // 存储任务堆栈大小 (Bytes)
+#define STORAGE_TASK_PRIORITY 1                      // 存储任务优先级 (与 loop 任务相同, 低于采样任务)
+#define STORAGE_TASK_CORE 0                          // 存储任务运行的核心 (不与采样任务争用)
+#define STORAGE_QUEUE_DEPTH 16                       // 存储作业队列深度
+#define STORAGE_FLUSH_TIMEOUT_MS 3000                // 重启前等待存储作业完成的最长时间
 
 // ==========================================================================
 // == 数据和更新频率 ==
 // ==========================================================================
 #define SENSOR_READ_INTERVAL_MS 2000       // 传感器读取间隔 (毫秒)
-#define WEBSOCKET_UPDATE_INTERVAL_MS 2000  // WebSocket 数据更新间隔 (毫秒)
-#define HISTORICAL_DATA_SAVE_INTERVAL_MS 300000UL // 历史数据保存到SPIFFS的间隔 (5分钟)
-#define HISTORICAL_DATA_POINTS 90          // 存储的历史数据点数量
+#define WEBSOCKET_UPDATE_INTERVAL_MS 2000  // WebSocket 变化检测间隔 (毫秒)
+
+// 传感器采样任务: 按固定周期独立运行, 优先级高于 loop 任务, 不受网络处理耗时影响
+#define SENSOR_TASK_STACK_SIZE 4096        // 采样任务堆栈大小 (Bytes)
+#define SENSOR_TASK_PRIORITY 2             // 采样任务优先级 (loop 任务为 1)
+#define SENSOR_TASK_CORE 1                 // 采样任务运行的核心
+#define SENSOR_JITTER_REPORT_SAMPLES 30    // 每采样多少次打印一次采样周期抖动统计
+
+// 气体通道过采样: 以较高速率读取并滤波, 每个 SENSOR_READ_INTERVAL_MS 上报一次滤波结果
+#define GAS_OVERSAMPLE_INTERVAL_MS 50      // 过采样间隔 (毫秒, 20Hz), 须整除 SENSOR_READ_INTERVAL_MS
+#define GAS_MEDIAN_WINDOW 5                // 中值滤波窗口 (奇数), 抑制单点尖峰
+#define GAS_EMA_SHIFT 3                    // EMA 系数 1/2^n (n=3 时时间常数约8个样本, 0.4秒)
+
+// 实时数据按变化上报: 只发送变化超出死区的通道 (状态变化总是发送), 并定期发送完整关键帧
+#define LIVE_DEADBAND_TEMP_C 1             // 温度 (°C)
+#define LIVE_DEADBAND_HUM_PCT 0.5f         // 湿度 (%)
+#define LIVE_DEADBAND_CO_PPM 0.05f         // CO (PPM)
+#define LIVE_DEADBAND_NO2_PPM 0.01f        // NO2 (PPM)
+#define LIVE_DEADBAND_C2H5OH_PPM 0.5f      // C2H5OH (PPM)
+#define LIVE_DEADBAND_VOC_PPM 0.05f        // VOC (PPM)
+#define LIVE_KEYFRAME_INTERVAL_MS 30000    // 完整关键帧间隔 (毫秒)
+// 以下三个点数为环形缓冲区容量, 必须是2的幂
+#define HISTORICAL_DATA_POINTS 128         // 存储的历史数据点数量
+#define ROLLUP_MINUTE_POINTS 64            // 1分钟聚合层保留的点数 (约1小时)
+#define ROLLUP_HOUR_POINTS 256             // 1小时聚合层保留的点数 (约10天)
+#define ROLLUP_HOUR_RAM_BUDGET 12800       // 1小时聚合层的内存上限 (字节, 每点48字节, 编译时检查)
+
+// 历史数据按块发送: 每块序列化进固定大小的静态缓冲区, 单次请求的内存占用与历史长度无关
+#define HISTORY_CHUNK_RAW_POINTS 24        // 原始层每条WebSocket消息的点数
+#define HISTORY_CHUNK_ROLLUP_POINTS 8      // 聚合层每条WebSocket消息的点数 (每点含 min/avg/max)
+#define HISTORY_CHUNK_DOC_SIZE 4096        // 单块 JSON 文档容量 (字节)
+#define HISTORY_CHUNK_BUFFER_SIZE 4096     // 单块序列化输出缓冲区 (字节)
+
+// WebSocket 出站消息缓冲池 (web_handler.cpp): 静态分配, 稳态收发不占用堆
+#define WS_MESSAGE_POOL_SIZE 3             // 可同时构建的出站消息数
+#define WS_MESSAGE_DOC_SIZE 2048           // 每条消息的 JSON 文档容量 (字节)
+#define WS_MESSAGE_BUFFER_SIZE 2048        // 每条消息的序列化输出缓冲区 (字节, 不含帧头)
+#define WS_REQUEST_DOC_SIZE 1024           // 客户端请求解析用 JSON 文档容量 (字节)
+#define WIFI_SCAN_MAX_RESULTS 24           // WiFi 扫描结果最多返回的网络数
+
+// 预序列化帧缓存 (web_handler.cpp): 源数据未变化时, 新客户端和重复请求直接发送缓存的帧
+#define WS_CACHED_FRAME_SIZE 1024          // WiFi 状态/传感器关键帧/设置, 每种消息一个缓存 (字节, 不含帧头)
+#define HISTORY_FRAME_CACHE_SIZE 24576     // 最近一次历史数据响应的缓存区 (字节, 可容纳完整原始层 128 点)
+#define HISTORY_FRAME_CACHE_PARTS 16       // 缓存的历史响应最多块数, 超出时不缓存
+
+// 客户端订阅 (web_handler.cpp): 每个客户端按主题和最小间隔接收最新帧, 落后时跳过旧帧
+#define WS_PERF_FRAME_SIZE 3072            // perf 主题帧缓冲区 (字节, 不含帧头)
+#define WS_PERF_DOC_SIZE 4096              // perf 主题/getPerfStats 的 JSON 文档容量 (静态分配, 只在 loop 任务中使用)
+#define WS_SLOW_SEND_US 20000              // 单帧发送耗时超过此值 (微秒) 视为慢客户端
+#define WS_SLOW_BACKOFF_MS 2000            // 慢客户端或发送失败后暂停发送的时间 (毫秒)
+
+// 轮转覆盖最旧分段后, 其余分段仍需容纳完整的历史缓冲区
+#if (HISTORY_LOG_SEGMENT_COUNT - 1) * HISTORY_LOG_RECORDS_PER_SEGMENT < HISTORICAL_DATA_POINTS
+  #error "历史数据日志容量不足: (HISTORY_LOG_SEGMENT_COUNT - 1) * HISTORY_LOG_RECORDS_PER_SEGMENT < HISTORICAL_DATA_POINTS"
+#endif
+#if (ROLLUP_LOG_SEGMENT_COUNT - 1) * ROLLUP_LOG_RECORDS_PER_SEGMENT < ROLLUP_HOUR_POINTS
+  #error "小时聚合日志容量不足: (ROLLUP_LOG_SEGMENT_COUNT - 1) * ROLLUP_LOG_RECORDS_PER_SEGMENT < ROLLUP_HOUR_POINTS"
+#endif
 
 // ==========================================================================
 // == 调试信息输出 ==
@@ -104,6 +199,20 @@
   #define P_PRINTF(fmt, ...)
 #endif
 
+// 分阶段耗时直方图 (perf_stats.h). 可在构建标志中以 -DPERF_STATS_ENABLED=0 关闭, 关闭后不产生任何代码
+#ifndef PERF_STATS_ENABLED
+  #define PERF_STATS_ENABLED 1
+#endif
+#define PERF_REPORT_INTERVAL_MS 300000 // 串口打印耗时统计的间隔 (毫秒), 0 表示不定期打印
+
+// 运行健康采样 (health_monitor.h): 堆内存、任务堆栈余量和 CPU 占用
+#define HEALTH_SAMPLE_INTERVAL_MS 300000   // 采样间隔 (毫秒)
+#define HEALTH_HISTORY_SIZE 64             // 保留的样本数 (2的幂, 64 x 5分钟 约5.3小时)
+#define HEALTH_STACK_WARN_BYTES 512        // 任务堆栈余量低于此值时打印警告
+#define HEALTH_TASK_STATUS_MAX 24          // 读取 CPU 占用时最多枚举的系统任务数
+#define HEALTH_JSON_HISTORY_CAPACITY 16384 // 健康数据 JSON 文档容量 (可含采样历史, 静态分配; WebSocket 不含历史时使用消息缓冲池)
+#define HEALTH_JSON_BUFFER_SIZE 8192       // 健康数据序列化输出缓冲区 (字节, 不含帧头; 满历史且 8 个任务时约 6.5KB)
+
 // ==========================================================================
 // == 蜂鸣器报警配置 ==
 // ==========================================================================
@@ -1,5 +1,8 @@
 #include "data_manager.h"
 #include "config.h"
+#include "history_log.h"
+#include "slot_store.h"
+#include "storage_task.h"
 #include <SPIFFS.h>
 #include <WiFi.h> 
 #include <time.h> 
@@ -7,19 +10,19 @@
 // ==========================================================================
 // == 全局变量定义 ==
 // ==========================================================================
-DeviceState currentState;
 DeviceConfig currentConfig;
 WifiState wifiState;
-CircularBuffer historicalData(HISTORICAL_DATA_POINTS);
+HistoryBuffer historicalData;
+MinuteRollupBuffer minuteRollups;
+HourRollupBuffer hourRollups;
 
-unsigned long lastSensorReadTime = 0;
 unsigned long lastWebSocketUpdateTime = 0;
-unsigned long lastHistoricalDataSaveTime = 0;
 unsigned long gasSensorWarmupEndTime = 0;
 
-// 新增: FreeRTOS 任务句柄和信号量
-TaskHandle_t calibrationTaskHandle = NULL;
-SemaphoreHandle_t calibrationSemaphore = NULL;
+// 数据修订号: 每次修改加一, 供网页端缓存的序列化帧判断是否过期 (只在 loop 任务中修改)
+static uint32_t configRevision = 0;
+static uint32_t historyRevision = 0;
+
 
 
 // ==========================================================================
@@ -31,14 +34,13 @@ DeviceState::DeviceState() :
     tempStatus(SS_INIT), humStatus(SS_INIT),
     gasCoStatus(SS_INIT), gasNo2Status(SS_INIT),
     gasC2h5ohStatus(SS_INIT), gasVocStatus(SS_INIT),
-    buzzerShouldBeActive(false), buzzerStopTime(0), buzzerBeepCount(0),
-    ledBlinkState(false), lastBlinkTime(0),
-    // 新增: 初始化校准状态
-    calibrationState(CAL_IDLE),
-    calibrationProgress(0)
+    buzzerShouldBeActive(false)
 {
     gasPpmValues = {NAN, NAN, NAN, NAN};
     gasRsValues = {NAN, NAN, NAN, NAN};
+}
+
+CalibrationStatus::CalibrationStatus() : state(CAL_IDLE), progress(0), version(0) {
     measuredR0 = {NAN, NAN, NAN, NAN};
 }
 
@@ -58,18 +60,18 @@ DeviceConfig::DeviceConfig() : ledBrightness(DEFAULT_LED_BRIGHTNESS) {
         DEFAULT_R0_C2H5OH,
         DEFAULT_R0_VOC
     };
+    r0Calibrated = r0Values;
 }
 
 WifiState::WifiState() : 
     connectProgress(WIFI_CP_IDLE), connectAttemptStartTime(0),
     connectInitiatorClientNum(255), isScanning(false),
-    scanRequesterClientNum(255), scanStartTime(0) {}
-
-
-CircularBuffer::CircularBuffer(size_t size) : maxSize(size), head(0), tail(0), full(false) {
-    buffer.resize(size);
+    scanRequesterClientNum(255), scanStartTime(0) {
+    ssidToTry[0] = '\0';
+    passwordToTry[0] = '\0';
 }
 
+
 // ==========================================================================
 // == 函数实现 ==
 // ==========================================================================
@@ -82,48 +84,135 @@ void initSPIFFS() {
     }
 }
 
+// ==========================================================================
+// == 配置存储 ==
+// == 配置以定长二进制记录保存在 A/B 双槽中 (见 slot_store.h), 运行时只读写内存中的
+// == currentConfig. saveConfig() 只登记一次待保存, 在 CONFIG_SAVE_DEBOUNCE_MS 内没有
+// == 新的修改后由 processConfigSave() 合并为一次写入. 写入本身由存储任务执行.
+// ==========================================================================
+
+#define CONFIG_RECORD_VERSION 1
+
+struct __attribute__((packed)) ConfigRecord {
+    uint16_t version;
+    int16_t tempMin, tempMax, humMin, humMax;
+    float coPpmMax, no2PpmMax, c2h5ohPpmMax, vocPpmMax;
+    float r0[4];            // CO, NO2, C2H5OH, VOC
+    float r0Calibrated[4];
+    uint8_t ledBrightness;
+    char ssid[33];
+    char password[65];
+};
+static_assert(sizeof(ConfigRecord) <= SLOT_STORE_MAX_PAYLOAD, "ConfigRecord exceeds slot payload limit");
+
+static SlotStore configStore(CONFIG_SLOT_A_FILE, CONFIG_SLOT_B_FILE, CONFIG_RECORD_MAGIC, sizeof(ConfigRecord));
+static const DeviceConfig* pendingConfig = NULL;
+static unsigned long configSaveRequestTime = 0;
+static bool removeLegacyConfigAfterSave = false; // 迁移后首次写入成功再删除旧版文件
+
+#define STORAGE_KEY_CONFIG 1 // 配置写入作业的合并键: 排队中的配置作业只保留最新快照
+
+static void configToRecord(const DeviceConfig& config, ConfigRecord& rec) {
+    memset(&rec, 0, sizeof(rec));
+    rec.version = CONFIG_RECORD_VERSION;
+    rec.tempMin = config.thresholds.tempMin;
+    rec.tempMax = config.thresholds.tempMax;
+    rec.humMin = config.thresholds.humMin;
+    rec.humMax = config.thresholds.humMax;
+    rec.coPpmMax = config.thresholds.coPpmMax;
+    rec.no2PpmMax = config.thresholds.no2PpmMax;
+    rec.c2h5ohPpmMax = config.thresholds.c2h5ohPpmMax;
+    rec.vocPpmMax = config.thresholds.vocPpmMax;
+    const GasResistData& r0 = config.r0Values;
+    const GasResistData& cal = config.r0Calibrated;
+    rec.r0[0] = r0.co; rec.r0[1] = r0.no2; rec.r0[2] = r0.c2h5oh; rec.r0[3] = r0.voc;
+    rec.r0Calibrated[0] = cal.co; rec.r0Calibrated[1] = cal.no2; rec.r0Calibrated[2] = cal.c2h5oh; rec.r0Calibrated[3] = cal.voc;
+    rec.ledBrightness = config.ledBrightness;
+    // 已连接时保存实际连接的 SSID
+    String ssid = WiFi.isConnected() ? WiFi.SSID() : config.currentSsidForSettings;
+    strlcpy(rec.ssid, ssid.c_str(), sizeof(rec.ssid));
+    strlcpy(rec.password, config.currentPasswordForSettings.c_str(), sizeof(rec.password));
+}
+
+static void recordToConfig(const ConfigRecord& rec, DeviceConfig& config) {
+    config.thresholds.tempMin = rec.tempMin;
+    config.thresholds.tempMax = rec.tempMax;
+    config.thresholds.humMin = rec.humMin;
+    config.thresholds.humMax = rec.humMax;
+    config.thresholds.coPpmMax = rec.coPpmMax;
+    config.thresholds.no2PpmMax = rec.no2PpmMax;
+    config.thresholds.c2h5ohPpmMax = rec.c2h5ohPpmMax;
+    config.thresholds.vocPpmMax = rec.vocPpmMax;
+    config.r0Values = {rec.r0[0], rec.r0[1], rec.r0[2], rec.r0[3]};
+    config.r0Calibrated = {rec.r0Calibrated[0], rec.r0Calibrated[1], rec.r0Calibrated[2], rec.r0Calibrated[3]};
+    config.ledBrightness = rec.ledBrightness;
+    char ssid[sizeof(rec.ssid)], password[sizeof(rec.password)];
+    strlcpy(ssid, rec.ssid, sizeof(ssid));
+    strlcpy(password, rec.password, sizeof(password));
+    config.currentSsidForSettings = ssid;
+    config.currentPasswordForSettings = password;
+}
+
+// 从旧版 JSON 配置文件迁移, 成功返回 true
+static bool loadLegacyJsonConfig(DeviceConfig& config) {
+    if (!SPIFFS.exists(LEGACY_SETTINGS_FILE)) return false;
+    File file = SPIFFS.open(LEGACY_SETTINGS_FILE, "r");
+    if (!file || file.size() == 0) {
+        if (file) file.close();
+        return false;
+    }
+    DynamicJsonDocument doc(2048); 
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+        P_PRINTF("[CONFIG] 旧版JSON配置反序列化失败: %s\n", error.c_str());
+        return false;
+    }
+
+    JsonObject thresholdsObj = doc["thresholds"];
+    config.thresholds.tempMin = thresholdsObj["tempMin"] | DEFAULT_TEMP_MIN;
+    config.thresholds.tempMax = thresholdsObj["tempMax"] | DEFAULT_TEMP_MAX;
+    config.thresholds.humMin  = thresholdsObj["humMin"]  | DEFAULT_HUM_MIN;
+    config.thresholds.humMax  = thresholdsObj["humMax"]  | DEFAULT_HUM_MAX;
+    config.thresholds.coPpmMax   = thresholdsObj["coPpmMax"]   | DEFAULT_CO_PPM_MAX;
+    config.thresholds.no2PpmMax  = thresholdsObj["no2PpmMax"]  | DEFAULT_NO2_PPM_MAX;
+    config.thresholds.c2h5ohPpmMax = thresholdsObj["c2h5ohPpmMax"] | DEFAULT_C2H5OH_PPM_MAX;
+    config.thresholds.vocPpmMax  = thresholdsObj["vocPpmMax"]  | DEFAULT_VOC_PPM_MAX;
+
+    JsonObject r0Obj = doc["r0Values"];
+    config.r0Values.co = r0Obj["co"] | DEFAULT_R0_CO;
+    config.r0Values.no2 = r0Obj["no2"] | DEFAULT_R0_NO2;
+    config.r0Values.c2h5oh = r0Obj["c2h5oh"] | DEFAULT_R0_C2H5OH;
+    config.r0Values.voc = r0Obj["voc"] | DEFAULT_R0_VOC;
+    // 旧版配置没有校准值, 以当前 R0 作为基准
+    JsonObject r0CalObj = doc["r0Calibrated"];
+    config.r0Calibrated.co = r0CalObj["co"] | config.r0Values.co;
+    config.r0Calibrated.no2 = r0CalObj["no2"] | config.r0Values.no2;
+    config.r0Calibrated.c2h5oh = r0CalObj["c2h5oh"] | config.r0Values.c2h5oh;
+    config.r0Calibrated.voc = r0CalObj["voc"] | config.r0Values.voc;
+
+    config.currentSsidForSettings = doc["wifi"]["ssid"].as<String>();
+    config.currentPasswordForSettings = doc["wifi"]["password"].as<String>();
+    config.ledBrightness = doc["led"]["brightness"] | DEFAULT_LED_BRIGHTNESS;
+    return true;
+}
+
 void loadConfig(DeviceConfig& config) {
     P_PRINTLN("[CONFIG] 正在加载配置...");
-    if (SPIFFS.exists(SETTINGS_FILE)) {
-        File file = SPIFFS.open(SETTINGS_FILE, "r");
-        if (file && file.size() > 0) {
-            DynamicJsonDocument doc(2048); 
-            DeserializationError error = deserializeJson(doc, file);
-            if (error) {
-                P_PRINTF("[CONFIG] JSON反序列化失败: %s\n", error.c_str());
-                resetAllSettingsToDefault(config);
-            } else {
-                JsonObject thresholdsObj = doc["thresholds"];
-                config.thresholds.tempMin = thresholdsObj["tempMin"] | DEFAULT_TEMP_MIN;
-                config.thresholds.tempMax = thresholdsObj["tempMax"] | DEFAULT_TEMP_MAX;
-                config.thresholds.humMin  = thresholdsObj["humMin"]  | DEFAULT_HUM_MIN;
-                config.thresholds.humMax  = thresholdsObj["humMax"]  | DEFAULT_HUM_MAX;
-                config.thresholds.coPpmMax   = thresholdsObj["coPpmMax"]   | DEFAULT_CO_PPM_MAX;
-                config.thresholds.no2PpmMax  = thresholdsObj["no2PpmMax"]  | DEFAULT_NO2_PPM_MAX;
-                config.thresholds.c2h5ohPpmMax = thresholdsObj["c2h5ohPpmMax"] | DEFAULT_C2H5OH_PPM_MAX;
-                config.thresholds.vocPpmMax  = thresholdsObj["vocPpmMax"]  | DEFAULT_VOC_PPM_MAX;
-
-                // 新增: 加载R0值
-                JsonObject r0Obj = doc["r0Values"];
-                config.r0Values.co = r0Obj["co"] | DEFAULT_R0_CO;
-                config.r0Values.no2 = r0Obj["no2"] | DEFAULT_R0_NO2;
-                config.r0Values.c2h5oh = r0Obj["c2h5oh"] | DEFAULT_R0_C2H5OH;
-                config.r0Values.voc = r0Obj["voc"] | DEFAULT_R0_VOC;
-                
-                config.currentSsidForSettings = doc["wifi"]["ssid"].as<String>();
-                config.currentPasswordForSettings = doc["wifi"]["password"].as<String>();
-                config.ledBrightness = doc["led"]["brightness"] | DEFAULT_LED_BRIGHTNESS;
-                P_PRINTLN("[CONFIG] 配置加载成功.");
-            }
-        } else {
-            P_PRINTLN(file ? "[CONFIG] 配置文件为空." : "[CONFIG] 打开配置文件失败.");
-            resetAllSettingsToDefault(config);
-        }
-        if(file) file.close();
+    ConfigRecord rec;
+    if (configStore.load(SPIFFS, &rec) && rec.version == CONFIG_RECORD_VERSION) {
+        recordToConfig(rec, config);
+        P_PRINTLN("[CONFIG] 配置加载成功.");
+    } else if (loadLegacyJsonConfig(config)) {
+        P_PRINTLN("[CONFIG] 已从旧版JSON配置迁移.");
+        removeLegacyConfigAfterSave = true;
+        saveConfig(config);
+        flushConfig();
     } else {
-        P_PRINTLN("[CONFIG] 配置文件不存在, 使用默认值并保存.");
+        P_PRINTLN("[CONFIG] 没有有效的配置记录, 使用默认值并保存.");
         resetAllSettingsToDefault(config);
         saveConfig(config);
+        flushConfig();
     }
     P_PRINTF("  加载阈值 - 温度: %d-%d, 湿度: %d-%d\n",
                    config.thresholds.tempMin, config.thresholds.tempMax, config.thresholds.humMin, config.thresholds.humMax);
@@ -138,54 +227,37 @@ void loadConfig(DeviceConfig& config) {
 }
 
 void saveConfig(const DeviceConfig& config) {
-    P_PRINTLN("[CONFIG] 正在保存配置...");
-    File file = SPIFFS.open(SETTINGS_FILE, "w");
-    if (file) {
-        DynamicJsonDocument doc(2048); 
-        JsonObject thresholdsObj = doc.createNestedObject("thresholds");
-        thresholdsObj["tempMin"] = config.thresholds.tempMin;
-        thresholdsObj["tempMax"] = config.thresholds.tempMax;
-        thresholdsObj["humMin"]  = config.thresholds.humMin;
-        thresholdsObj["humMax"]  = config.thresholds.humMax;
-        thresholdsObj["coPpmMax"]   = config.thresholds.coPpmMax;
-        thresholdsObj["no2PpmMax"]  = config.thresholds.no2PpmMax;
-        thresholdsObj["c2h5ohPpmMax"] = config.thresholds.c2h5ohPpmMax;
-        thresholdsObj["vocPpmMax"]  = config.thresholds.vocPpmMax;
-
-        // 新增: 保存R0值
-        JsonObject r0Obj = doc.createNestedObject("r0Values");
-        r0Obj["co"] = config.r0Values.co;
-        r0Obj["no2"] = config.r0Values.no2;
-        r0Obj["c2h5oh"] = config.r0Values.c2h5oh;
-        r0Obj["voc"] = config.r0Values.voc;
-
-        JsonObject wifiObj = doc.createNestedObject("wifi");
-        if (WiFi.isConnected()) {
-            wifiObj["ssid"] = WiFi.SSID();
-            if (config.currentSsidForSettings == WiFi.SSID()) {
-                 wifiObj["password"] = config.currentPasswordForSettings;
-            } else {
-                wifiObj["password"] = config.currentPasswordForSettings;
-            }
-        } else {
-            wifiObj["ssid"] = config.currentSsidForSettings;
-            wifiObj["password"] = config.currentPasswordForSettings;
-        }
-
-        JsonObject ledObj = doc.createNestedObject("led");
-        ledObj["brightness"] = config.ledBrightness;
+    configRevision++;
+    pendingConfig = &config;
+    configSaveRequestTime = millis(); // 每次修改都推迟写入, 连续修改只写一次
+}
 
-        if (serializeJson(doc, file) == 0) {
-            P_PRINTLN("[CONFIG] 写入配置文件失败.");
-        } else {
-            P_PRINTLN("[CONFIG] 配置保存成功.");
-        }
-        file.close();
-    } else {
-        P_PRINTLN("[CONFIG] 创建/打开配置文件用于写入失败.");
+// 存储任务中执行
+static void writeConfigRecord(const void* payload, size_t len) {
+    if (!configStore.save(payload)) {
+        P_PRINTLN("[CONFIG] 写入配置失败.");
+        return;
+    }
+    P_PRINTF("[CONFIG] 配置保存成功 (第 %u 次写入).\n", configStore.writeCount());
+    if (removeLegacyConfigAfterSave) {
+        removeLegacyConfigAfterSave = false;
+        SPIFFS.remove(LEGACY_SETTINGS_FILE);
     }
 }
 
+uint32_t flushConfig() {
+    if (pendingConfig == NULL) return 0;
+    ConfigRecord rec;
+    configToRecord(*pendingConfig, rec); // 在调用方上下文中取快照, 之后的修改不影响本次写入
+    pendingConfig = NULL;
+    return storageSubmit(writeConfigRecord, STORAGE_KEY_CONFIG, &rec, sizeof(rec));
+}
+
+void processConfigSave() {
+    if (pendingConfig != NULL && millis() - configSaveRequestTime >= CONFIG_SAVE_DEBOUNCE_MS) {
+        flushConfig();
+    }
+}
 
 void resetAllSettingsToDefault(DeviceConfig& config) {
     P_PRINTLN("[CONFIG] 重置所有设置为默认值 (内存中).");
@@ -204,136 +276,357 @@ void resetAllSettingsToDefault(DeviceConfig& config) {
         DEFAULT_R0_C2H5OH,
         DEFAULT_R0_VOC
     };
+    config.r0Calibrated = config.r0Values;
     config.currentSsidForSettings = "";
     config.currentPasswordForSettings = "";
     config.ledBrightness = DEFAULT_LED_BRIGHTNESS;
 }
 
-void loadHistoricalDataFromFile(CircularBuffer& histBuffer) {
-    P_PRINTLN("[HISTORY] 正在加载历史数据...");
+// 历史数据日志中单条记录的负载格式 (定长, 小端)
+struct __attribute__((packed)) HistoryRecord {
+    uint32_t timestamp;
+    uint8_t flags;          // bit0: isTimeRelative
+    uint8_t reserved;
+    int16_t temp;
+    int16_t hum;
+    float co, no2, c2h5oh, voc;
+};
+
+static RecordLog historyLog(HISTORY_LOG_PREFIX, sizeof(HistoryRecord),
+                            HISTORY_LOG_SEGMENT_COUNT, HISTORY_LOG_RECORDS_PER_SEGMENT);
+
+// 1小时聚合数据点在日志中的负载格式
+struct __attribute__((packed)) RollupRecord {
+    uint32_t timestamp;
+    uint8_t flags;          // bit0: isTimeRelative
+    struct __attribute__((packed)) {
+        float min, max, avg;
+        uint16_t count;
+    } channels[RC_COUNT];
+};
+
+static RecordLog rollupLog(ROLLUP_LOG_PREFIX, sizeof(RollupRecord),
+                           ROLLUP_LOG_SEGMENT_COUNT, ROLLUP_LOG_RECORDS_PER_SEGMENT);
+
+// 单通道聚合统计 (NAN样本不计入, count为该通道有效样本数)
+struct ChannelStats {
+    float min;
+    float max;
+    float avg;
+    uint16_t count;
+};
+
+// 尚未结束的时间桶以浮点累计 (合并时不损失精度), 结束时压缩为 RollupDataPoint
+struct RollupAccumulator {
+    unsigned long timestamp;
+    bool isTimeRelative;
+    ChannelStats channels[RC_COUNT];
+};
+
+// 当前尚未结束的1分钟/1小时时间桶
+static RollupAccumulator minuteAccumulator, hourAccumulator;
+static bool minuteAccumulatorActive = false, hourAccumulatorActive = false;
+
+static void rollupPack(const RollupAccumulator& acc, RollupDataPoint& rp);
+
+static void restoreRollupRecord(const uint8_t* payload, uint32_t seq, void* ctx) {
+    HourRollupBuffer* buffer = static_cast<HourRollupBuffer*>(ctx);
+    RollupRecord rec;
+    memcpy(&rec, payload, sizeof(rec));
+    RollupAccumulator acc;
+    acc.timestamp = rec.timestamp;
+    acc.isTimeRelative = (rec.flags & 0x01) != 0;
+    for (int ch = 0; ch < RC_COUNT; ch++) {
+        acc.channels[ch].min = rec.channels[ch].min;
+        acc.channels[ch].max = rec.channels[ch].max;
+        acc.channels[ch].avg = rec.channels[ch].avg;
+        acc.channels[ch].count = rec.channels[ch].count;
+    }
+    RollupDataPoint rp;
+    rollupPack(acc, rp);
+    buffer->push(rp);
+}
+
+static void writeRollupRecord(const void* payload, size_t len) {
+    if (!rollupLog.append(payload)) {
+        P_PRINTLN("[HISTORY] 追加小时聚合记录失败.");
+    }
+}
+
+// 日志中保存浮点累计值, 不受内存中定点分辨率的限制
+static void appendRollupToLog(const RollupAccumulator& acc) {
+    RollupRecord rec;
+    rec.timestamp = acc.timestamp;
+    rec.flags = acc.isTimeRelative ? 0x01 : 0x00;
+    for (int ch = 0; ch < RC_COUNT; ch++) {
+        rec.channels[ch].min = acc.channels[ch].min;
+        rec.channels[ch].max = acc.channels[ch].max;
+        rec.channels[ch].avg = acc.channels[ch].avg;
+        rec.channels[ch].count = acc.channels[ch].count;
+    }
+    storageSubmit(writeRollupRecord, STORAGE_MERGE_NONE, &rec, sizeof(rec));
+}
+
+static void restoreHistoryRecord(const uint8_t* payload, uint32_t seq, void* ctx) {
+    HistoryBuffer* histBuffer = static_cast<HistoryBuffer*>(ctx);
+    HistoryRecord rec;
+    memcpy(&rec, payload, sizeof(rec));
+    SensorDataPoint dp;
+    dp.timestamp = rec.timestamp;
+    dp.isTimeRelative = (rec.flags & 0x01) != 0;
+    dp.temp = rec.temp;
+    dp.hum = rec.hum;
+    dp.gas = {rec.co, rec.no2, rec.c2h5oh, rec.voc};
+    generateTimeStr(dp.timestamp, dp.isTimeRelative, dp.timeStr);
+    histBuffer->push(dp);
+}
+
+void loadHistoricalDataFromFile(HistoryBuffer& histBuffer) {
+    P_PRINTLN("[HISTORY] 正在从日志恢复历史数据...");
     histBuffer.clear();
-    if (SPIFFS.exists(HISTORICAL_DATA_FILE)) {
-        File file = SPIFFS.open(HISTORICAL_DATA_FILE, "r");
-        if (file && file.size() > 0) {
-            // 根据可能的最大数据量调整JSON文档大小
-            DynamicJsonDocument doc(min((size_t)(1024 * 16), (size_t)(HISTORICAL_DATA_POINTS * 250)));
-            DeserializationError error = deserializeJson(doc, file);
-            if (error) {
-                P_PRINTF("[HISTORY] JSON反序列化历史数据失败: %s\n", error.c_str());
-            } else {
-                JsonArray arr = doc.as<JsonArray>();
-                unsigned int count = 0;
-                for (JsonObject obj : arr) {
-                    if (histBuffer.count() >= HISTORICAL_DATA_POINTS) break; 
-                    SensorDataPoint dp;
-                    dp.timestamp = obj["ts"]; 
-                    dp.isTimeRelative = obj["rel"] | false;
-                    dp.temp = obj["t"].as<int>();
-                    dp.hum = obj["h"].as<int>();
-                    dp.gas.co = obj["co"];
-                    dp.gas.no2 = obj["no2"];
-                    dp.gas.c2h5oh = obj["c2h5oh"]; 
-                    dp.gas.voc = obj["voc"];
-                    generateTimeStr(dp.timestamp, dp.isTimeRelative, dp.timeStr); 
-                    histBuffer.add(dp);
-                    count++;
-                }
-                P_PRINTF("[HISTORY] 加载了 %u 条历史数据.\n", count);
-            }
-        } else { P_PRINTLN(file ? "[HISTORY] 文件为空." : "[HISTORY] 打开文件失败."); }
-        if(file) file.close();
-    } else { P_PRINTLN("[HISTORY] 文件不存在."); }
-}
-
-void saveHistoricalDataToFile(const CircularBuffer& histBuffer) {
-    P_PRINTLN("[HISTORY] 正在保存历史数据...");
-    File file = SPIFFS.open(HISTORICAL_DATA_FILE, "w");
-    if (file) {
-        const std::vector<SensorDataPoint>& dataToSave = histBuffer.getData();
-        DynamicJsonDocument doc(min((size_t)(1024 * 16), (size_t)(dataToSave.size() * 250)));
-        JsonArray arr = doc.to<JsonArray>();
-        for (const auto& dp : dataToSave) {
-            JsonObject obj = arr.createNestedObject();
-            obj["ts"] = dp.timestamp;
-            obj["rel"] = dp.isTimeRelative;
-            obj["t"] = dp.temp;
-            obj["h"] = dp.hum;
-            obj["co"] = dp.gas.co;
-            obj["no2"] = dp.gas.no2;
-            obj["c2h5oh"] = dp.gas.c2h5oh; 
-            obj["voc"] = dp.gas.voc;
-        }
-        size_t bytesWritten = serializeJson(doc, file);
-        if (bytesWritten == 0 && !dataToSave.empty()) P_PRINTLN("[HISTORY] 写入失败.");
-        else P_PRINTF("[HISTORY] %u 条 (%lu B) 已保存.\n", dataToSave.size(), bytesWritten);
-        file.close();
-    } else { P_PRINTLN("[HISTORY] 创建文件失败."); }
-}
-
-// -- CircularBuffer 方法实现 --
-void CircularBuffer::add(const SensorDataPoint& item) {
-    buffer[head] = item;
-    if (full) {
-        tail = (tail + 1) % maxSize;
+    if (SPIFFS.exists(LEGACY_HISTORICAL_DATA_FILE)) {
+        SPIFFS.remove(LEGACY_HISTORICAL_DATA_FILE);
+        P_PRINTLN("[HISTORY] 已删除旧版JSON历史数据文件.");
     }
-    head = (head + 1) % maxSize;
-    full = (head == tail);
+    size_t recovered = historyLog.recover(SPIFFS, restoreHistoryRecord, &histBuffer);
+    P_PRINTF("[HISTORY] 加载了 %u 条历史数据 (日志共 %u 条).\n", histBuffer.count(), recovered);
+
+    hourRollups.clear();
+    rollupLog.recover(SPIFFS, restoreRollupRecord, &hourRollups);
+    historyRevision++;
+    P_PRINTF("[HISTORY] 加载了 %u 条小时聚合数据.\n", hourRollups.count());
 }
 
-const std::vector<SensorDataPoint>& CircularBuffer::getData() const {
-    orderedData.clear();
-    if (isEmpty()) return orderedData;
-    if (full) {
-        for (size_t i = 0; i < maxSize; ++i) {
-            orderedData.push_back(buffer[(tail + i) % maxSize]);
-        }
-    } else {
-        for (size_t i = tail; i != head; i = (i + 1) % maxSize) {
-            orderedData.push_back(buffer[i]);
-        }
+// -- 以下日志写入作业在存储任务中执行 --
+
+static void writeHistoryRecord(const void* payload, size_t len) {
+    if (!historyLog.append(payload)) {
+        P_PRINTLN("[HISTORY] 追加历史记录失败.");
     }
-    return orderedData;
 }
 
-size_t CircularBuffer::count() const {
-    if (full) return maxSize;
-    if (head >= tail) return head - tail;
-    return maxSize - (tail - head);
+static void clearHistoryLogJob(const void* payload, size_t len) {
+    historyLog.clear();
+    P_PRINTLN("[HISTORY] 历史数据日志已清空.");
 }
 
-bool CircularBuffer::isEmpty() const {
-    return !full && (head == tail);
+static void clearRollupLogJob(const void* payload, size_t len) {
+    rollupLog.clear();
+    P_PRINTLN("[HISTORY] 聚合历史数据日志已清空.");
 }
 
-void CircularBuffer::clear() {
-    head = 0;
-    tail = 0;
-    full = false;
-    orderedData.clear();
+void appendHistoricalDataToLog(const SensorDataPoint& dp) {
+    HistoryRecord rec;
+    rec.timestamp = dp.timestamp;
+    rec.flags = dp.isTimeRelative ? 0x01 : 0x00;
+    rec.reserved = 0;
+    rec.temp = dp.temp;
+    rec.hum = dp.hum;
+    rec.co = dp.gas.co;
+    rec.no2 = dp.gas.no2;
+    rec.c2h5oh = dp.gas.c2h5oh;
+    rec.voc = dp.gas.voc;
+    storageSubmit(writeHistoryRecord, STORAGE_MERGE_NONE, &rec, sizeof(rec));
+}
+
+void clearHistoricalDataLog() {
+    storageSubmit(clearHistoryLogJob, STORAGE_MERGE_NONE, NULL, 0);
+}
+
+void clearRollupHistory() {
+    minuteRollups.clear();
+    hourRollups.clear();
+    minuteAccumulatorActive = false;
+    hourAccumulatorActive = false;
+    historyRevision++;
+    storageSubmit(clearRollupLogJob, STORAGE_MERGE_NONE, NULL, 0);
+    P_PRINTLN("[HISTORY] 聚合历史数据已清空.");
+}
+
+// -- 多分辨率聚合 --
+// 每个样本只更新当前时间桶的 min/max/avg/count, 时间桶结束时整体写入对应的环形缓冲区;
+// 1分钟桶结束时再合并进1小时桶, 因此每个样本的聚合开销为 O(1).
+
+static unsigned long rollupBucketStart(unsigned long timestamp, bool isTimeRelative, unsigned long periodSec) {
+    unsigned long period = isTimeRelative ? periodSec * 1000UL : periodSec;
+    return timestamp - (timestamp % period);
+}
+
+static void rollupReset(RollupAccumulator& acc, unsigned long bucketStart, bool isTimeRelative) {
+    acc.timestamp = bucketStart;
+    acc.isTimeRelative = isTimeRelative;
+    for (int ch = 0; ch < RC_COUNT; ch++) {
+        acc.channels[ch] = {NAN, NAN, NAN, 0};
+    }
+}
+
+// 各通道定点值的倍数 (存储值 = 实际值 x 倍数): 温湿度 0.01, CO/C2H5OH 0.1 PPM, NO2 0.001 PPM, VOC 0.01 PPM.
+// int16 可表示的上限分别为 327°C/%, 3276 PPM, 32.7 PPM 和 327 PPM, 均高于传感器量程
+static const float ROLLUP_SCALE[RC_COUNT] = { 100.0f, 100.0f, 10.0f, 1000.0f, 10.0f, 100.0f };
+
+static int16_t rollupEncode(RollupChannel channel, float value) {
+    const float scaled = roundf(value * ROLLUP_SCALE[channel]);
+    if (scaled >= INT16_MAX) return INT16_MAX;
+    if (scaled <= -INT16_MAX) return -INT16_MAX;
+    return (int16_t)scaled;
+}
+
+float rollupDecode(RollupChannel channel, int16_t value) {
+    return value / ROLLUP_SCALE[channel];
+}
+
+static void rollupPack(const RollupAccumulator& acc, RollupDataPoint& rp) {
+    rp.timestamp = acc.timestamp;
+    rp.isTimeRelative = acc.isTimeRelative;
+    for (int ch = 0; ch < RC_COUNT; ch++) {
+        const ChannelStats& cs = acc.channels[ch];
+        const RollupChannel channel = (RollupChannel)ch;
+        rp.count[ch] = (uint8_t)min(cs.count, (uint16_t)UINT8_MAX);
+        rp.min[ch] = cs.count ? rollupEncode(channel, cs.min) : 0;
+        rp.max[ch] = cs.count ? rollupEncode(channel, cs.max) : 0;
+        rp.avg[ch] = cs.count ? rollupEncode(channel, cs.avg) : 0;
+    }
+}
+
+static void rollupAddValue(ChannelStats& cs, float value) {
+    if (isnan(value)) return;
+    if (cs.count == 0) {
+        cs.min = cs.max = cs.avg = value;
+        cs.count = 1;
+        return;
+    }
+    if (value < cs.min) cs.min = value;
+    if (value > cs.max) cs.max = value;
+    if (cs.count < UINT16_MAX) cs.count++;
+    cs.avg += (value - cs.avg) / cs.count;
+}
+
+static void rollupMerge(ChannelStats& dst, const ChannelStats& src) {
+    if (src.count == 0) return;
+    if (dst.count == 0) {
+        dst = src;
+        return;
+    }
+    if (src.min < dst.min) dst.min = src.min;
+    if (src.max > dst.max) dst.max = src.max;
+    uint32_t total = (uint32_t)dst.count + src.count;
+    dst.avg = (dst.avg * dst.count + src.avg * src.count) / total;
+    dst.count = min(total, (uint32_t)UINT16_MAX);
+}
+
+static void closeHourBucket() {
+    RollupDataPoint rp;
+    rollupPack(hourAccumulator, rp);
+    hourRollups.push(rp);
+    appendRollupToLog(hourAccumulator);
+    hourAccumulatorActive = false;
+}
+
+static void closeMinuteBucket() {
+    RollupDataPoint rp;
+    rollupPack(minuteAccumulator, rp);
+    minuteRollups.push(rp);
+    minuteAccumulatorActive = false;
+
+    unsigned long hourStart = rollupBucketStart(minuteAccumulator.timestamp, minuteAccumulator.isTimeRelative, 3600);
+    if (hourAccumulatorActive && (hourAccumulator.isTimeRelative != minuteAccumulator.isTimeRelative ||
+                                  hourAccumulator.timestamp != hourStart)) {
+        closeHourBucket();
+    }
+    if (!hourAccumulatorActive) {
+        rollupReset(hourAccumulator, hourStart, minuteAccumulator.isTimeRelative);
+        hourAccumulatorActive = true;
+    }
+    for (int ch = 0; ch < RC_COUNT; ch++) {
+        rollupMerge(hourAccumulator.channels[ch], minuteAccumulator.channels[ch]);
+    }
+}
+
+static void addRollupSample(const SensorDataPoint& dp) {
+    unsigned long minuteStart = rollupBucketStart(dp.timestamp, dp.isTimeRelative, 60);
+    if (minuteAccumulatorActive && (minuteAccumulator.isTimeRelative != dp.isTimeRelative ||
+                                    minuteAccumulator.timestamp != minuteStart)) {
+        closeMinuteBucket();
+    }
+    if (!minuteAccumulatorActive) {
+        rollupReset(minuteAccumulator, minuteStart, dp.isTimeRelative);
+        minuteAccumulatorActive = true;
+    }
+    rollupAddValue(minuteAccumulator.channels[RC_TEMP], dp.temp);
+    rollupAddValue(minuteAccumulator.channels[RC_HUM], dp.hum);
+    rollupAddValue(minuteAccumulator.channels[RC_CO], dp.gas.co);
+    rollupAddValue(minuteAccumulator.channels[RC_NO2], dp.gas.no2);
+    rollupAddValue(minuteAccumulator.channels[RC_C2H5OH], dp.gas.c2h5oh);
+    rollupAddValue(minuteAccumulator.channels[RC_VOC], dp.gas.voc);
+}
+
+const RollupDataPoint* getOpenRollup(HistoryTier tier) {
+    if (tier == TIER_MINUTE) {
+        static RollupDataPoint minuteView;
+        if (!minuteAccumulatorActive) return NULL;
+        rollupPack(minuteAccumulator, minuteView);
+        return &minuteView;
+    }
+    if (tier == TIER_HOUR) {
+        // 未结束的小时桶需要并入当前分钟桶才是完整的实时视图
+        static RollupDataPoint hourView;
+        if (!hourAccumulatorActive && !minuteAccumulatorActive) return NULL;
+        RollupAccumulator acc;
+        if (hourAccumulatorActive) {
+            acc = hourAccumulator;
+        } else {
+            rollupReset(acc, rollupBucketStart(minuteAccumulator.timestamp, minuteAccumulator.isTimeRelative, 3600),
+                        minuteAccumulator.isTimeRelative);
+        }
+        if (minuteAccumulatorActive && minuteAccumulator.isTimeRelative == acc.isTimeRelative &&
+            rollupBucketStart(minuteAccumulator.timestamp, minuteAccumulator.isTimeRelative, 3600) == acc.timestamp) {
+            for (int ch = 0; ch < RC_COUNT; ch++) {
+                rollupMerge(acc.channels[ch], minuteAccumulator.channels[ch]);
+            }
+        }
+        rollupPack(acc, hourView);
+        return &hourView;
+    }
+    return NULL;
 }
 
 
 // -- 数据处理函数 --
-void addHistoricalDataPoint(CircularBuffer& histBuffer, const DeviceState& state) {
-    if (state.temperature == 0 && state.humidity == 0 && isnan(state.gasPpmValues.co)) return;
-    SensorDataPoint dp;
+void addHistoricalDataPoint(HistoryBuffer& histBuffer, const DeviceState& state) {
     extern bool ntpSynced;
-    dp.isTimeRelative = !ntpSynced;
-    if (dp.isTimeRelative) {
-        dp.timestamp = millis();
+    if (!ntpSynced) {
+        addHistoricalDataPoint(histBuffer, state, millis(), true);
     } else {
         struct timeval tv;
         gettimeofday(&tv, NULL);
-        dp.timestamp = tv.tv_sec;
+        addHistoricalDataPoint(histBuffer, state, tv.tv_sec, false);
     }
+}
+
+void addHistoricalDataPoint(HistoryBuffer& histBuffer, const DeviceState& state, unsigned long timestamp, bool isTimeRelative) {
+    if (state.temperature == 0 && state.humidity == 0 && isnan(state.gasPpmValues.co)) return;
+    SensorDataPoint dp;
+    dp.isTimeRelative = isTimeRelative;
+    dp.timestamp = timestamp;
     dp.temp = state.temperature; 
     dp.hum = state.humidity; 
     dp.gas = state.gasPpmValues;
     generateTimeStr(dp.timestamp, dp.isTimeRelative, dp.timeStr);
-    histBuffer.add(dp);
+    histBuffer.push(dp);
+    appendHistoricalDataToLog(dp);
+    addRollupSample(dp);
+    historyRevision++;
+}
+
+uint32_t getConfigRevision() {
+    return configRevision;
+}
+
+uint32_t getHistoryRevision() {
+    return historyRevision;
 }
 
-String getSensorStatusString(SensorStatusVal status) {
+const char* getSensorStatusString(SensorStatusVal status) {
     switch (status) {
         case SS_NORMAL: return "normal";
         case SS_WARNING: return "warning";
@@ -2,9 +2,9 @@
 #define DATA_MANAGER_H
 
 #include <Arduino.h>
-#include <vector>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "ring_buffer.h"
 
 // ==========================================================================
 // == 数据结构定义 ==
@@ -33,7 +33,7 @@ struct GasResistData {
 };
 
 
-// 设备当前状态
+// 设备当前状态. 由采样任务独占写入, 其他任务通过 getDeviceStateSnapshot() 读取一致的快照.
 struct DeviceState {
     // 【修改】: 根据平台错误和您的要求，将温度类型改回 int
     int temperature;
@@ -43,18 +43,20 @@ struct DeviceState {
     GasResistData gasRsValues; 
     SensorStatusVal tempStatus, humStatus, gasCoStatus, gasNo2Status, gasC2h5ohStatus, gasVocStatus;
     bool buzzerShouldBeActive;
-    unsigned long buzzerStopTime;
-    int buzzerBeepCount;
-    bool ledBlinkState;
-    unsigned long lastBlinkTime;
-    
-    CalibrationState calibrationState;
-    int calibrationProgress;      // 校准进度 (0-100)
-    GasResistData measuredR0;     // 校准过程中测量的R0值
 
     DeviceState(); // 构造函数
 };
 
+// 校准状态 (由校准任务写入, 通过 getCalibrationStatus() 整体读取)
+struct CalibrationStatus {
+    CalibrationState state;
+    int progress;                 // 校准进度 (0-100)
+    GasResistData measuredR0;     // 校准过程中测量的R0值
+    uint32_t version;             // 每次更新递增, 用于判断是否需要推送给客户端
+
+    CalibrationStatus(); // 构造函数
+};
+
 // 报警阈值配置
 struct AlarmThresholds {
     int tempMin, tempMax;
@@ -65,7 +67,8 @@ struct AlarmThresholds {
 // 设备配置 (从SPIFFS加载/保存)
 struct DeviceConfig {
     AlarmThresholds thresholds;
-    GasResistData r0Values; 
+    GasResistData r0Values;       // 当前生效的 R0 (校准值 + 基线漂移修正)
+    GasResistData r0Calibrated;   // 最近一次校准得到的 R0, 基线跟踪在其附近调整 r0Values
     String currentSsidForSettings;
     String currentPasswordForSettings;
     uint8_t ledBrightness;
@@ -73,12 +76,20 @@ struct DeviceConfig {
     DeviceConfig(); // 构造函数
 };
 
+// 采样任务使用的运行参数 (配置中的阈值和 R0). 采样任务和 loop 任务都会修改,
+// 只通过 sensor_handler 中受临界区保护的副本整体交换, 见 getSensorParams()
+struct SensorParams {
+    AlarmThresholds thresholds;
+    GasResistData r0Values;
+    GasResistData r0Calibrated;
+};
+
 // WiFi 连接状态管理
 enum WifiConnectProgress { WIFI_CP_IDLE, WIFI_CP_DISCONNECTING, WIFI_CP_CONNECTING, WIFI_CP_FAILED };
 struct WifiState {
     WifiConnectProgress connectProgress;
-    String ssidToTry;
-    String passwordToTry;
+    char ssidToTry[33];      // 最长 32 字节, 与保存的配置记录相同; 定长数组, 连接请求不占用堆
+    char passwordToTry[65];  // 最长 64 字节
     unsigned long connectAttemptStartTime;
     uint8_t connectInitiatorClientNum;
     bool isScanning;
@@ -99,37 +110,43 @@ struct SensorDataPoint {
     char timeStr[12]; 
 };
 
-// 环形缓冲区类声明
-class CircularBuffer {
-public:
-    CircularBuffer(size_t size);
-    void add(const SensorDataPoint& item);
-    const std::vector<SensorDataPoint>& getData() const;
-    size_t count() const;
-    bool isEmpty() const;
-    void clear();
-
-private:
-    std::vector<SensorDataPoint> buffer;
-    mutable std::vector<SensorDataPoint> orderedData; 
-    size_t maxSize, head, tail;
-    bool full;
+// 原始历史数据环形缓冲区 (写满后覆盖最旧的点)
+typedef Ring<SensorDataPoint, HISTORICAL_DATA_POINTS> HistoryBuffer;
+
+// 历史数据分辨率层级
+enum HistoryTier { TIER_RAW, TIER_MINUTE, TIER_HOUR };
+
+// 聚合通道索引
+enum RollupChannel { RC_TEMP, RC_HUM, RC_CO, RC_NO2, RC_C2H5OH, RC_VOC, RC_COUNT };
+
+// 聚合历史数据点 (1分钟/1小时时间桶). 为压缩内存, min/max/avg 按通道的固定分辨率存为 int16
+// (用 rollupDecode() 还原, 超出范围时饱和), 有效样本数存为 uint8 (饱和于255, 0 表示该通道无数据)
+struct RollupDataPoint {
+    uint32_t timestamp;        // 时间桶起点, 单位同 SensorDataPoint (相对时间: 毫秒, 绝对时间: 秒)
+    bool isTimeRelative;
+    uint8_t count[RC_COUNT];
+    int16_t min[RC_COUNT];
+    int16_t max[RC_COUNT];
+    int16_t avg[RC_COUNT];
 };
 
+// 聚合数据环形缓冲区
+typedef Ring<RollupDataPoint, ROLLUP_MINUTE_POINTS> MinuteRollupBuffer;
+typedef Ring<RollupDataPoint, ROLLUP_HOUR_POINTS> HourRollupBuffer;
+static_assert(sizeof(HourRollupBuffer) <= ROLLUP_HOUR_RAM_BUDGET, "Hour rollup tier exceeds ROLLUP_HOUR_RAM_BUDGET");
+
 // ==========================================================================
 // == 全局变量声明 ==
 // ==========================================================================
-extern DeviceState currentState;
-extern DeviceConfig currentConfig;
+extern DeviceConfig currentConfig;   // 只在 loop 任务中读写 (采样任务使用 SensorParams)
 extern WifiState wifiState;
-extern CircularBuffer historicalData;
+extern HistoryBuffer historicalData;
+extern MinuteRollupBuffer minuteRollups;
+extern HourRollupBuffer hourRollups;
 
-extern unsigned long lastSensorReadTime, lastWebSocketUpdateTime, lastHistoricalDataSaveTime;
+extern unsigned long lastWebSocketUpdateTime;
 extern unsigned long gasSensorWarmupEndTime;
 
-extern TaskHandle_t calibrationTaskHandle;
-extern SemaphoreHandle_t calibrationSemaphore;
-
 
 // ==========================================================================
 // == 函数声明 ==
@@ -138,14 +155,23 @@ extern SemaphoreHandle_t calibrationSemaphore;
 // -- 文件和配置管理 --
 void initSPIFFS();
 void loadConfig(DeviceConfig& config);
-void saveConfig(const DeviceConfig& config);
+void saveConfig(const DeviceConfig& config);         // 登记待保存, 去抖后由 processConfigSave() 写入
+uint32_t flushConfig();                              // 立即提交待保存的配置, 返回存储作业票据 (0: 无待保存或提交失败)
+void processConfigSave();                            // 在 loop 中调用, 去抖时间到后写入
 void resetAllSettingsToDefault(DeviceConfig& config);
-void loadHistoricalDataFromFile(CircularBuffer& histBuffer);
-void saveHistoricalDataToFile(const CircularBuffer& histBuffer);
+void loadHistoricalDataFromFile(HistoryBuffer& histBuffer);    // 扫描日志分段恢复历史缓冲区
+void appendHistoricalDataToLog(const SensorDataPoint& dp);      // 单条记录追加写入日志
+void clearHistoricalDataLog();
+void clearRollupHistory();                                      // 清空1分钟/1小时聚合层及其日志
 
 // -- 数据处理 --
-void addHistoricalDataPoint(CircularBuffer& histBuffer, const DeviceState& state);
-String getSensorStatusString(SensorStatusVal status);
+void addHistoricalDataPoint(HistoryBuffer& histBuffer, const DeviceState& state);  // 以当前时间 (NTP 或运行毫秒数) 记录
+void addHistoricalDataPoint(HistoryBuffer& histBuffer, const DeviceState& state, unsigned long timestamp, bool isTimeRelative); // 由调用方提供时间 (回放)
+const RollupDataPoint* getOpenRollup(HistoryTier tier);       // 当前尚未结束的时间桶, 无样本时返回NULL
+float rollupDecode(RollupChannel channel, int16_t value);      // 聚合点中的定点值还原为实际值
+uint32_t getConfigRevision();                                  // 每次 saveConfig() 加一
+uint32_t getHistoryRevision();                                 // 原始历史或聚合层每次变化加一
+const char* getSensorStatusString(SensorStatusVal status);
 void generateTimeStr(unsigned long current_timestamp, bool isTimeRelative, char* buffer);
 
 #endif // DATA_MANAGER_H
@@ -0,0 +1,50 @@
+#include "dht_pulse.h"
+
+size_t dhtCollectHighPulses(const uint8_t* levels, const uint16_t* durationsUs, size_t segmentCount,
+                            uint16_t* highUs, size_t maxHigh) {
+    size_t n = 0;
+    for (size_t i = 0; i < segmentCount; i++) {
+        if (levels[i] == 0 || durationsUs[i] == 0) continue;
+        if (n == maxHigh) { // 只保留最新的 maxHigh 段
+            for (size_t j = 1; j < maxHigh; j++) highUs[j - 1] = highUs[j];
+            n--;
+        }
+        highUs[n++] = durationsUs[i];
+    }
+    return n;
+}
+
+DhtDecodeStatus dhtDecodePulses(const uint16_t* highUs, size_t count, DhtReading& out) {
+    if (count < DHT_DATA_BITS) return DHT_DECODE_TOO_FEW_PULSES;
+
+    const uint16_t* bits = highUs + (count - DHT_DATA_BITS);
+    uint8_t data[5] = {0, 0, 0, 0, 0};
+    for (size_t i = 0; i < DHT_DATA_BITS; i++) {
+        if (bits[i] < DHT_BIT_MIN_HIGH_US || bits[i] > DHT_BIT_MAX_HIGH_US) return DHT_DECODE_BAD_PULSE;
+        data[i / 8] <<= 1;
+        if (bits[i] > DHT_BIT_ONE_THRESHOLD_US) data[i / 8] |= 1;
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) return DHT_DECODE_CHECKSUM;
+    // 丢失一个数据位时, 前面的响应信号 (80us) 被解码为湿度字节的最高位, 约一半的情况下校验和仍然正确
+    if (data[0] > DHT_MAX_HUMIDITY || data[1] > DHT_MAX_DECIMAL || (data[3] & 0x7F) > DHT_MAX_DECIMAL) {
+        return DHT_DECODE_OUT_OF_RANGE;
+    }
+
+    out.humidity = data[0] + data[1] * 0.1f;
+    float temperature = data[2];
+    if (data[3] & 0x80) temperature = -1 - temperature;
+    out.temperature = temperature + (data[3] & 0x0F) * 0.1f;
+    return DHT_DECODE_OK;
+}
+
+const char* dhtDecodeStatusName(DhtDecodeStatus status) {
+    switch (status) {
+        case DHT_DECODE_OK:             return "OK";
+        case DHT_DECODE_TOO_FEW_PULSES: return "too few pulses";
+        case DHT_DECODE_BAD_PULSE:      return "bad pulse width";
+        case DHT_DECODE_CHECKSUM:       return "checksum mismatch";
+        case DHT_DECODE_OUT_OF_RANGE:   return "value out of range";
+    }
+    return "unknown";
+}
@@ -0,0 +1,45 @@
+#ifndef DHT_PULSE_H
+#define DHT_PULSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================================================
+// == DHT11 脉冲序列解码 (纯函数, 不依赖硬件) ==
+// == 一次传输为: 响应 (低80us + 高80us), 40个数据位 (低50us + 高26~28us 表示0,
+// == 高70us 表示1), 结束低电平50us. 数据位由高电平宽度区分, 因此解码只需要
+// == 各段高电平的持续时间.
+// == 字节顺序: 湿度整数, 湿度小数, 温度整数, 温度小数 (bit7 为负号), 校验和.
+// ==========================================================================
+
+#define DHT_DATA_BITS 40
+#define DHT_BIT_ONE_THRESHOLD_US 48   // 高电平宽于此值为1, 否则为0
+#define DHT_BIT_MIN_HIGH_US 10        // 数据位高电平的合理范围, 超出视为干扰
+#define DHT_BIT_MAX_HIGH_US 100
+#define DHT_MAX_HUMIDITY 100        // 湿度整数字节上限
+#define DHT_MAX_DECIMAL 9           // 小数字节 (去掉负号位) 上限
+
+enum DhtDecodeStatus {
+    DHT_DECODE_OK,
+    DHT_DECODE_TOO_FEW_PULSES,  // 高电平段少于40个 (传感器未响应或传输不完整)
+    DHT_DECODE_BAD_PULSE,       // 存在宽度异常的数据位
+    DHT_DECODE_CHECKSUM,        // 校验和不匹配
+    DHT_DECODE_OUT_OF_RANGE     // 校验和正确但数值不可能出现 (通常是丢失数据位后响应信号被当作数据位)
+};
+
+struct DhtReading {
+    float temperature;  // °C
+    float humidity;     // %
+};
+
+// 由捕获到的电平段 (电平, 持续时间us) 依次提取非零宽度的高电平段, 返回写入 highUs 的个数.
+// 用于把 RMT 等外设的原始捕获结果转换为 dhtDecodePulses 的输入.
+size_t dhtCollectHighPulses(const uint8_t* levels, const uint16_t* durationsUs, size_t segmentCount,
+                            uint16_t* highUs, size_t maxHigh);
+
+// 解码高电平宽度序列. 取最后40个高电平段作为数据位, 之前的段 (主机释放总线, 响应信号) 被忽略.
+DhtDecodeStatus dhtDecodePulses(const uint16_t* highUs, size_t count, DhtReading& out);
+
+const char* dhtDecodeStatusName(DhtDecodeStatus status);
+
+#endif // DHT_PULSE_H
@@ -0,0 +1,116 @@
+#include "dht_rmt.h"
+#include "config.h"
+#include <driver/rmt.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
+
+static const rmt_channel_t DHT_RMT_CHANNEL = (rmt_channel_t)DHT_RMT_RX_CHANNEL;
+static const uint8_t RMT_CLK_DIV = 80;                 // 80MHz APB / 80 = 1 tick/us
+static const uint16_t RMT_IDLE_THRESHOLD_US = 1000;   // 总线保持空闲超过1ms即认为一帧结束
+static const uint8_t RMT_FILTER_APB_CYCLES = 200;     // 滤除 2.5us 以下的毛刺
+static const size_t MAX_SEGMENTS = 128;
+
+enum DhtRmtPhase {
+    PHASE_IDLE,
+    PHASE_START_SIGNAL,  // 主机正在拉低总线
+    PHASE_RECEIVING      // RMT 正在接收
+};
+
+static gpio_num_t dhtPin = GPIO_NUM_NC;
+static RingbufHandle_t rmtRingbuf = NULL;
+static esp_timer_handle_t startSignalTimer = NULL;
+static volatile DhtRmtPhase phase = PHASE_IDLE;
+static unsigned long transactionStartTime = 0;
+
+// 起始信号结束: 先开启接收再释放总线, 确保捕获到传感器的响应
+static void onStartSignalDone(void* arg) {
+    rmt_rx_start(DHT_RMT_CHANNEL, true);
+    gpio_set_level(dhtPin, 1);
+    phase = PHASE_RECEIVING;
+}
+
+bool dhtRmtBegin(uint8_t pin) {
+    dhtPin = (gpio_num_t)pin;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX(dhtPin, DHT_RMT_CHANNEL);
+    config.clk_div = RMT_CLK_DIV;
+    config.mem_block_num = 2; // 一帧约43个条目, 单块 (48条) 余量不足以容纳干扰边沿
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = RMT_FILTER_APB_CYCLES;
+    config.rx_config.idle_threshold = RMT_IDLE_THRESHOLD_US;
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(DHT_RMT_CHANNEL, 1024, 0) != ESP_OK) {
+        P_PRINTLN("[DHT] ***错误*** RMT接收通道初始化失败!");
+        return false;
+    }
+    rmt_get_ringbuf_handle(DHT_RMT_CHANNEL, &rmtRingbuf);
+
+    // 开漏输出 + 输入: 主机可拉低总线, RMT 通过 GPIO 矩阵同时采样该引脚
+    gpio_set_direction(dhtPin, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(dhtPin, GPIO_PULLUP_ONLY);
+    gpio_set_level(dhtPin, 1);
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onStartSignalDone;
+    timerArgs.name = "dht_start";
+    if (esp_timer_create(&timerArgs, &startSignalTimer) != ESP_OK) {
+        P_PRINTLN("[DHT] ***错误*** 起始信号定时器创建失败!");
+        return false;
+    }
+    return true;
+}
+
+bool dhtRmtStartRead() {
+    if (startSignalTimer == NULL || phase != PHASE_IDLE) return false;
+    phase = PHASE_START_SIGNAL;
+    transactionStartTime = millis();
+    gpio_set_level(dhtPin, 0);
+    esp_timer_start_once(startSignalTimer, DHT_START_SIGNAL_MS * 1000ULL);
+    return true;
+}
+
+DhtRmtResult dhtRmtFetch(DhtReading& out) {
+    if (phase != PHASE_RECEIVING) {
+        // 起始信号阶段超时说明定时器未能触发, 复位以便下次重新开始
+        if (phase == PHASE_START_SIGNAL && millis() - transactionStartTime > DHT_START_SIGNAL_MS + DHT_RESPONSE_TIMEOUT_MS) {
+            esp_timer_stop(startSignalTimer);
+            gpio_set_level(dhtPin, 1);
+            phase = PHASE_IDLE;
+            return DHT_RMT_FAILED;
+        }
+        return DHT_RMT_NONE;
+    }
+
+    size_t length = 0;
+    rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(rmtRingbuf, &length, 0);
+    if (items == NULL) {
+        if (millis() - transactionStartTime <= DHT_START_SIGNAL_MS + DHT_RESPONSE_TIMEOUT_MS) return DHT_RMT_NONE;
+        // 总线一直为高 (传感器断开或无响应), RMT 收不到任何边沿
+        rmt_rx_stop(DHT_RMT_CHANNEL);
+        phase = PHASE_IDLE;
+        return DHT_RMT_FAILED;
+    }
+
+    // 每个 RMT 条目包含两个电平段
+    uint8_t levels[MAX_SEGMENTS];
+    uint16_t durations[MAX_SEGMENTS];
+    size_t segments = 0;
+    size_t itemCount = length / sizeof(rmt_item32_t);
+    for (size_t i = 0; i < itemCount && segments + 2 <= MAX_SEGMENTS; i++) {
+        levels[segments] = items[i].level0;
+        durations[segments++] = items[i].duration0;
+        levels[segments] = items[i].level1;
+        durations[segments++] = items[i].duration1;
+    }
+    vRingbufferReturnItem(rmtRingbuf, items);
+    rmt_rx_stop(DHT_RMT_CHANNEL);
+    phase = PHASE_IDLE;
+
+    uint16_t highUs[DHT_DATA_BITS + 4];
+    size_t highCount = dhtCollectHighPulses(levels, durations, segments, highUs, DHT_DATA_BITS + 4);
+    DhtDecodeStatus status = dhtDecodePulses(highUs, highCount, out);
+    if (status != DHT_DECODE_OK) {
+        P_PRINTF("[DHT] 解码失败: %s (%u 个高电平段)\n", dhtDecodeStatusName(status), (unsigned)highCount);
+        return DHT_RMT_FAILED;
+    }
+    return DHT_RMT_OK;
+}
@@ -0,0 +1,24 @@
+#ifndef DHT_RMT_H
+#define DHT_RMT_H
+
+#include <Arduino.h>
+#include "dht_pulse.h"
+
+// ==========================================================================
+// == DHT11 非阻塞驱动 (RMT 脉冲捕获) ==
+// == dhtRmtStartRead() 拉低总线并启动一次性定时器, 定时器到期后释放总线并
+// == 开启 RMT 接收; 40位脉冲序列由 RMT 在后台捕获, 期间不关中断也不忙等.
+// == 下一次调用 dhtRmtFetch() 时取回捕获结果并解码.
+// ==========================================================================
+
+enum DhtRmtResult {
+    DHT_RMT_NONE,    // 没有已完成的传输 (尚未开始或仍在进行)
+    DHT_RMT_OK,      // 读数有效
+    DHT_RMT_FAILED   // 传输超时或解码失败
+};
+
+bool dhtRmtBegin(uint8_t pin);
+bool dhtRmtStartRead();                     // 开始一次传输, 上一次传输未取回时返回 false
+DhtRmtResult dhtRmtFetch(DhtReading& out);  // 非阻塞地取回上一次传输的结果
+
+#endif // DHT_RMT_H
@@ -0,0 +1,237 @@
+#ifndef DSP_FILTER_H
+#define DSP_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+// ==========================================================================
+// == 多通道定点滤波器模板 ==
+// == 滤波器输入为整数样本 (如ADC码值, 绝对值须小于 2^15), 所有运算均为整数运算.
+// == 流水线: 中值滤波 (抑制尖峰) -> EMA 低通 -> 按上报周期抽取输出.
+// == RunningStats / P2Quantile 为浮点在线统计, 用于校准和基线跟踪.
+// ==========================================================================
+
+// 滑动窗口中值滤波: 每通道保存最近 Window 个样本
+template <size_t Channels, size_t Window>
+class MedianFilter {
+    static_assert(Window % 2 == 1, "Median window must be odd");
+
+public:
+    MedianFilter() { reset(); }
+
+    void reset() {
+        count = 0;
+        pos = 0;
+    }
+
+    // 写入一组样本, 输出各通道的中值 (窗口未满时取已有样本的中值)
+    void process(const int32_t in[Channels], int32_t out[Channels]) {
+        for (size_t ch = 0; ch < Channels; ch++) window[ch][pos] = in[ch];
+        pos = (pos + 1) % Window;
+        if (count < Window) count++;
+
+        for (size_t ch = 0; ch < Channels; ch++) {
+            int32_t sorted[Window];
+            for (size_t i = 0; i < count; i++) {
+                int32_t v = window[ch][i];
+                size_t j = i;
+                for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+                sorted[j] = v;
+            }
+            out[ch] = sorted[count / 2];
+        }
+    }
+
+private:
+    int32_t window[Channels][Window];
+    size_t count;
+    size_t pos;
+};
+
+// 指数移动平均: y += (x - y) / 2^Shift, 状态为 Q16 定点数. 第一个样本直接作为初值.
+template <size_t Channels, uint8_t Shift>
+class EmaFilter {
+    static_assert(Shift < 16, "EMA shift must be below the Q16 fraction width");
+
+public:
+    EmaFilter() : primed(false) {}
+
+    void reset() { primed = false; }
+
+    void process(const int32_t in[Channels]) {
+        for (size_t ch = 0; ch < Channels; ch++) {
+            const int32_t x = in[ch] * (1 << 16);
+            acc[ch] = primed ? acc[ch] + ((x - acc[ch]) >> Shift) : x;
+        }
+        primed = true;
+    }
+
+    bool isPrimed() const { return primed; }
+
+    // 四舍五入到整数
+    int32_t value(size_t ch) const { return (acc[ch] + (1 << 15)) >> 16; }
+
+private:
+    int32_t acc[Channels];
+    bool primed;
+};
+
+// 抽取滤波流水线: 以过采样速率 push(), 以上报速率 take()
+template <size_t Channels, size_t MedianWindow, uint8_t EmaShift>
+class DecimatingFilter {
+public:
+    DecimatingFilter() : pending(0) {}
+
+    // 丢弃历史状态 (如传感器断开后), 下一个样本重新作为初值
+    void reset() {
+        median.reset();
+        ema.reset();
+        pending = 0;
+    }
+
+    void push(const int32_t in[Channels]) {
+        int32_t filtered[Channels];
+        median.process(in, filtered);
+        ema.process(filtered);
+        pending++;
+    }
+
+    // 取出当前滤波结果, 返回自上次 take() 以来输入的样本数 (0 表示没有新数据, out 未写入)
+    size_t take(int32_t out[Channels]) {
+        const size_t n = pending;
+        if (n == 0) return 0;
+        for (size_t ch = 0; ch < Channels; ch++) out[ch] = ema.value(ch);
+        pending = 0;
+        return n;
+    }
+
+private:
+    MedianFilter<Channels, MedianWindow> median;
+    EmaFilter<Channels, EmaShift> ema;
+    size_t pending;
+};
+
+// Welford 在线均值/方差, 各通道独立计数
+template <size_t Channels>
+class RunningStats {
+public:
+    RunningStats() { reset(); }
+
+    void reset() {
+        for (size_t ch = 0; ch < Channels; ch++) {
+            n[ch] = 0;
+            m[ch] = 0;
+            m2[ch] = 0;
+        }
+    }
+
+    void add(size_t ch, float x) {
+        n[ch]++;
+        const float delta = x - m[ch];
+        m[ch] += delta / n[ch];
+        m2[ch] += delta * (x - m[ch]);
+    }
+
+    uint32_t count(size_t ch) const { return n[ch]; }
+    float mean(size_t ch) const { return n[ch] ? m[ch] : NAN; }
+    float variance(size_t ch) const { return n[ch] > 1 ? m2[ch] / (n[ch] - 1) : 0; }
+
+    // 变异系数 (标准差 / 均值), 均值非正时返回无穷大
+    float cv(size_t ch) const { return m[ch] > 0 ? sqrtf(variance(ch)) / m[ch] : INFINITY; }
+
+private:
+    uint32_t n[Channels];
+    float m[Channels];
+    float m2[Channels];
+};
+
+// P² 流式分位数估计 (Jain & Chlamtac): 5个标记点, 每个样本 O(1) 时间, 不保存样本
+class P2Quantile {
+public:
+    explicit P2Quantile(float quantile = 0.5f) { reset(quantile); }
+
+    void reset(float quantile) {
+        p = quantile;
+        n = 0;
+    }
+
+    void add(float x) {
+        if (n < 5) {
+            q[n++] = x;
+            if (n == 5) {
+                for (int i = 1; i < 5; i++) { // 插入排序初始的5个样本
+                    float v = q[i];
+                    int j = i;
+                    for (; j > 0 && q[j - 1] > v; j--) q[j] = q[j - 1];
+                    q[j] = v;
+                }
+                for (int i = 0; i < 5; i++) pos[i] = i + 1;
+                desired[0] = 1; desired[1] = 1 + 2 * p; desired[2] = 1 + 4 * p; desired[3] = 3 + 2 * p; desired[4] = 5;
+                step[0] = 0; step[1] = p / 2; step[2] = p; step[3] = (1 + p) / 2; step[4] = 1;
+            }
+            return;
+        }
+
+        int k;
+        if (x < q[0]) {
+            q[0] = x;
+            k = 0;
+        } else if (x >= q[4]) {
+            q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (k < 3 && x >= q[k + 1]) k++;
+        }
+        for (int i = k + 1; i < 5; i++) pos[i]++;
+        for (int i = 0; i < 5; i++) desired[i] += step[i];
+
+        for (int i = 1; i < 4; i++) {
+            const float d = desired[i] - pos[i];
+            if ((d >= 1 && pos[i + 1] - pos[i] > 1) || (d <= -1 && pos[i - 1] - pos[i] < -1)) {
+                const int s = d > 0 ? 1 : -1;
+                const float candidate = parabolic(i, s);
+                q[i] = (q[i - 1] < candidate && candidate < q[i + 1]) ? candidate : linear(i, s);
+                pos[i] += s;
+            }
+        }
+        n++;
+    }
+
+    uint32_t count() const { return n; }
+
+    // 样本不足5个时返回已有样本中最接近的顺序统计量
+    float value() const {
+        if (n == 0) return NAN;
+        if (n >= 5) return q[2];
+        float sorted[5];
+        for (uint32_t i = 0; i < n; i++) {
+            float v = q[i];
+            uint32_t j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+            sorted[j] = v;
+        }
+        return sorted[(uint32_t)(p * (n - 1) + 0.5f)];
+    }
+
+private:
+    float parabolic(int i, int s) const {
+        return q[i] + (float)s / (pos[i + 1] - pos[i - 1]) *
+               ((pos[i] - pos[i - 1] + s) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i]) +
+                (pos[i + 1] - pos[i] - s) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+    }
+
+    float linear(int i, int s) const {
+        return q[i] + s * (q[i + s] - q[i]) / (pos[i + s] - pos[i]);
+    }
+
+    float p;
+    uint32_t n;
+    float q[5];        // 标记点高度
+    int32_t pos[5];    // 标记点实际位置
+    float desired[5];  // 标记点期望位置
+    float step[5];     // 期望位置每个样本的增量
+};
+
+#endif // DSP_FILTER_H
@@ -0,0 +1,51 @@
+#include "gas_ppm.h"
+#include "config.h"
+#include <math.h>
+
+struct GasCurve {
+    float slope;
+    float intercept;
+};
+
+static const GasCurve GAS_CURVES[GAS_PPM_CHANNELS] = {
+    { -2.82f, -0.12f },  // CO
+    {  1.9f,  -0.2f  },  // NO2
+    { -2.0f,  -0.5f  },  // C2H5OH
+    { -2.5f,  -0.6f  }   // VOC
+};
+
+static_assert(GAS_PPM_TABLE_SIZE == (int)ADC_RESOLUTION + 1, "PPM table must cover every ADC code");
+
+float adcToRs(int adc_val) {
+    if (adc_val <= 0) return -1.0f;
+    float v_out = (float)adc_val * SENSOR_VCC / ADC_RESOLUTION;
+    if (v_out >= SENSOR_VCC) return -1.0f;
+    return (SENSOR_VCC * GAS_RL_VALUE_KOHM / v_out) - GAS_RL_VALUE_KOHM;
+}
+
+int rsToAdc(float rs) {
+    if (!(rs > 0)) return 0;
+    // Rs = RL * (VCC / Vout - 1)  =>  Vout = VCC * RL / (Rs + RL)
+    float adc = ADC_RESOLUTION * GAS_RL_VALUE_KOHM / (rs + GAS_RL_VALUE_KOHM);
+    int code = (int)lroundf(adc);
+    return code < 1 ? 1 : (code > (int)ADC_RESOLUTION - 1 ? (int)ADC_RESOLUTION - 1 : code);
+}
+
+float gasCurvePpm(uint8_t channel, float rs, float r0) {
+    if (channel >= GAS_PPM_CHANNELS || !(rs > 0) || !(r0 > 0)) return NAN;
+    const GasCurve& curve = GAS_CURVES[channel];
+    return powf(10.0f, curve.intercept) * powf(rs / r0, curve.slope);
+}
+
+bool gasChannelIsReducing(uint8_t channel) {
+    return channel < GAS_PPM_CHANNELS && GAS_CURVES[channel].slope < 0;
+}
+
+void gasBuildPpmTable(uint8_t channel, float r0, float* table) {
+    const GasCurve& curve = GAS_CURVES[channel < GAS_PPM_CHANNELS ? channel : 0];
+    const float scale = powf(10.0f, curve.intercept);
+    for (int adc = 0; adc < GAS_PPM_TABLE_SIZE; adc++) {
+        float rs = adcToRs(adc);
+        table[adc] = (channel < GAS_PPM_CHANNELS && rs > 0 && r0 > 0) ? scale * powf(rs / r0, curve.slope) : NAN;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef GAS_PPM_H
+#define GAS_PPM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================================================
+// == 气体浓度换算 (纯函数, 不依赖硬件) ==
+// == ADC 读数 -> 传感器电阻 Rs (分压电路, 负载电阻 RL), 再按各通道的对数曲线
+// == lg(PPM) = slope * lg(Rs/R0) + intercept 换算为 PPM.
+// == 通道顺序与 GasChannel 相同: CO, NO2, C2H5OH, VOC.
+// ==========================================================================
+
+#define GAS_PPM_CHANNELS 4
+#define GAS_PPM_TABLE_SIZE 4096     // 12位ADC读数 0~4095 各对应一个表项
+#define GAS_RL_VALUE_KOHM 10.0f     // 传感器负载电阻 (RL), 单位 kOhm
+
+// ADC 读数换算为 Rs (kOhm), 读数无效 (0 或满量程) 时返回 -1
+float adcToRs(int adc_val);
+
+// adcToRs 的逆运算: Rs (kOhm) 换算为最接近的 ADC 读数 (用于回放记录的 Rs)
+int rsToAdc(float rs);
+
+// 按曲线直接计算 PPM, Rs 或 R0 无效时返回 NaN
+float gasCurvePpm(uint8_t channel, float rs, float r0);
+
+// 还原性气体通道 (曲线斜率为负, Rs 随浓度下降) 返回 true, 氧化性气体 (NO2) 返回 false
+bool gasChannelIsReducing(uint8_t channel);
+
+// 为一个通道生成 GAS_PPM_TABLE_SIZE 项的 ADC -> PPM 查找表
+void gasBuildPpmTable(uint8_t channel, float r0, float* table);
+
+#endif // GAS_PPM_H
@@ -0,0 +1,105 @@
+#include "gas_sensor.h"
+#include "config.h"
+#include <Wire.h>
+#include "Multichannel_Gas_GMXXX.h"
+
+// 传感器固件的通道读取命令 (与 Multichannel_Gas_GMXXX 库一致)
+static const uint8_t CMD_GM102B = 0x01;
+static const uint8_t CMD_GM302B = 0x03;
+static const uint8_t CMD_GM502B = 0x05;
+static const uint8_t CMD_GM702B = 0x07;
+
+static GAS_GMXXX<TwoWire> gasSensorLib; // 仅用于发送预热命令
+static GasBusStats stats;
+static unsigned long nextRetryTime = 0;
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 写命令字节后读回4字节小端数据; 任一步出错返回 false
+static bool readChannel(uint8_t cmd, uint32_t& value) {
+    Wire.beginTransmission(GAS_SENSOR_I2C_ADDRESS);
+    Wire.write(cmd);
+    if (Wire.endTransmission() != 0) return false;
+    if (Wire.requestFrom((uint16_t)GAS_SENSOR_I2C_ADDRESS, (size_t)4) != 4) return false;
+    value = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        value |= (uint32_t)(Wire.read() & 0xFF) << (8 * i);
+    }
+    return true;
+}
+
+static void markPresent() {
+    if (!stats.present) {
+        P_PRINTLN("[GAS] 气体传感器在线.");
+        gasSensorLib.begin(Wire, GAS_SENSOR_I2C_ADDRESS); // 传感器可能重新上电过, 重新发送预热命令
+    }
+    portENTER_CRITICAL(&statsMux);
+    stats.present = true;
+    stats.consecutiveFailures = 0;
+    stats.retryIntervalMs = 0;
+    portEXIT_CRITICAL(&statsMux);
+}
+
+static void markFailed() {
+    uint32_t interval = GAS_SENSOR_RETRY_MIN_MS;
+    portENTER_CRITICAL(&statsMux);
+    bool wasPresent = stats.present;
+    stats.present = false;
+    stats.failures++;
+    stats.consecutiveFailures++;
+    for (uint32_t i = 1; i < stats.consecutiveFailures && interval < GAS_SENSOR_RETRY_MAX_MS; i++) {
+        interval *= 2;
+    }
+    if (interval > GAS_SENSOR_RETRY_MAX_MS) interval = GAS_SENSOR_RETRY_MAX_MS;
+    stats.retryIntervalMs = interval;
+    portEXIT_CRITICAL(&statsMux);
+    nextRetryTime = millis() + interval;
+    if (wasPresent) {
+        P_PRINTLN("[GAS] ***警告*** 气体传感器读取失败, 标记为离线.");
+    }
+}
+
+void gasSensorBegin() {
+    stats = GasBusStats();
+    GasRawReading reading;
+    if (gasSensorReadAll(reading) == GAS_READ_OK) { // 成功时 markPresent() 发送预热命令
+        P_PRINTLN("[HW] Grove多通道气体传感器V2已连接.");
+    } else {
+        P_PRINTLN("[HW] ***错误*** 未检测到Grove多通道气体传感器V2!");
+    }
+}
+
+GasReadResult gasSensorReadAll(GasRawReading& out) {
+    if (!stats.present && (long)(millis() - nextRetryTime) < 0) return GAS_READ_ABSENT;
+
+    unsigned long startUs = micros();
+    bool ok = readChannel(CMD_GM702B, out.co) &&
+              readChannel(CMD_GM102B, out.no2) &&
+              readChannel(CMD_GM302B, out.c2h5oh) &&
+              readChannel(CMD_GM502B, out.voc);
+    uint32_t elapsedUs = micros() - startUs;
+
+    portENTER_CRITICAL(&statsMux);
+    stats.bursts++;
+    stats.lastBurstUs = elapsedUs;
+    stats.totalBurstUs += elapsedUs;
+    if (elapsedUs > stats.maxBurstUs) stats.maxBurstUs = elapsedUs;
+    portEXIT_CRITICAL(&statsMux);
+
+    if (!ok) {
+        markFailed();
+        return GAS_READ_FAILED;
+    }
+    markPresent();
+    return GAS_READ_OK;
+}
+
+bool gasSensorPresent() {
+    return stats.present;
+}
+
+GasBusStats getGasBusStats() {
+    portENTER_CRITICAL(&statsMux);
+    GasBusStats copy = stats;
+    portEXIT_CRITICAL(&statsMux);
+    return copy;
+}
@@ -0,0 +1,46 @@
+#ifndef GAS_SENSOR_H
+#define GAS_SENSOR_H
+
+#include <Arduino.h>
+
+// ==========================================================================
+// == Grove 多通道气体传感器 V2 采集层 ==
+// == 四个通道在一次突发中连续读取, 不再每次读取前做 I2C 探测. 传感器是否在线
+// == 由实际读取的结果判断; 离线期间按指数退避间隔重新尝试.
+// ==========================================================================
+
+// 通道索引 (与 GasRawReading 的字段顺序一致)
+enum GasChannel { GAS_CH_CO, GAS_CH_NO2, GAS_CH_C2H5OH, GAS_CH_VOC, GAS_CHANNEL_COUNT };
+
+// 各通道的原始ADC读数
+struct GasRawReading {
+    uint32_t co;      // GM702B
+    uint32_t no2;     // GM102B
+    uint32_t c2h5oh;  // GM302B
+    uint32_t voc;     // GM502B
+};
+
+enum GasReadResult {
+    GAS_READ_OK,
+    GAS_READ_FAILED,  // 本次读取出错 (传感器随即被标记为离线)
+    GAS_READ_ABSENT   // 传感器离线且未到重试时间, 本次未访问总线
+};
+
+// 总线健康统计
+struct GasBusStats {
+    bool present;                  // 最近一次读取是否成功
+    uint32_t bursts;               // 实际访问总线的突发读取次数
+    uint32_t failures;             // 失败次数
+    uint32_t consecutiveFailures;  // 连续失败次数 (决定退避间隔)
+    uint32_t lastBurstUs;          // 最近一次突发读取的总线耗时
+    uint32_t maxBurstUs;           // 最长总线耗时
+    uint64_t totalBurstUs;         // 总线耗时累计 (平均值 = totalBurstUs / bursts)
+    uint32_t retryIntervalMs;      // 当前离线重试间隔 (在线时为0)
+};
+
+void gasSensorBegin();                       // 初始化 (I2C 总线须已启动), 返回前完成首次读取
+GasReadResult gasSensorReadAll(GasRawReading& out);
+bool gasSensorPresent();
+GasBusStats getGasBusStats();
+
+#endif // GAS_SENSOR_H
@@ -0,0 +1,159 @@
+#include "health_monitor.h"
+#include "ring_buffer.h"
+
+#ifdef CONFIG_ARDUINO_LOOP_STACK_SIZE
+#define LOOP_TASK_STACK_SIZE CONFIG_ARDUINO_LOOP_STACK_SIZE
+#else
+#define LOOP_TASK_STACK_SIZE 8192
+#endif
+
+struct HealthTask {
+    TaskHandle_t handle;
+    const char* name;
+    uint32_t stackSize;
+    uint32_t lastRunTime;   // 上次采样时的累计运行时间 (运行时间统计启用时)
+};
+
+static HealthTask tasks[HEALTH_MAX_TASKS];
+static uint8_t taskCount = 0;
+static Ring<HealthSample, HEALTH_HISTORY_SIZE> samples;
+static portMUX_TYPE healthMux = portMUX_INITIALIZER_UNLOCKED;
+static unsigned long lastSampleTime = 0;
+static bool sampledOnce = false;
+
+void healthRegisterTask(TaskHandle_t handle, const char* name, uint32_t stackSize) {
+    if (handle == NULL || taskCount >= HEALTH_MAX_TASKS) return;
+    portENTER_CRITICAL(&healthMux);
+    HealthTask& task = tasks[taskCount];
+    task.handle = handle;
+    task.name = name;
+    task.stackSize = stackSize;
+    task.lastRunTime = 0;
+    taskCount++;
+    portEXIT_CRITICAL(&healthMux);
+}
+
+void healthRegisterSystemTasks() {
+    healthRegisterTask(xTaskGetCurrentTaskHandle(), "loopTask", LOOP_TASK_STACK_SIZE);
+    healthRegisterTask(xTaskGetIdleTaskHandleForCPU(0), "IDLE0", 0);
+    healthRegisterTask(xTaskGetIdleTaskHandleForCPU(1), "IDLE1", 0);
+}
+
+// -- CPU 占用 --
+// 用两次采样之间各任务运行时间的增量除以总运行时间的增量 (单个核心的时间)
+
+#if configGENERATE_RUN_TIME_STATS
+static TaskStatus_t taskStatusBuffer[HEALTH_TASK_STATUS_MAX];
+static uint32_t lastTotalRunTime = 0;
+
+static void sampleCpuShare(HealthSample& sample) {
+    uint32_t totalRunTime = 0;
+    UBaseType_t n = uxTaskGetSystemState(taskStatusBuffer, HEALTH_TASK_STATUS_MAX, &totalRunTime);
+    const uint32_t totalDelta = totalRunTime - lastTotalRunTime;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        sample.cpuPermille[i] = -1;
+        for (UBaseType_t k = 0; k < n; k++) {
+            if (taskStatusBuffer[k].xHandle != tasks[i].handle) continue;
+            const uint32_t runTime = taskStatusBuffer[k].ulRunTimeCounter;
+            if (sampledOnce && totalDelta > 0) {
+                sample.cpuPermille[i] = (int16_t)min((uint64_t)1000, (uint64_t)(runTime - tasks[i].lastRunTime) * 1000 / totalDelta);
+            }
+            tasks[i].lastRunTime = runTime;
+            break;
+        }
+    }
+    lastTotalRunTime = totalRunTime;
+}
+#else
+static void sampleCpuShare(HealthSample& sample) {
+    for (uint8_t i = 0; i < taskCount; i++) sample.cpuPermille[i] = -1;
+}
+#endif
+
+static void takeSample() {
+    HealthSample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.uptimeS = millis() / 1000;
+    sample.freeHeap = ESP.getFreeHeap();
+    sample.minFreeHeap = ESP.getMinFreeHeap();
+    sample.largestFreeBlock = ESP.getMaxAllocHeap();
+    sample.fragmentationPct = sample.freeHeap ? (uint8_t)(100 - (uint64_t)sample.largestFreeBlock * 100 / sample.freeHeap) : 0;
+
+    uint32_t worstStackFree = UINT32_MAX;
+    const char* worstTask = "";
+    for (uint8_t i = 0; i < taskCount; i++) {
+        // ESP-IDF 中堆栈以字节为单位
+        const uint32_t stackFree = uxTaskGetStackHighWaterMark(tasks[i].handle);
+        sample.stackFree[i] = (uint16_t)min(stackFree, (uint32_t)UINT16_MAX);
+        if (tasks[i].stackSize && stackFree < worstStackFree) {
+            worstStackFree = stackFree;
+            worstTask = tasks[i].name;
+        }
+    }
+    sampleCpuShare(sample);
+    sampledOnce = true;
+
+    portENTER_CRITICAL(&healthMux);
+    samples.push(sample);
+    portEXIT_CRITICAL(&healthMux);
+
+    P_PRINTF("[HEALTH] 堆: 空闲 %lu, 最低 %lu, 最大块 %lu, 碎片 %u%%; 堆栈余量最小: %s %lu B\n",
+             (unsigned long)sample.freeHeap, (unsigned long)sample.minFreeHeap,
+             (unsigned long)sample.largestFreeBlock, sample.fragmentationPct,
+             worstTask, (unsigned long)(worstStackFree == UINT32_MAX ? 0 : worstStackFree));
+    if (worstStackFree < HEALTH_STACK_WARN_BYTES) {
+        P_PRINTF("[HEALTH] 警告: 任务 %s 堆栈余量仅 %lu B.\n", worstTask, (unsigned long)worstStackFree);
+    }
+}
+
+void processHealthSampling() {
+    unsigned long now = millis();
+    if (sampledOnce && now - lastSampleTime < HEALTH_SAMPLE_INTERVAL_MS) return;
+    lastSampleTime = now;
+    takeSample();
+}
+
+// ==========================================================================
+// == 查询 ==
+// ==========================================================================
+
+uint8_t healthTaskCount() {
+    return taskCount;
+}
+
+const char* healthTaskName(uint8_t index) {
+    return index < taskCount ? tasks[index].name : "";
+}
+
+uint32_t healthTaskStackSize(uint8_t index) {
+    return index < taskCount ? tasks[index].stackSize : 0;
+}
+
+size_t healthSampleCount() {
+    portENTER_CRITICAL(&healthMux);
+    size_t n = samples.count();
+    portEXIT_CRITICAL(&healthMux);
+    return n;
+}
+
+bool healthGetSample(size_t index, HealthSample& out) {
+    bool found = false;
+    portENTER_CRITICAL(&healthMux);
+    if (index < samples.count()) {
+        out = samples[index];
+        found = true;
+    }
+    portEXIT_CRITICAL(&healthMux);
+    return found;
+}
+
+bool healthGetLatest(HealthSample& out) {
+    bool found = false;
+    portENTER_CRITICAL(&healthMux);
+    if (!samples.isEmpty()) {
+        out = samples.newest();
+        found = true;
+    }
+    portEXIT_CRITICAL(&healthMux);
+    return found;
+}
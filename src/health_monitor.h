@@ -0,0 +1,44 @@
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ==========================================================================
+// == 运行健康采样 ==
+// == 每 HEALTH_SAMPLE_INTERVAL_MS 记录一次堆内存 (空闲/历史最低/最大空闲块/碎片率)
+// == 和已登记任务的堆栈剩余最小值 (high-water mark) 与 CPU 占用, 保存在定长环形缓冲区中.
+// == CPU 占用需要 FreeRTOS 运行时间统计 (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS),
+// == 未启用时记为 -1.
+// ==========================================================================
+
+#define HEALTH_MAX_TASKS 8
+
+struct HealthSample {
+    uint32_t uptimeS;
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;                   // 启动以来的最低空闲堆
+    uint32_t largestFreeBlock;              // 可一次分配的最大连续块
+    uint8_t fragmentationPct;               // 100 * (1 - 最大空闲块 / 空闲堆)
+    uint16_t stackFree[HEALTH_MAX_TASKS];   // 各任务堆栈剩余最小值 (字节)
+    int16_t cpuPermille[HEALTH_MAX_TASKS];  // 两次采样之间占单个核心时间的千分比, -1 表示不可用
+};
+
+// 登记需要监控的任务 (stackSize 为 0 表示未知, 如系统空闲任务)
+void healthRegisterTask(TaskHandle_t handle, const char* name, uint32_t stackSize);
+// 登记 loop 任务和两个核心的空闲任务, 在 setup() 中调用
+void healthRegisterSystemTasks();
+
+// 在 loop 中调用, 到达采样间隔时采样一次
+void processHealthSampling();
+
+uint8_t healthTaskCount();
+const char* healthTaskName(uint8_t index);
+uint32_t healthTaskStackSize(uint8_t index);
+
+size_t healthSampleCount();
+// 按时间顺序复制一个样本 (0 为最旧), 越界时返回 false. 可在任意任务中调用.
+bool healthGetSample(size_t index, HealthSample& out);
+bool healthGetLatest(HealthSample& out);
+
+#endif // HEALTH_MONITOR_H
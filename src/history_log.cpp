@@ -0,0 +1,208 @@
+#include "history_log.h"
+#include "config.h"
+
+// ==========================================================================
+// == CRC32 ==
+// ==========================================================================
+
+uint32_t crc32Compute(const uint8_t* data, size_t length, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+// ==========================================================================
+// == RecordLog 方法实现 ==
+// ==========================================================================
+
+RecordLog::RecordLog(const char* pathPrefix, size_t payloadSize, uint8_t segmentCount, uint16_t recordsPerSegment) :
+    fs(NULL), prefix(pathPrefix),
+    payloadSize(min(payloadSize, (size_t)RECORD_LOG_MAX_PAYLOAD)),
+    segmentCount(constrain(segmentCount, (uint8_t)2, (uint8_t)RECORD_LOG_MAX_SEGMENTS)),
+    recordsPerSegment(recordsPerSegment),
+    activeSegment(0), activeRecords(0), seqCounter(0), bytesWritten(0) {}
+
+size_t RecordLog::recordSize() const {
+    return sizeof(RecordLogHeader) + payloadSize + sizeof(uint32_t);
+}
+
+void RecordLog::segmentPath(uint8_t index, char* out, size_t outLen) const {
+    snprintf(out, outLen, "%s_%u.bin", prefix, index);
+}
+
+bool RecordLog::openSegment(uint8_t index, bool truncate) {
+    if (activeFile) activeFile.close();
+    char path[32];
+    segmentPath(index, path, sizeof(path));
+    activeSegment = index;
+    if (truncate) activeRecords = 0;
+    activeFile = fs->open(path, truncate ? "w" : "a");
+    if (!activeFile) {
+        P_PRINTF("[LOG] 打开分段 %s 失败.\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool RecordLog::readRecord(File& file, uint8_t* buf, uint32_t* seq) const {
+    const size_t recSize = recordSize();
+    if (file.read(buf, recSize) != recSize) return false;
+
+    RecordLogHeader header;
+    memcpy(&header, buf, sizeof(header));
+    if (header.magic != RECORD_LOG_MAGIC || header.payloadSize != payloadSize) return false;
+
+    uint32_t storedCrc;
+    memcpy(&storedCrc, buf + recSize - sizeof(uint32_t), sizeof(storedCrc));
+    if (crc32Compute(buf, recSize - sizeof(uint32_t)) != storedCrc) return false;
+
+    *seq = header.seq;
+    return true;
+}
+
+bool RecordLog::truncateSegment(uint8_t index, uint16_t keepRecords) {
+    char path[32], tmpPath[32];
+    segmentPath(index, path, sizeof(path));
+    snprintf(tmpPath, sizeof(tmpPath), "%s_tmp.bin", prefix);
+
+    const size_t recSize = recordSize();
+    uint8_t buf[sizeof(RecordLogHeader) + RECORD_LOG_MAX_PAYLOAD + sizeof(uint32_t)];
+    File src = fs->open(path, "r");
+    File dst = fs->open(tmpPath, "w");
+    bool ok = src && dst;
+    for (uint16_t i = 0; ok && i < keepRecords; i++) {
+        ok = (src.read(buf, recSize) == recSize) && (dst.write(buf, recSize) == recSize);
+    }
+    if (src) src.close();
+    if (dst) dst.close();
+    ok = ok && fs->remove(path) && fs->rename(tmpPath, path);
+    P_PRINTF("[LOG] %s: 截断残缺分段 %u 至 %u 条记录%s.\n", prefix, index, keepRecords, ok ? "" : " 失败");
+    return ok;
+}
+
+size_t RecordLog::recover(fs::FS& filesystem, RecordLogVisitor visitor, void* ctx) {
+    fs = &filesystem;
+    if (activeFile) activeFile.close();
+
+    const size_t recSize = recordSize();
+    uint8_t buf[sizeof(RecordLogHeader) + RECORD_LOG_MAX_PAYLOAD + sizeof(uint32_t)];
+    char path[32];
+
+    // 1. 读取每个分段首条记录的序号, 并按序号从旧到新排列分段
+    uint8_t order[RECORD_LOG_MAX_SEGMENTS];
+    uint32_t firstSeq[RECORD_LOG_MAX_SEGMENTS];
+    uint8_t found = 0;
+    for (uint8_t i = 0; i < segmentCount; i++) {
+        segmentPath(i, path, sizeof(path));
+        if (!fs->exists(path)) continue;
+        File file = fs->open(path, "r");
+        uint32_t seq = 0;
+        bool valid = file && readRecord(file, buf, &seq);
+        if (file) file.close();
+        if (!valid) continue;
+
+        uint8_t pos = found;
+        while (pos > 0 && firstSeq[pos - 1] > seq) {
+            firstSeq[pos] = firstSeq[pos - 1];
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        firstSeq[pos] = seq;
+        order[pos] = i;
+        found++;
+    }
+
+    // 2. 按顺序回放各分段中的完整记录, 遇到残缺或CRC错误的记录即停止该分段
+    size_t recovered = 0;
+    bool haveSeq = false;
+    uint32_t lastSeq = 0;
+    uint8_t newestSegment = 0;
+    uint16_t newestCount = 0;
+    bool newestIntact = false;
+    for (uint8_t k = 0; k < found; k++) {
+        segmentPath(order[k], path, sizeof(path));
+        File file = fs->open(path, "r");
+        if (!file) continue;
+        uint16_t count = 0;
+        uint32_t seq = 0;
+        while (count < recordsPerSegment && readRecord(file, buf, &seq)) {
+            if (haveSeq && seq <= lastSeq) break;
+            visitor(buf + sizeof(RecordLogHeader), seq, ctx);
+            lastSeq = seq;
+            haveSeq = true;
+            count++;
+        }
+        recovered += count;
+        newestSegment = order[k];
+        newestCount = count;
+        newestIntact = (file.size() == (size_t)count * recSize);
+        file.close();
+    }
+
+    // 3. 最新分段尾部若有残缺记录 (写入时掉电), 重写其有效前缀以保持记录对齐
+    if (found > 0 && !newestIntact && newestCount < recordsPerSegment) {
+        newestIntact = truncateSegment(newestSegment, newestCount);
+    }
+
+    // 4. 确定追加位置: 最新分段未满则继续追加, 否则轮转到下一个分段
+    seqCounter = haveSeq ? lastSeq + 1 : 0;
+    if (found == 0) {
+        openSegment(0, true);
+    } else if (newestIntact && newestCount < recordsPerSegment) {
+        activeRecords = newestCount;
+        openSegment(newestSegment, false);
+    } else {
+        openSegment((newestSegment + 1) % segmentCount, true);
+    }
+    P_PRINTF("[LOG] %s: 从 %u 个分段恢复 %u 条记录, 下一序号 %lu.\n",
+             prefix, found, recovered, (unsigned long)seqCounter);
+    return recovered;
+}
+
+bool RecordLog::append(const void* payload) {
+    if (!fs) return false;
+    if (activeRecords >= recordsPerSegment) {
+        if (!openSegment((activeSegment + 1) % segmentCount, true)) return false;
+    } else if (!activeFile) {
+        if (!openSegment(activeSegment, activeRecords == 0)) return false;
+    }
+
+    const size_t recSize = recordSize();
+    uint8_t buf[sizeof(RecordLogHeader) + RECORD_LOG_MAX_PAYLOAD + sizeof(uint32_t)];
+    RecordLogHeader header = { RECORD_LOG_MAGIC, (uint16_t)payloadSize, seqCounter };
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header), payload, payloadSize);
+    uint32_t crc = crc32Compute(buf, sizeof(header) + payloadSize);
+    memcpy(buf + sizeof(header) + payloadSize, &crc, sizeof(crc));
+
+    size_t written = activeFile.write(buf, recSize);
+    activeFile.flush();
+    if (written != recSize) {
+        // 分段尾部可能留下残缺记录, 下一次追加直接轮转到新分段以保持对齐
+        P_PRINTF("[LOG] %s: 写入记录失败 (%u/%u B).\n", prefix, written, recSize);
+        activeFile.close();
+        activeRecords = recordsPerSegment;
+        return false;
+    }
+    activeRecords++;
+    seqCounter++;
+    bytesWritten += written;
+    return true;
+}
+
+void RecordLog::clear() {
+    if (activeFile) activeFile.close();
+    if (!fs) return;
+    char path[32];
+    for (uint8_t i = 0; i < segmentCount; i++) {
+        segmentPath(i, path, sizeof(path));
+        if (fs->exists(path)) fs->remove(path);
+    }
+    activeSegment = 0;
+    activeRecords = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// ==========================================================================
+// == 追加式二进制记录日志 ==
+// == 记录定长, 按分段文件轮转追加写入. 每条记录带递增序号和CRC32,
+// == 启动时扫描全部分段, 按序号回放所有完整记录, 残缺的尾部记录被丢弃.
+// ==========================================================================
+
+#define RECORD_LOG_MAGIC 0x4C52       // 记录魔数 ('RL')
+#define RECORD_LOG_MAX_PAYLOAD 96     // 单条记录负载上限 (字节)
+#define RECORD_LOG_MAX_SEGMENTS 8     // 分段文件数量上限
+
+// 记录头. 磁盘布局: [RecordLogHeader][负载][CRC32], CRC覆盖记录头和负载.
+struct RecordLogHeader {
+    uint16_t magic;
+    uint16_t payloadSize;
+    uint32_t seq;
+};
+
+// 恢复时对每条有效记录的回调 (按序号从旧到新)
+typedef void (*RecordLogVisitor)(const uint8_t* payload, uint32_t seq, void* ctx);
+
+class RecordLog {
+public:
+    RecordLog(const char* pathPrefix, size_t payloadSize, uint8_t segmentCount, uint16_t recordsPerSegment);
+
+    // 扫描所有分段并回放有效记录, 同时确定下一次追加的位置. 返回恢复的记录数.
+    size_t recover(fs::FS& filesystem, RecordLogVisitor visitor, void* ctx);
+    // 追加一条记录 (负载长度固定为构造时的 payloadSize). 写入成本与历史长度无关.
+    bool append(const void* payload);
+    // 删除全部分段文件
+    void clear();
+
+    size_t recordSize() const;
+    uint32_t nextSeq() const { return seqCounter; }
+    uint32_t totalBytesWritten() const { return bytesWritten; }
+
+private:
+    void segmentPath(uint8_t index, char* out, size_t outLen) const;
+    bool openSegment(uint8_t index, bool truncate);
+    bool readRecord(File& file, uint8_t* buf, uint32_t* seq) const;
+    bool truncateSegment(uint8_t index, uint16_t keepRecords);
+
+    fs::FS* fs;
+    File activeFile;
+    const char* prefix;
+    size_t payloadSize;
+    uint8_t segmentCount;
+    uint16_t recordsPerSegment;
+    uint8_t activeSegment;
+    uint16_t activeRecords;
+    uint32_t seqCounter;
+    uint32_t bytesWritten;
+};
+
+// 标准 CRC-32 (IEEE 802.3, 反射多项式 0xEDB88320). 传入上次结果可分段计算.
+uint32_t crc32Compute(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+#endif // HISTORY_LOG_H
@@ -7,6 +7,10 @@
 #include "config.h"
 #include "data_manager.h"
 #include "sensor_handler.h"
+#include "storage_task.h"
+#include "perf_stats.h"
+#include "health_monitor.h"
+#include "sensor_simulator.h"
 #include "web_handler.h"
 #include "onenet_handler.h" // 包含OneNET头文件
 
@@ -17,6 +21,9 @@ void setup() {
     Serial.begin(115200);
     P_PRINTLN("\n[SETUP] 系统启动中...");
 
+    // 健康采样监控 loop 任务和两个核心的空闲任务, 其他任务在创建时登记
+    healthRegisterSystemTasks();
+
     // 初始化硬件
     initHardware();
 
@@ -25,8 +32,12 @@ void setup() {
 
     // 加载配置和历史数据
     loadConfig(currentConfig);
+    publishSensorParams(currentConfig);
     loadHistoricalDataFromFile(historicalData);
 
+    // 此后的 flash 写入都交给后台存储任务 (之前的加载/迁移在此处同步完成)
+    startStorageTask();
+
     // 根据加载的配置更新硬件状态
     updateLedBrightness(currentConfig.ledBrightness);
 
@@ -36,23 +47,14 @@ void setup() {
     // 设置气体传感器预热结束时间
     gasSensorWarmupEndTime = millis() + GAS_SENSOR_WARMUP_PERIOD_MS;
 
-    // 创建用于校准的信号量和任务
-    calibrationSemaphore = xSemaphoreCreateBinary();
-    if (calibrationSemaphore != NULL) {
-        P_PRINTLN("[SETUP] 校准信号量创建成功。");
-        xTaskCreatePinnedToCore(
-            calibrationTask,          // 任务函数
-            "CalibrationTask",        // 任务名称
-            4096,                     // 堆栈大小 (Bytes)
-            NULL,                     // 任务输入参数
-            1,                        // 任务优先级
-            &calibrationTaskHandle,   // 任务句柄
-            0                         // 核心
-        );
-        P_PRINTLN("[SETUP] 校准任务创建成功并已启动。");
-    } else {
-        P_PRINTLN("[SETUP] ***错误*** 校准信号量创建失败！");
-    }
+#if SENSOR_SIMULATION
+    // 不读取硬件, 由模拟数据源驱动整条处理流程
+    simulatorBegin(DEFAULT_SIMULATOR_PROFILE);
+    setSensorSource(&SIMULATED_SENSOR_SOURCE);
+#endif
+
+    // 启动固定周期的传感器采样任务
+    startSensorTask();
 
     // 初始化并启动OneNET MQTT任务
     initOneNetMqttTask();
@@ -64,44 +66,73 @@ void setup() {
 // == Arduino `loop()` 函数 ==
 // ==========================================================================
 void loop() {
+    PERF_SCOPE(PERF_LOOP_TOTAL);
+
     // 处理网络相关任务
-    network_loop();
+    {
+        PERF_SCOPE(PERF_NETWORK_LOOP);
+        network_loop();
+    }
 
     // 获取当前时间
     unsigned long currentTime = millis();
 
-    // 周期性地执行传感器读取、警报检查和数据记录
-    if (currentTime - lastSensorReadTime >= SENSOR_READ_INTERVAL_MS) {
-        lastSensorReadTime = currentTime;
-        
-        // 只有在非校准状态下才进行常规读数和警报检查
-        if (currentState.calibrationState == CAL_IDLE) {
-            readSensors(currentState, currentConfig);
-            checkAlarms(currentState, currentConfig);
-            addHistoricalDataPoint(historicalData, currentState);
-        }
+    // 取采样任务发布的最新快照; 序号变化说明有新样本, 记录到历史数据
+    static DeviceState snapshot;
+    static uint32_t lastSampleSeq = 0;
+    uint32_t sampleSeq = getDeviceStateSnapshot(snapshot);
+    if (sampleSeq != lastSampleSeq) {
+        lastSampleSeq = sampleSeq;
+        PERF_SCOPE(PERF_HISTORY_APPEND);
+        addHistoricalDataPoint(historicalData, snapshot);
     }
 
+    // 采样任务修改了 R0 (校准完成或基线调整), 取回到配置中并持久化 (在推送校准状态之前, 使其带上新的 R0)
+    static uint32_t lastR0Revision = 0;
+    uint32_t r0Rev = getR0Revision();
+    if (r0Rev != lastR0Revision) {
+        lastR0Revision = r0Rev;
+        SensorParams params = getSensorParams();
+        currentConfig.r0Values = params.r0Values;
+        currentConfig.r0Calibrated = params.r0Calibrated;
+        saveConfig(currentConfig);
+    }
+
+    // 校准状态由校准任务更新, 版本号变化时推送给客户端
+    static uint32_t lastCalibrationVersion = 0;
+    CalibrationStatus calibration = getCalibrationStatus();
+    if (calibration.version != lastCalibrationVersion) {
+        lastCalibrationVersion = calibration.version;
+        sendCalibrationStatusToClients();
+    }
+
+    processConfigSave();
+
     // 更新LED和蜂鸣器状态
-    updateLedStatus(currentState, wifiState);
-    controlBuzzer(currentState);
+    {
+        PERF_SCOPE(PERF_LED_UPDATE);
+        updateLedStatus(snapshot, wifiState);
+    }
+    controlBuzzer(snapshot, currentTime);
 
-    // 周期性地通过WebSocket广播数据
+    // 周期性地检查数据变化, 将变化的部分发布到订阅主题 (network_loop 中按各客户端的订阅间隔发送)
     if (currentTime - lastWebSocketUpdateTime >= WEBSOCKET_UPDATE_INTERVAL_MS) {
         lastWebSocketUpdateTime = currentTime;
-        // 仅在非连接/扫描/校准状态下广播，避免干扰
-        if ((wifiState.connectProgress == WIFI_CP_IDLE || wifiState.connectProgress == WIFI_CP_FAILED) && !wifiState.isScanning && currentState.calibrationState == CAL_IDLE) {
-            sendSensorDataToClients(currentState);
-            sendWifiStatusToClients(wifiState);
+        // 仅在非连接/扫描状态下广播，避免干扰 (校准期间照常广播实时数据)
+        if ((wifiState.connectProgress == WIFI_CP_IDLE || wifiState.connectProgress == WIFI_CP_FAILED) && !wifiState.isScanning) {
+            PERF_SCOPE(PERF_WS_BROADCAST);
+            sendSensorDataChanges(snapshot);
+            sendWifiStatusChanges(wifiState);
         }
     }
 
-    // 周期性地将历史数据保存到闪存
-    if (currentTime - lastHistoricalDataSaveTime >= HISTORICAL_DATA_SAVE_INTERVAL_MS) {
-        lastHistoricalDataSaveTime = currentTime;
-        // 避免在校准时保存数据
-        if (currentState.calibrationState == CAL_IDLE) {
-            saveHistoricalDataToFile(historicalData);
-        }
+    processHealthSampling();
+
+#if PERF_STATS_ENABLED && PERF_REPORT_INTERVAL_MS > 0
+    static unsigned long lastPerfReportTime = 0;
+    if (currentTime - lastPerfReportTime >= PERF_REPORT_INTERVAL_MS) {
+        lastPerfReportTime = currentTime;
+        perfDumpToSerial();
     }
+#endif
 }
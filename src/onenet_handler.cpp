@@ -1,6 +1,8 @@
 #include "onenet_handler.h"
 #include "config.h"
-#include "data_manager.h" // 引入data_manager来访问全局的currentState
+#include "data_manager.h"
+#include "sensor_handler.h" // 读取采样任务发布的传感器快照
+#include "health_monitor.h"
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
@@ -19,6 +21,8 @@ static unsigned long lastPostTime = 0;
 
 // 上报周期 (60秒)
 const unsigned long POST_INTERVAL_MS = 60000;
+// MQTT任务堆栈大小 (Bytes)
+const uint32_t ONENET_TASK_STACK_SIZE = 8192;
 
 // ==========================================================================
 // == 内部函数声明 ==
@@ -36,8 +40,9 @@ void postProperties();
  */
 void initOneNetMqttTask() {
     xTaskCreatePinnedToCore(
-        oneNetMqttTask, "OneNetMqttTask", 8192, NULL, 1, &oneNetTaskHandle, 1
+        oneNetMqttTask, "OneNetMqttTask", ONENET_TASK_STACK_SIZE, NULL, 1, &oneNetTaskHandle, 1
     );
+    healthRegisterTask(oneNetTaskHandle, "OneNetMqttTask", ONENET_TASK_STACK_SIZE);
     P_PRINTLN("[OneNET] MQTT处理任务已创建并启动.");
 }
 
@@ -144,8 +149,11 @@ void connectToOneNet() {
  * @brief 格式化并上报传感器属性到OneNET平台。
  */
 void postProperties() {
+    DeviceState state;
+    getDeviceStateSnapshot(state);
+
     // 如果传感器还未准备好，则跳过本次上报
-    if (currentState.tempStatus == SS_INIT || currentState.tempStatus == SS_DISCONNECTED) {
+    if (state.tempStatus == SS_INIT || state.tempStatus == SS_DISCONNECTED) {
         P_PRINTLN("[OneNET] 传感器数据未就绪，跳过本次上报。");
         return;
     }
@@ -161,28 +169,28 @@ void postProperties() {
     
     // 1. 温度 (temp_value) -> int64
     JsonObject temp_value_obj = params.createNestedObject("temp_value");
-    temp_value_obj["value"] = currentState.temperature;
+    temp_value_obj["value"] = state.temperature;
 
     // 2. 湿度 (humidity_value) -> int64
     JsonObject humidity_value_obj = params.createNestedObject("humidity_value");
-    humidity_value_obj["value"] = (int)currentState.humidity;
+    humidity_value_obj["value"] = (int)state.humidity;
 
     // 3. 气体浓度 (CO, NO2, C2H5OH, VOC) -> float
-    if (!isnan(currentState.gasPpmValues.co)) {
+    if (!isnan(state.gasPpmValues.co)) {
         JsonObject co_ppm_obj = params.createNestedObject("CO_ppm");
-        co_ppm_obj["value"] = round(currentState.gasPpmValues.co * 100) / 100.0;
+        co_ppm_obj["value"] = round(state.gasPpmValues.co * 100) / 100.0;
     }
-    if (!isnan(currentState.gasPpmValues.no2)) {
+    if (!isnan(state.gasPpmValues.no2)) {
         JsonObject no2_ppm_obj = params.createNestedObject("NO2_ppm");
-        no2_ppm_obj["value"] = round(currentState.gasPpmValues.no2 * 100) / 100.0;
+        no2_ppm_obj["value"] = round(state.gasPpmValues.no2 * 100) / 100.0;
     }
-    if (!isnan(currentState.gasPpmValues.c2h5oh)) {
+    if (!isnan(state.gasPpmValues.c2h5oh)) {
         JsonObject c2h5oh_ppm_obj = params.createNestedObject("C2H5OH_ppm");
-        c2h5oh_ppm_obj["value"] = round(currentState.gasPpmValues.c2h5oh * 10) / 10.0;
+        c2h5oh_ppm_obj["value"] = round(state.gasPpmValues.c2h5oh * 10) / 10.0;
     }
-    if (!isnan(currentState.gasPpmValues.voc)) {
+    if (!isnan(state.gasPpmValues.voc)) {
         JsonObject voc_ppm_obj = params.createNestedObject("VOC_ppm");
-        voc_ppm_obj["value"] = round(currentState.gasPpmValues.voc * 100) / 100.0;
+        voc_ppm_obj["value"] = round(state.gasPpmValues.voc * 100) / 100.0;
     }
     
     String postData;
@@ -0,0 +1,68 @@
+#include "perf_stats.h"
+
+#if PERF_STATS_ENABLED
+
+static PerfStageStats stageStats[PERF_STAGE_COUNT];
+static uint32_t cyclesPerUs = 0;
+
+static const char* const STAGE_NAMES[PERF_STAGE_COUNT] = {
+    "loopTotal", "networkLoop", "historyAppend", "ledUpdate",
+    "wsBroadcast", "readSensors", "checkAlarms", "storageJob"
+};
+
+static uint8_t bucketIndex(uint32_t us) {
+    if (us == 0) return 0;
+    uint8_t index = 32 - __builtin_clz(us); // us 的二进制位数
+    return index < PERF_BUCKET_COUNT ? index : PERF_BUCKET_COUNT - 1;
+}
+
+void perfRecordCycles(PerfStage stage, uint32_t cycles) {
+    if (cyclesPerUs == 0) cyclesPerUs = ESP.getCpuFreqMHz();
+    const uint32_t us = cycles / cyclesPerUs;
+    PerfStageStats& s = stageStats[stage];
+    s.count++;
+    s.totalUs += us;
+    if (us > s.maxUs) s.maxUs = us;
+    s.buckets[bucketIndex(us)]++;
+}
+
+const char* perfStageName(PerfStage stage) {
+    return stage < PERF_STAGE_COUNT ? STAGE_NAMES[stage] : "unknown";
+}
+
+void perfGetStage(PerfStage stage, PerfStageStats& out) {
+    memcpy(&out, &stageStats[stage], sizeof(out));
+}
+
+uint32_t perfPercentileUs(const PerfStageStats& stats, float q) {
+    if (stats.count == 0) return 0;
+    const uint32_t rank = (uint32_t)ceilf(q * stats.count);
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PERF_BUCKET_COUNT; i++) {
+        seen += stats.buckets[i];
+        if (seen >= rank) {
+            const uint32_t upper = (i == 0) ? 1 : (1UL << i);
+            return upper < stats.maxUs ? upper : stats.maxUs;
+        }
+    }
+    return stats.maxUs;
+}
+
+void perfReset() {
+    memset(stageStats, 0, sizeof(stageStats));
+}
+
+void perfDumpToSerial() {
+    P_PRINTLN("[PERF] 阶段            次数   平均us   P50us   P99us   最大us");
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        PerfStageStats s;
+        perfGetStage((PerfStage)i, s);
+        if (s.count == 0) continue;
+        P_PRINTF("[PERF] %-14s %7lu %8lu %7lu %7lu %8lu\n", STAGE_NAMES[i],
+                 (unsigned long)s.count, (unsigned long)(s.totalUs / s.count),
+                 (unsigned long)perfPercentileUs(s, 0.5f), (unsigned long)perfPercentileUs(s, 0.99f),
+                 (unsigned long)s.maxUs);
+    }
+}
+
+#endif // PERF_STATS_ENABLED
@@ -0,0 +1,68 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ==========================================================================
+// == 分阶段耗时统计 ==
+// == 用 CPU 周期计数器测量各阶段耗时, 计入每个阶段固定的 log2 直方图:
+// == 桶 0 为 <1us, 桶 i (i>=1) 为 [2^(i-1), 2^i) us, 最后一个桶收纳更长的耗时.
+// == 记录路径只有整数运算, 不分配内存. 周期计数器按核心独立, 每个阶段只能在
+// == 固定核心的同一个任务中计时. 读取不加锁, 与记录并发时个别计数可能相差一次.
+// == PERF_STATS_ENABLED 为 0 时 PERF_SCOPE() 展开为空, 不产生任何代码.
+// ==========================================================================
+
+enum PerfStage {
+    PERF_LOOP_TOTAL,        // loop() 一次迭代
+    PERF_NETWORK_LOOP,      // network_loop()
+    PERF_HISTORY_APPEND,    // 新样本写入历史缓冲区并提交日志作业
+    PERF_LED_UPDATE,        // updateLedStatus()
+    PERF_WS_BROADCAST,      // 实时数据变化广播
+    PERF_READ_SENSORS,      // readSensors() (采样任务)
+    PERF_CHECK_ALARMS,      // checkAlarms() (采样任务)
+    PERF_STORAGE_JOB,       // 单个 flash 写入作业 (存储任务)
+    PERF_STAGE_COUNT
+};
+
+#define PERF_BUCKET_COUNT 24    // 最后一个桶: >= 2^22 us (约4.2秒)
+
+struct PerfStageStats {
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t buckets[PERF_BUCKET_COUNT];
+};
+
+#if PERF_STATS_ENABLED
+
+void perfRecordCycles(PerfStage stage, uint32_t cycles);
+
+// 作用域计时: 构造时取周期计数, 析构时记录
+class PerfScope {
+public:
+    explicit PerfScope(PerfStage s) : stage(s), start(ESP.getCycleCount()) {}
+    ~PerfScope() { perfRecordCycles(stage, ESP.getCycleCount() - start); }
+private:
+    PerfStage stage;
+    uint32_t start;
+};
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_SCOPE(stage) PerfScope PERF_CONCAT(perfScope_, __LINE__)(stage)
+
+const char* perfStageName(PerfStage stage);
+void perfGetStage(PerfStage stage, PerfStageStats& out);
+// 由直方图估算分位数 (返回所在桶的上界, 不超过最大值)
+uint32_t perfPercentileUs(const PerfStageStats& stats, float q);
+void perfReset();
+void perfDumpToSerial();
+
+#else
+
+#define PERF_SCOPE(stage) do {} while (0)
+
+#endif // PERF_STATS_ENABLED
+
+#endif // PERF_STATS_H
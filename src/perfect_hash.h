@@ -0,0 +1,98 @@
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ==========================================================================
+// == 编译期完美哈希 (按名称查表) ==
+// == 表项类型只需有 const char* name 成员, 表本身为 constexpr 数组.
+// == 编译期依次尝试种子, 找到使所有名称落入不同槽位的种子, 并生成 槽位 -> 表项下标.
+// == 运行时查找: 一次 FNV-1a 哈希 + 一次槽位读取 + 一次 strcmp 确认, 不分配内存.
+// == 槽位数为不小于 2 x 表项数的2的幂. 表项不超过 254 个.
+// ==========================================================================
+
+namespace phash {
+
+const uint8_t EMPTY_SLOT = 0xFF;
+const uint32_t NO_SEED = 0xFFFFFFFFu;
+const uint32_t MAX_SEED_TRIES = 256;
+
+// FNV-1a, 种子作为初始值. 编译期和运行时共用同一实现 (尾递归, 优化后为循环)
+constexpr uint32_t hash(const char* s, uint32_t h) {
+    return *s ? hash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+constexpr uint32_t seedBasis(uint32_t seed) {
+    return 2166136261u ^ (seed * 0x9E3779B9u);
+}
+
+constexpr uint32_t fold(uint32_t h, uint32_t mask) {
+    return (h ^ (h >> 16)) & mask;
+}
+
+constexpr uint32_t slotOf(const char* s, uint32_t seed, uint32_t mask) {
+    return fold(hash(s, seedBasis(seed)), mask);
+}
+
+constexpr size_t tableSize(size_t n, size_t size = 1) {
+    return size >= 2 * n ? size : tableSize(n, size * 2);
+}
+
+// -- 编译期种子搜索 --
+
+template <typename T, size_t N>
+constexpr bool collidesWithLater(const T (&table)[N], uint32_t seed, uint32_t mask, size_t i, size_t j) {
+    return j >= N ? false
+         : (slotOf(table[i].name, seed, mask) == slotOf(table[j].name, seed, mask) || collidesWithLater(table, seed, mask, i, j + 1));
+}
+
+template <typename T, size_t N>
+constexpr bool isPerfect(const T (&table)[N], uint32_t seed, uint32_t mask, size_t i = 0) {
+    return i >= N ? true : (!collidesWithLater(table, seed, mask, i, i + 1) && isPerfect(table, seed, mask, i + 1));
+}
+
+template <typename T, size_t N>
+constexpr uint32_t findSeed(const T (&table)[N], uint32_t mask, uint32_t seed = 0) {
+    return seed >= MAX_SEED_TRIES ? NO_SEED : (isPerfect(table, seed, mask) ? seed : findSeed(table, mask, seed + 1));
+}
+
+template <typename T, size_t N>
+constexpr uint8_t slotOwner(const T (&table)[N], uint32_t seed, uint32_t mask, uint32_t slot, size_t i = 0) {
+    return i >= N ? EMPTY_SLOT : (slotOf(table[i].name, seed, mask) == slot ? (uint8_t)i : slotOwner(table, seed, mask, slot, i + 1));
+}
+
+// -- 槽位表生成 (C++11 下用下标序列展开) --
+
+template <size_t... I> struct IndexSeq {};
+template <size_t N, size_t... I> struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeIndexSeq<0, I...> { typedef IndexSeq<I...> type; };
+
+template <size_t SLOTS>
+struct SlotTable {
+    uint32_t seed;
+    uint8_t owner[SLOTS];
+};
+
+template <size_t SLOTS, typename T, size_t N, size_t... I>
+constexpr SlotTable<SLOTS> buildSlots(const T (&table)[N], uint32_t seed, IndexSeq<I...>) {
+    return SlotTable<SLOTS>{ seed, { slotOwner(table, seed, SLOTS - 1, I)... } };
+}
+
+template <size_t SLOTS, typename T, size_t N>
+constexpr SlotTable<SLOTS> build(const T (&table)[N]) {
+    return buildSlots<SLOTS>(table, findSeed(table, SLOTS - 1), typename MakeIndexSeq<SLOTS>::type());
+}
+
+// -- 运行时查找, 名称不在表中时返回 NULL --
+
+template <typename T, size_t N, size_t SLOTS>
+const T* lookup(const T (&table)[N], const SlotTable<SLOTS>& slots, const char* name) {
+    const uint8_t i = slots.owner[slotOf(name, slots.seed, SLOTS - 1)];
+    return (i < N && strcmp(table[i].name, name) == 0) ? &table[i] : NULL;
+}
+
+} // namespace phash
+
+#endif // PERFECT_HASH_H
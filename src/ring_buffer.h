@@ -0,0 +1,140 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// ==========================================================================
+// == 定长环形缓冲区模板 ==
+// == 容量为编译期的2的幂, 用掩码代替取模; head/tail 为自由递增的计数器,
+// == 元素个数 = head - tail (32位回绕时依然成立).
+// ==========================================================================
+
+// 环形缓冲区工作模式
+enum RingMode {
+    RING_OVERWRITE,   // 单线程使用, 写满后覆盖最旧元素 (历史数据)
+    RING_SPSC         // 单生产者/单消费者无锁队列, 写满时 push 返回 false
+};
+
+// 按时间顺序 (从旧到新) 遍历环形缓冲区内容的零拷贝视图, 最多由两段连续内存组成
+template <typename T>
+struct RingView {
+    const T* first;
+    size_t firstLen;
+    const T* second;
+    size_t secondLen;
+
+    // 按位置 (0 为最旧) 迭代, 以位置判断相等: 写满且起点不在缓冲区开头时, 第二段的末尾
+    // 与第一段的开头是同一地址, 不能用指针比较
+    class Iterator {
+    public:
+        Iterator(const T* first, size_t firstLen, const T* second, size_t index) :
+            first(first), firstLen(firstLen), second(second), index(index) {}
+        const T& operator*() const { return index < firstLen ? first[index] : second[index - firstLen]; }
+        const T* operator->() const { return &**this; }
+        Iterator& operator++() {
+            ++index;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+    private:
+        const T* first;
+        size_t firstLen;
+        const T* second;
+        size_t index;
+    };
+
+    size_t size() const { return firstLen + secondLen; }
+    bool empty() const { return firstLen + secondLen == 0; }
+    const T& operator[](size_t index) const {
+        return index < firstLen ? first[index] : second[index - firstLen];
+    }
+    Iterator begin() const { return Iterator(first, firstLen, second, 0); }
+    Iterator end() const { return Iterator(first, firstLen, second, size()); }
+};
+
+template <typename T, size_t N, RingMode Mode = RING_OVERWRITE>
+class Ring {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+
+public:
+    typedef RingView<T> View;
+
+    Ring() : head(0), tail(0) {}
+
+    // 生产者: 写入一个元素. 覆盖模式下总是成功; SPSC模式下队列已满时返回 false.
+    bool push(const T& item) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (Mode == RING_SPSC) {
+            if (h - tail.load(std::memory_order_acquire) >= N) return false;
+            buffer[h & MASK] = item;
+            head.store(h + 1, std::memory_order_release);
+        } else {
+            buffer[h & MASK] = item;
+            head.store(h + 1, std::memory_order_relaxed);
+            if (h + 1 - tail.load(std::memory_order_relaxed) > N) {
+                tail.store(h + 1 - N, std::memory_order_relaxed);
+            }
+        }
+        return true;
+    }
+
+    // 消费者: 取出最旧的元素, 为空时返回 false
+    bool pop(T& item) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = buffer[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者: 丢弃最旧的 n 个元素 (通常在处理完 view() 之后调用)
+    void consume(size_t n) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const uint32_t available = head.load(std::memory_order_acquire) - t;
+        tail.store(t + (n < available ? n : available), std::memory_order_release);
+    }
+
+    // 消费者: 当前全部元素的零拷贝视图. SPSC模式下生产者可同时继续 push;
+    // 覆盖模式下视图在下一次 push 之前有效.
+    View view() const {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const size_t n = head.load(std::memory_order_acquire) - t;
+        const size_t start = t & MASK;
+        const size_t firstLen = (n < N - start) ? n : N - start;
+        View v = { buffer + start, firstLen, buffer, n - firstLen };
+        return v;
+    }
+
+    // 按时间顺序访问, 0 为最旧的元素
+    const T& operator[](size_t index) const {
+        return buffer[(tail.load(std::memory_order_relaxed) + index) & MASK];
+    }
+    const T& newest() const {
+        return buffer[(head.load(std::memory_order_relaxed) - 1) & MASK];
+    }
+
+    size_t count() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool isEmpty() const { return count() == 0; }
+    bool isFull() const { return count() >= N; }
+    static size_t capacity() { return N; }
+
+    // 仅在没有并发生产者/消费者时调用
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static const uint32_t MASK = N - 1;
+
+    T buffer[N];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,93 @@
+#include "sensor_frame.h"
+
+// ==========================================================================
+// == 小端序写入辅助函数 ==
+// ==========================================================================
+
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+static void putF32(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    putU32(p, bits);
+}
+
+// 断开或尚未得到第一次读数时, 状态结构中的数值没有意义 (温度是 int, 不能用 NaN 表示无效)
+static bool readingValid(SensorStatusVal status) {
+    return status != SS_DISCONNECTED && status != SS_INIT;
+}
+
+static uint8_t packStatus(SensorStatusVal low, SensorStatusVal high) {
+    return (uint8_t)((low & 0x0F) | ((high & 0x0F) << 4));
+}
+
+// ==========================================================================
+// == 帧编码 ==
+// ==========================================================================
+
+size_t encodeSensorFrame(const DeviceState& state, bool timeIsRelative, uint32_t timestamp,
+                         uint32_t labelSeconds, uint8_t* out) {
+    uint8_t flags = 0;
+    if (timeIsRelative) flags |= SENSOR_FRAME_FLAG_TIME_RELATIVE;
+    if (readingValid(state.tempStatus)) flags |= SENSOR_FRAME_FLAG_TEMP_VALID;
+    if (readingValid(state.humStatus)) flags |= SENSOR_FRAME_FLAG_HUM_VALID;
+
+    out[0] = SENSOR_FRAME_MAGIC;
+    out[1] = SENSOR_FRAME_VERSION;
+    out[2] = SENSOR_FRAME_TYPE_DATA;
+    out[3] = flags;
+    putU32(out + 4, timestamp);
+    putU32(out + 8, labelSeconds);
+    putU16(out + 12, !(flags & SENSOR_FRAME_FLAG_TEMP_VALID) ? 0 : (uint16_t)(int16_t)constrain(state.temperature, -32768, 32767));
+    putU16(out + 14, !(flags & SENSOR_FRAME_FLAG_HUM_VALID) || isnan(state.humidity) ? 0 : (uint16_t)constrain(lroundf(state.humidity * 100.0f), 0L, 65535L));
+    putF32(out + 16, state.gasPpmValues.co);
+    putF32(out + 20, state.gasPpmValues.no2);
+    putF32(out + 24, state.gasPpmValues.c2h5oh);
+    putF32(out + 28, state.gasPpmValues.voc);
+    out[32] = packStatus(state.tempStatus, state.humStatus);
+    out[33] = packStatus(state.gasCoStatus, state.gasNo2Status);
+    out[34] = packStatus(state.gasC2h5ohStatus, state.gasVocStatus);
+    out[35] = 0;
+    return SENSOR_FRAME_SIZE;
+}
+
+// ==========================================================================
+// == JSON 格式 ==
+// ==========================================================================
+
+void buildSensorDataJson(const DeviceState& state, uint8_t fields, bool timeIsRelative, const char* timeStr, JsonDocument& doc) {
+    doc["type"] = "sensorData";
+    if (fields != LF_ALL) doc["delta"] = true;
+
+    if (fields & LF_TEMP) { if (isnan(state.temperature)) doc["temperature"] = nullptr; else doc["temperature"] = state.temperature; }
+    if (fields & LF_HUM) { if (isnan(state.humidity)) doc["humidity"] = nullptr; else doc["humidity"] = state.humidity; }
+    
+    if (fields & (LF_CO | LF_NO2 | LF_C2H5OH | LF_VOC)) {
+        JsonObject gas = doc.createNestedObject("gasPpm");
+        if (fields & LF_CO) { if (isnan(state.gasPpmValues.co)) gas["co"] = nullptr; else gas["co"] = state.gasPpmValues.co; }
+        if (fields & LF_NO2) { if (isnan(state.gasPpmValues.no2)) gas["no2"] = nullptr; else gas["no2"] = state.gasPpmValues.no2; }
+        if (fields & LF_C2H5OH) { if (isnan(state.gasPpmValues.c2h5oh)) gas["c2h5oh"] = nullptr; else gas["c2h5oh"] = state.gasPpmValues.c2h5oh; }
+        if (fields & LF_VOC) { if (isnan(state.gasPpmValues.voc)) gas["voc"] = nullptr; else gas["voc"] = state.gasPpmValues.voc; }
+    }
+
+    if (fields & LF_STATUS) {
+        doc["tempStatus"] = getSensorStatusString(state.tempStatus);
+        doc["humStatus"]  = getSensorStatusString(state.humStatus);
+        doc["gasCoStatus"] = getSensorStatusString(state.gasCoStatus);
+        doc["gasNo2Status"] = getSensorStatusString(state.gasNo2Status);
+        doc["gasC2h5ohStatus"] = getSensorStatusString(state.gasC2h5ohStatus);
+        doc["gasVocStatus"] = getSensorStatusString(state.gasVocStatus);
+    }
+    doc["timeIsRelative"] = timeIsRelative;
+    doc["timeStr"] = timeStr; // 按指针保存, 调用方的缓冲区在发送完成前保持有效
+}
@@ -0,0 +1,56 @@
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include <Arduino.h>
+#include "data_manager.h"
+
+// ==========================================================================
+// == 实时数据二进制帧 (WebSocket 二进制协议) ==
+// == 定长, 小端序. 客户端连接后发送 {"action":"setProtocol","binary":true,"version":1}
+// == 协商启用, 未协商的客户端继续接收 JSON 格式的 sensorData.
+// ==
+// == 偏移 大小 字段
+// ==  0   u8   魔数 SENSOR_FRAME_MAGIC
+// ==  1   u8   协议版本 SENSOR_FRAME_VERSION
+// ==  2   u8   帧类型 (SENSOR_FRAME_TYPE_DATA)
+// ==  3   u8   标志位 (SENSOR_FRAME_FLAG_*)
+// ==  4   u32  时间戳: 绝对时间为 Unix 秒, 相对时间为运行毫秒数
+// ==  8   u32  时间标签秒数: 绝对时间为本地时区当天秒数, 相对时间为运行秒数
+// == 12   i16  温度 (°C)
+// == 14   u16  湿度 x100 (%)
+// == 16   f32  CO, NO2, C2H5OH, VOC (PPM, NaN 表示无数据)
+// == 32   u8   状态: 温度 | 湿度 << 4
+// == 33   u8   状态: CO | NO2 << 4
+// == 34   u8   状态: C2H5OH | VOC << 4   (4位状态值即 SensorStatusVal)
+// == 35   u8   保留
+// ==========================================================================
+
+#define SENSOR_FRAME_MAGIC 0x53          // 'S'
+#define SENSOR_FRAME_VERSION 1
+#define SENSOR_FRAME_TYPE_DATA 0x01
+#define SENSOR_FRAME_SIZE 36
+
+#define SENSOR_FRAME_FLAG_TIME_RELATIVE 0x01
+// 温湿度有效标志由 tempStatus / humStatus 决定 (不是断开或初始状态); 无效时对应字段为 0
+#define SENSOR_FRAME_FLAG_TEMP_VALID    0x02
+#define SENSOR_FRAME_FLAG_HUM_VALID     0x04
+
+// 将当前状态编码为二进制帧, 返回写入的字节数 (SENSOR_FRAME_SIZE)
+size_t encodeSensorFrame(const DeviceState& state, bool timeIsRelative, uint32_t timestamp,
+                         uint32_t labelSeconds, uint8_t* out);
+
+// ==========================================================================
+// == 实时数据 JSON (type: "sensorData", 未协商二进制协议的客户端) ==
+// ==========================================================================
+
+// 实时数据字段变化位, JSON 增量消息只包含置位的字段
+enum LiveField {
+    LF_TEMP = 0x01, LF_HUM = 0x02, LF_CO = 0x04, LF_NO2 = 0x08, LF_C2H5OH = 0x10, LF_VOC = 0x20,
+    LF_STATUS = 0x40,
+    LF_ALL = 0x7F
+};
+
+// fields 不是 LF_ALL 时为增量消息. timeStr 按指针保存, 调用方的缓冲区在序列化完成前须保持有效
+void buildSensorDataJson(const DeviceState& state, uint8_t fields, bool timeIsRelative, const char* timeStr, JsonDocument& doc);
+
+#endif // SENSOR_FRAME_H
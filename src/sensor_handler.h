@@ -2,6 +2,8 @@
 #define SENSOR_HANDLER_H
 
 #include "data_manager.h"
+#include "gas_sensor.h"
+#include "sensor_pipeline.h"
 #include <Adafruit_NeoPixel.h>
 
 // ==========================================================================
@@ -10,19 +12,14 @@
 
 // -- 硬件初始化与控制 --
 void initHardware();
-bool isGasSensorConnected();
 void updateLedBrightness(uint8_t brightness_percent);
 void updateLedStatus(const DeviceState& state, const WifiState& wifiStatus);
-void controlBuzzer(DeviceState& state);
 
-// -- 传感器数据处理与计算 --
-void readSensors(DeviceState& state, const DeviceConfig& config);
-void calculatePpm(DeviceState& state, const DeviceConfig& config);
-void checkAlarms(DeviceState& state, const DeviceConfig& config);
+// -- 采样任务 --
+void startSensorTask();                              // 创建固定周期的采样任务 (读数 + 警报检查)
+uint32_t getDeviceStateSnapshot(DeviceState& out);   // 复制最近一次发布的一致快照, 返回采样序号 (0 表示尚无样本)
 
-// -- 新增: 传感器校准 --
-void startCalibration();
-void calibrationTask(void *pvParameters);
+// 读数处理、警报、蜂鸣器、运行参数和校准见 sensor_pipeline.h
 
 
 #endif // SENSOR_HANDLER_H
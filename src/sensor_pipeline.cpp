@@ -0,0 +1,508 @@
+#include "sensor_pipeline.h"
+#include "config.h"
+#include "dsp_filter.h"
+#include "perf_stats.h"
+#include "gas_ppm.h"
+#include <atomic>
+
+// ==========================================================================
+// == 模块内部使用的全局对象和变量 ==
+// ==========================================================================
+
+// 当前数据源, 默认为硬件数据源 (定义在 sensor_handler.cpp)
+static std::atomic<const SensorSource*> sensorSource(&HARDWARE_SENSOR_SOURCE);
+
+// 气体通道过采样滤波 (中值去尖峰 + EMA), 每个上报周期取一次结果
+static DecimatingFilter<GAS_CHANNEL_COUNT, GAS_MEDIAN_WINDOW, GAS_EMA_SHIFT> gasFilter;
+
+// 阈值和 R0. loop 任务 (配置) 和采样任务 (校准/基线跟踪) 都会写入, 在临界区内整体读写
+static SensorParams sensorParams;
+static portMUX_TYPE sensorParamsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// R0 每次被采样任务修改 (校准完成/基线调整) 时递增, loop 任务据此保存配置
+static std::atomic<uint32_t> r0Revision(0);
+
+// 校准状态, 在临界区内整体读写
+static CalibrationStatus calibrationStatus;
+static portMUX_TYPE calibrationMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 蜂鸣器节奏 (仅在 loop 任务中使用)
+static unsigned long buzzerStopTime = 0;
+static int buzzerBeepCount = 0;
+static bool buzzerWasActive = false;
+
+// ==========================================================================
+// == 内部函数声明 ==
+// ==========================================================================
+static void storeR0(const GasResistData& r0, const GasResistData& r0Calibrated);
+static bool replaceR0IfUnchanged(const SensorParams& expected, const GasResistData& r0);
+static void updateCalibrationStatus(CalibrationState state, int progress, const GasResistData* measuredR0);
+static void accumulateCalibrationSample(const GasRawReading& raw, unsigned long nowMs);
+static void updateCalibration(unsigned long now);
+static void resetBaselineTracking();
+static void trackBaseline(const DeviceState& state, const SensorParams& params, unsigned long nowMs);
+
+// ==========================================================================
+// == 数据源 ==
+// ==========================================================================
+
+void setSensorSource(const SensorSource* source) {
+    sensorSource.store(source ? source : &HARDWARE_SENSOR_SOURCE);
+    P_PRINTF("[SENSOR] 数据源切换为: %s\n", getSensorSource().name);
+}
+
+const SensorSource& getSensorSource() {
+    return *sensorSource.load();
+}
+
+// ==========================================================================
+// == 采样周期 ==
+// ==========================================================================
+
+void resetSensorPipeline() {
+    gasFilter.reset();
+    resetBaselineTracking();
+    buzzerStopTime = 0;
+    buzzerBeepCount = 0;
+    buzzerWasActive = false;
+}
+
+// 四个通道一次突发读取并送入滤波器 (校准进行中时同时计入校准统计);
+// 读取失败或传感器离线时只丢弃这一个样本, 本周期已有的样本照常输出
+void sampleGasSensor(unsigned long nowMs) {
+    GasRawReading raw;
+    if (getSensorSource().readGas(raw) != GAS_READ_OK) return;
+    int32_t sample[GAS_CHANNEL_COUNT] = { (int32_t)raw.co, (int32_t)raw.no2, (int32_t)raw.c2h5oh, (int32_t)raw.voc };
+    gasFilter.push(sample);
+    accumulateCalibrationSample(raw, nowMs);
+}
+
+void processSensorReport(DeviceState& state, unsigned long nowMs) {
+    updateCalibration(nowMs); // 校准完成时新 R0 在本次读数前生效
+    const SensorParams params = getSensorParams();
+    {
+        PERF_SCOPE(PERF_READ_SENSORS);
+        readSensors(state, params, nowMs);
+    }
+    {
+        PERF_SCOPE(PERF_CHECK_ALARMS);
+        checkAlarms(state, params);
+    }
+    trackBaseline(state, params, nowMs);
+}
+
+void readSensors(DeviceState& state, const SensorParams& params, unsigned long nowMs) {
+    // 取回上一周期在后台完成的DHT传输, 然后立即开始下一次 (读数滞后一个采样周期)
+    const SensorSource& source = getSensorSource();
+    DhtReading dhtReading;
+    DhtRmtResult dhtResult = source.fetchDht(dhtReading);
+    if (dhtResult == DHT_RMT_FAILED) {
+        state.tempStatus = SS_DISCONNECTED;
+        state.humStatus = SS_DISCONNECTED;
+    } else if (dhtResult == DHT_RMT_OK) {
+        // 【修改】: 将温度四舍五入为整数，湿度保持float（将在onenet_handler中转换为int）
+        state.temperature = round(dhtReading.temperature);
+        state.humidity = dhtReading.humidity;
+        if(state.tempStatus == SS_INIT || state.tempStatus == SS_DISCONNECTED) state.tempStatus = SS_NORMAL;
+        if(state.humStatus == SS_INIT || state.humStatus == SS_DISCONNECTED) state.humStatus = SS_NORMAL;
+    }
+    source.startDht();
+
+    // 取出本上报周期内过采样滤波后的气体读数. 通道状态跟随采集层的实际读取结果:
+    // 整个周期没有一次成功读取 (读取失败或离线退避中) 视为断开, 并丢弃滤波状态,
+    // 采集层重新探测成功后的第一个周期即以新样本为初值恢复为正常
+    int32_t filtered[GAS_CHANNEL_COUNT];
+    if (gasFilter.take(filtered) == 0) {
+        gasFilter.reset();
+        state.gasCoStatus = state.gasNo2Status = state.gasC2h5ohStatus = state.gasVocStatus = SS_DISCONNECTED;
+        state.gasRsValues = {NAN, NAN, NAN, NAN};
+        return;
+    }
+
+    GasRawReading gasRaw = {
+        (uint32_t)filtered[GAS_CH_CO], (uint32_t)filtered[GAS_CH_NO2],
+        (uint32_t)filtered[GAS_CH_C2H5OH], (uint32_t)filtered[GAS_CH_VOC]
+    };
+
+    bool isGasSensorPhysicallyWarmingUp = (nowMs < gasSensorWarmupEndTime);
+    if (isGasSensorPhysicallyWarmingUp) {
+        state.gasCoStatus = state.gasNo2Status = state.gasC2h5ohStatus = state.gasVocStatus = SS_INIT;
+        state.gasPpmValues = {NAN, NAN, NAN, NAN};
+        state.gasRsValues = {NAN, NAN, NAN, NAN};
+    } else {
+        state.gasRsValues.co = adcToRs(gasRaw.co);
+        state.gasRsValues.no2 = adcToRs(gasRaw.no2);
+        state.gasRsValues.c2h5oh = adcToRs(gasRaw.c2h5oh);
+        state.gasRsValues.voc = adcToRs(gasRaw.voc);
+
+        calculatePpm(state, gasRaw, params);
+
+        // 与温湿度相同: 预热结束或断开后重新读到有效 Rs 时恢复为正常
+        if((state.gasCoStatus == SS_INIT || state.gasCoStatus == SS_DISCONNECTED) && state.gasRsValues.co >= 0) state.gasCoStatus = SS_NORMAL;
+        if((state.gasNo2Status == SS_INIT || state.gasNo2Status == SS_DISCONNECTED) && state.gasRsValues.no2 >= 0) state.gasNo2Status = SS_NORMAL;
+        if((state.gasC2h5ohStatus == SS_INIT || state.gasC2h5ohStatus == SS_DISCONNECTED) && state.gasRsValues.c2h5oh >= 0) state.gasC2h5ohStatus = SS_NORMAL;
+        if((state.gasVocStatus == SS_INIT || state.gasVocStatus == SS_DISCONNECTED) && state.gasRsValues.voc >= 0) state.gasVocStatus = SS_NORMAL;
+        
+        if(state.gasRsValues.co < 0) state.gasCoStatus = SS_DISCONNECTED;
+        if(state.gasRsValues.no2 < 0) state.gasNo2Status = SS_DISCONNECTED;
+        if(state.gasRsValues.c2h5oh < 0) state.gasC2h5ohStatus = SS_DISCONNECTED;
+        if(state.gasRsValues.voc < 0) state.gasVocStatus = SS_DISCONNECTED;
+    }
+}
+
+// ==========================================================================
+// == ADC -> PPM 查找表 ==
+// == Rs 只取决于12位ADC读数, 因此每个通道预先算好4096个PPM值 (曲线见 gas_ppm.h),
+// == 换算时只需一次查表. R0 变化 (校准) 后自动重建.
+// ==========================================================================
+
+static_assert(GAS_PPM_CHANNELS == GAS_CHANNEL_COUNT, "gas_ppm channel order must match GasChannel");
+
+static float ppmTable[GAS_CHANNEL_COUNT][GAS_PPM_TABLE_SIZE];
+static GasResistData ppmTableR0;
+static bool ppmTableBuilt = false;
+
+// 按字节比较 R0, 避免 NaN 导致每次都重建
+static void rebuildPpmTablesIfNeeded(const GasResistData& r0) {
+    if (ppmTableBuilt && memcmp(&ppmTableR0, &r0, sizeof(r0)) == 0) return;
+    unsigned long startUs = micros();
+    gasBuildPpmTable(GAS_CH_CO, r0.co, ppmTable[GAS_CH_CO]);
+    gasBuildPpmTable(GAS_CH_NO2, r0.no2, ppmTable[GAS_CH_NO2]);
+    gasBuildPpmTable(GAS_CH_C2H5OH, r0.c2h5oh, ppmTable[GAS_CH_C2H5OH]);
+    gasBuildPpmTable(GAS_CH_VOC, r0.voc, ppmTable[GAS_CH_VOC]);
+    ppmTableR0 = r0;
+    ppmTableBuilt = true;
+    P_PRINTF("[SENSOR] PPM查找表已重建, 耗时 %lu us\n", micros() - startUs);
+}
+
+static float lookupPpm(GasChannel channel, uint32_t adc) {
+    return (adc < (uint32_t)GAS_PPM_TABLE_SIZE) ? ppmTable[channel][adc] : NAN;
+}
+
+void calculatePpm(DeviceState& state, const GasRawReading& raw, const SensorParams& params) {
+    rebuildPpmTablesIfNeeded(params.r0Values);
+    state.gasPpmValues.co = lookupPpm(GAS_CH_CO, raw.co);
+    state.gasPpmValues.no2 = lookupPpm(GAS_CH_NO2, raw.no2);
+    state.gasPpmValues.c2h5oh = lookupPpm(GAS_CH_C2H5OH, raw.c2h5oh);
+    state.gasPpmValues.voc = lookupPpm(GAS_CH_VOC, raw.voc);
+}
+
+void checkAlarms(DeviceState& state, const SensorParams& params) {
+    const AlarmThresholds& thresholds = params.thresholds;
+    bool anyAlarm = false;
+    if (state.tempStatus == SS_NORMAL) {
+        if (state.temperature < thresholds.tempMin || state.temperature > thresholds.tempMax) {
+            // 【修改】: 将温度报警的打印格式改回 %d
+            P_PRINTF("[ALARM] 温度超限! %d°C (范围: %d-%d)\n", state.temperature, thresholds.tempMin, thresholds.tempMax);
+            state.tempStatus = SS_WARNING;
+        }
+    } else if (state.tempStatus == SS_WARNING) {
+        if (state.temperature >= thresholds.tempMin && state.temperature <= thresholds.tempMax) {
+           state.tempStatus = SS_NORMAL;
+        }
+    }
+    if (state.humStatus == SS_NORMAL) {
+        if (state.humidity < thresholds.humMin || state.humidity > thresholds.humMax) {
+             // 【修改】: 将湿度报警的打印格式改回 %d
+            P_PRINTF("[ALARM] 湿度超限! %d%% (范围: %d-%d)\n", (int)state.humidity, thresholds.humMin, thresholds.humMax);
+            state.humStatus = SS_WARNING;
+        }
+    } else if (state.humStatus == SS_WARNING) {
+        if (state.humidity >= thresholds.humMin && state.humidity <= thresholds.humMax) {
+            state.humStatus = SS_NORMAL; 
+        }
+    }
+    if (state.gasCoStatus == SS_NORMAL && state.gasPpmValues.co > thresholds.coPpmMax) {
+        P_PRINTF("[ALARM] CO超限! %.2f PPM (阈值: >%.2f)\n", state.gasPpmValues.co, thresholds.coPpmMax);
+        state.gasCoStatus = SS_WARNING;
+    } else if (state.gasCoStatus == SS_WARNING && state.gasPpmValues.co <= thresholds.coPpmMax) {
+        state.gasCoStatus = SS_NORMAL;
+    }
+    if (state.gasNo2Status == SS_NORMAL && state.gasPpmValues.no2 > thresholds.no2PpmMax) {
+        P_PRINTF("[ALARM] NO2超限! %.2f PPM (阈值: >%.2f)\n", state.gasPpmValues.no2, thresholds.no2PpmMax);
+        state.gasNo2Status = SS_WARNING;
+    } else if (state.gasNo2Status == SS_WARNING && state.gasPpmValues.no2 <= thresholds.no2PpmMax) {
+        state.gasNo2Status = SS_NORMAL;
+    }
+    if (state.gasC2h5ohStatus == SS_NORMAL && state.gasPpmValues.c2h5oh > thresholds.c2h5ohPpmMax) {
+        P_PRINTF("[ALARM] C2H5OH超限! %.2f PPM (阈值: >%.2f)\n", state.gasPpmValues.c2h5oh, thresholds.c2h5ohPpmMax);
+        state.gasC2h5ohStatus = SS_WARNING;
+    } else if (state.gasC2h5ohStatus == SS_WARNING && state.gasPpmValues.c2h5oh <= thresholds.c2h5ohPpmMax) {
+        state.gasC2h5ohStatus = SS_NORMAL;
+    }
+    if (state.gasVocStatus == SS_NORMAL && state.gasPpmValues.voc > thresholds.vocPpmMax) {
+        P_PRINTF("[ALARM] VOC超限! %.2f PPM (阈值: >%.2f)\n", state.gasPpmValues.voc, thresholds.vocPpmMax);
+        state.gasVocStatus = SS_WARNING;
+    } else if (state.gasVocStatus == SS_WARNING && state.gasPpmValues.voc <= thresholds.vocPpmMax) {
+        state.gasVocStatus = SS_NORMAL;
+    }
+    
+    anyAlarm = (state.tempStatus == SS_WARNING || state.humStatus == SS_WARNING || state.gasCoStatus == SS_WARNING || state.gasNo2Status == SS_WARNING || state.gasC2h5ohStatus == SS_WARNING || state.gasVocStatus == SS_WARNING);
+
+    if (anyAlarm) {
+        if (!state.buzzerShouldBeActive) {
+            state.buzzerShouldBeActive = true;
+            P_PRINTLN("[ALARM] 蜂鸣器激活!");
+        }
+    } else {
+        if (state.buzzerShouldBeActive) {
+            state.buzzerShouldBeActive = false;
+            P_PRINTLN("[ALARM] 报警解除, 蜂鸣器停止.");
+        }
+    }
+}
+
+void controlBuzzer(const DeviceState& state, unsigned long currentTime) {
+    if (state.buzzerShouldBeActive) {
+        if (!buzzerWasActive) { // 新一轮报警, 重新计数
+            buzzerBeepCount = 0;
+            buzzerStopTime = 0;
+        }
+        if (buzzerBeepCount < BUZZER_ALARM_COUNT) {
+            if (currentTime >= buzzerStopTime) {
+                if (digitalRead(BUZZER_PIN) == HIGH) { 
+                    digitalWrite(BUZZER_PIN, LOW);
+                    buzzerStopTime = currentTime + BUZZER_ALARM_INTERVAL; 
+                } else { 
+                    digitalWrite(BUZZER_PIN, HIGH);
+                    buzzerStopTime = currentTime + BUZZER_ALARM_DURATION; 
+                    buzzerBeepCount++;
+                }
+            }
+        } else if (currentTime >= buzzerStopTime) {
+            digitalWrite(BUZZER_PIN, LOW); // 最后一声也响满 BUZZER_ALARM_DURATION
+        }
+    } else { 
+        if (digitalRead(BUZZER_PIN) == HIGH) { 
+            digitalWrite(BUZZER_PIN, LOW);
+        }
+        buzzerBeepCount = 0; 
+        buzzerStopTime = 0;  
+    }
+    buzzerWasActive = state.buzzerShouldBeActive;
+}
+
+// ==========================================================================
+// == 运行参数 ==
+// ==========================================================================
+
+SensorParams getSensorParams() {
+    portENTER_CRITICAL(&sensorParamsMux);
+    SensorParams params = sensorParams;
+    portEXIT_CRITICAL(&sensorParamsMux);
+    return params;
+}
+
+uint32_t getR0Revision() {
+    return r0Revision.load();
+}
+
+void publishSensorParams(const DeviceConfig& config) {
+    portENTER_CRITICAL(&sensorParamsMux);
+    sensorParams.thresholds = config.thresholds;
+    sensorParams.r0Values = config.r0Values;
+    sensorParams.r0Calibrated = config.r0Calibrated;
+    portEXIT_CRITICAL(&sensorParamsMux);
+}
+
+void publishAlarmThresholds(const AlarmThresholds& thresholds) {
+    portENTER_CRITICAL(&sensorParamsMux);
+    sensorParams.thresholds = thresholds;
+    portEXIT_CRITICAL(&sensorParamsMux);
+}
+
+// 校准完成时替换 R0, 通知 loop 任务保存
+static void storeR0(const GasResistData& r0, const GasResistData& r0Calibrated) {
+    portENTER_CRITICAL(&sensorParamsMux);
+    sensorParams.r0Values = r0;
+    sensorParams.r0Calibrated = r0Calibrated;
+    portEXIT_CRITICAL(&sensorParamsMux);
+    r0Revision++;
+}
+
+// 基线跟踪: 新 R0 是在 expected 的基础上算出的. 期间 loop 任务发布过其他 R0 (重置/重新加载配置)
+// 时放弃本次调整, 不用旧值覆盖; 返回是否已替换
+static bool replaceR0IfUnchanged(const SensorParams& expected, const GasResistData& r0) {
+    bool replaced = false;
+    portENTER_CRITICAL(&sensorParamsMux);
+    if (memcmp(&sensorParams.r0Values, &expected.r0Values, sizeof(GasResistData)) == 0 &&
+        memcmp(&sensorParams.r0Calibrated, &expected.r0Calibrated, sizeof(GasResistData)) == 0) {
+        sensorParams.r0Values = r0;
+        replaced = true;
+    }
+    portEXIT_CRITICAL(&sensorParamsMux);
+    if (replaced) r0Revision++;
+    return replaced;
+}
+
+// ==========================================================================
+// == 校准 ==
+// ==========================================================================
+
+CalibrationStatus getCalibrationStatus() {
+    portENTER_CRITICAL(&calibrationMux);
+    CalibrationStatus status = calibrationStatus;
+    portEXIT_CRITICAL(&calibrationMux);
+    return status;
+}
+
+static void updateCalibrationStatus(CalibrationState state, int progress, const GasResistData* measuredR0) {
+    portENTER_CRITICAL(&calibrationMux);
+    calibrationStatus.state = state;
+    calibrationStatus.progress = progress;
+    if (measuredR0) calibrationStatus.measuredR0 = *measuredR0;
+    calibrationStatus.version++;
+    portEXIT_CRITICAL(&calibrationMux);
+}
+
+// ==========================================================================
+// == 在线校准 ==
+// == 校准在采样任务中基于实时样本流进行, 常规读数和历史记录不受影响.
+// == 每次过采样的各通道 Rs 计入 Welford 统计; 样本数达到 CALIBRATION_MIN_SAMPLES
+// == 且各通道变异系数均不超过 CALIBRATION_STABLE_CV 时即完成, 均值作为新的 R0.
+// == 一个统计窗口内未能稳定 (读数仍在漂移) 则丢弃重新统计, 超时判定失败.
+// ==========================================================================
+
+static RunningStats<GAS_CHANNEL_COUNT> calibrationStats;
+static bool calibrationActive = false;       // 采样任务已接手当前这次校准
+static unsigned long calibrationStartTime = 0;
+
+void startCalibration() {
+    if (getCalibrationStatus().state == CAL_IN_PROGRESS) {
+        P_PRINTLN("[CAL] 校准已在进行中。");
+        return;
+    }
+    P_PRINTLN("[CAL] 收到校准请求，将在采样任务中基于实时数据进行校准...");
+    GasResistData noMeasurement = {NAN, NAN, NAN, NAN};
+    updateCalibrationStatus(CAL_IN_PROGRESS, 0, &noMeasurement);
+}
+
+static void accumulateCalibrationSample(const GasRawReading& raw, unsigned long nowMs) {
+    if (!calibrationActive || nowMs < gasSensorWarmupEndTime) return;
+    const uint32_t adc[GAS_CHANNEL_COUNT] = { raw.co, raw.no2, raw.c2h5oh, raw.voc };
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        float rs = adcToRs(adc[ch]);
+        if (rs > 0) calibrationStats.add(ch, rs);
+    }
+}
+
+// 每个上报周期调用一次: 判断是否稳定, 更新进度, 完成时应用新的 R0
+static void updateCalibration(unsigned long now) {
+    if (getCalibrationStatus().state != CAL_IN_PROGRESS) {
+        calibrationActive = false;
+        return;
+    }
+    if (!calibrationActive) {
+        calibrationActive = true;
+        calibrationStats.reset();
+        calibrationStartTime = now;
+        P_PRINTLN("[CAL] 开始在线校准...");
+    }
+
+    if (now < gasSensorWarmupEndTime) {
+        updateCalibrationStatus(CAL_IN_PROGRESS, (int)((float)now / gasSensorWarmupEndTime * 20.0f), NULL);
+        return;
+    }
+
+    GasResistData measuredR0;
+    float* means[GAS_CHANNEL_COUNT] = { &measuredR0.co, &measuredR0.no2, &measuredR0.c2h5oh, &measuredR0.voc };
+    bool anyChannel = false, stable = true;
+    uint32_t minCount = UINT32_MAX;
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        uint32_t n = calibrationStats.count(ch);
+        *means[ch] = calibrationStats.mean(ch);
+        if (n == 0) continue; // 该通道没有有效读数, 保留原 R0
+        anyChannel = true;
+        if (n < minCount) minCount = n;
+        if (n < CALIBRATION_MIN_SAMPLES || calibrationStats.cv(ch) > CALIBRATION_STABLE_CV) stable = false;
+    }
+
+    if (anyChannel && stable) {
+        GasResistData r0 = getSensorParams().r0Values;
+        if (!isnan(measuredR0.co)) r0.co = measuredR0.co;
+        if (!isnan(measuredR0.no2)) r0.no2 = measuredR0.no2;
+        if (!isnan(measuredR0.c2h5oh)) r0.c2h5oh = measuredR0.c2h5oh;
+        if (!isnan(measuredR0.voc)) r0.voc = measuredR0.voc;
+        storeR0(r0, r0); // 保存到文件由 loop 任务完成
+        resetBaselineTracking();
+        calibrationActive = false;
+        updateCalibrationStatus(CAL_COMPLETED, 100, &measuredR0);
+        P_PRINTF("[CAL] 校准成功 (%lu ms), 新R0值 - CO: %.2f, NO2: %.2f, C2H5OH: %.2f, VOC: %.2f\n",
+                 now - calibrationStartTime, r0.co, r0.no2, r0.c2h5oh, r0.voc);
+        return;
+    }
+
+    unsigned long collectStart = max(calibrationStartTime, gasSensorWarmupEndTime);
+    if (now - collectStart > CALIBRATION_TIMEOUT_MS) {
+        calibrationActive = false;
+        updateCalibrationStatus(CAL_FAILED, 100, &measuredR0);
+        P_PRINTLN(anyChannel ? "[CAL] 校准失败，读数在超时前未能稳定。" : "[CAL] 校准失败，没有有效的采样数据。");
+        return;
+    }
+
+    if (anyChannel && minCount >= CALIBRATION_WINDOW_SAMPLES) {
+        P_PRINTLN("[CAL] 读数仍在漂移, 重新开始统计...");
+        calibrationStats.reset();
+        minCount = 0;
+    }
+
+    int progress = 20;
+    if (anyChannel) progress += (int)(75.0f * min(minCount, (uint32_t)CALIBRATION_MIN_SAMPLES) / CALIBRATION_MIN_SAMPLES);
+    updateCalibrationStatus(CAL_IN_PROGRESS, progress, &measuredR0);
+}
+
+// ==========================================================================
+// == 基线漂移跟踪 ==
+// == MOS 传感器的洁净空气电阻会随时间漂移. 在通道状态正常 (视为洁净空气) 的样本上
+// == 用 P² 流式估计 Rs 的分位数: 还原性气体使 Rs 下降, 基线取高分位; NO2 使 Rs 上升,
+// == 基线取低分位. 每个窗口结束时 R0 以有限步长向估计值靠拢, 并限制在校准值附近.
+// ==========================================================================
+
+static P2Quantile baselineEstimators[GAS_CHANNEL_COUNT];
+static uint32_t baselineWindowSamples = 0;
+
+static void resetBaselineTracking() {
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        baselineEstimators[ch].reset(gasChannelIsReducing(ch) ? BASELINE_QUANTILE_REDUCING : BASELINE_QUANTILE_OXIDIZING);
+    }
+    baselineWindowSamples = 0;
+}
+
+static void trackBaseline(const DeviceState& state, const SensorParams& params, unsigned long nowMs) {
+    if (nowMs < gasSensorWarmupEndTime || getCalibrationStatus().state == CAL_IN_PROGRESS) return;
+
+    const float rs[GAS_CHANNEL_COUNT] = { state.gasRsValues.co, state.gasRsValues.no2, state.gasRsValues.c2h5oh, state.gasRsValues.voc };
+    const SensorStatusVal status[GAS_CHANNEL_COUNT] = { state.gasCoStatus, state.gasNo2Status, state.gasC2h5ohStatus, state.gasVocStatus };
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        if (status[ch] == SS_NORMAL && rs[ch] > 0) baselineEstimators[ch].add(rs[ch]);
+    }
+    if (++baselineWindowSamples < BASELINE_WINDOW_SAMPLES) return;
+
+    GasResistData r0 = params.r0Values;
+    float* r0Ch[GAS_CHANNEL_COUNT] = { &r0.co, &r0.no2, &r0.c2h5oh, &r0.voc };
+    const GasResistData& cal = params.r0Calibrated;
+    const float calCh[GAS_CHANNEL_COUNT] = { cal.co, cal.no2, cal.c2h5oh, cal.voc };
+    bool changed = false;
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        if (baselineEstimators[ch].count() < BASELINE_WINDOW_SAMPLES * BASELINE_MIN_CLEAN_FRACTION) continue;
+        if (!(calCh[ch] > 0) || !(*r0Ch[ch] > 0)) continue;
+        float target = constrain(baselineEstimators[ch].value(),
+                                 calCh[ch] * (1.0f - BASELINE_MAX_DRIFT), calCh[ch] * (1.0f + BASELINE_MAX_DRIFT));
+        float maxStep = *r0Ch[ch] * BASELINE_MAX_STEP;
+        float step = constrain((target - *r0Ch[ch]) * BASELINE_ADJUST_GAIN, -maxStep, maxStep);
+        if (step != 0) {
+            *r0Ch[ch] += step;
+            changed = true;
+        }
+    }
+    resetBaselineTracking();
+
+    if (changed && !replaceR0IfUnchanged(params, r0)) {
+        P_PRINTLN("[BASELINE] R0 在本周期内已被重新设置, 放弃本次基线调整.");
+    } else if (changed) {
+        P_PRINTF("[BASELINE] R0 已按基线调整 - CO: %.2f, NO2: %.2f, C2H5OH: %.2f, VOC: %.2f (漂移 %+.1f%%, %+.1f%%, %+.1f%%, %+.1f%%)\n",
+                 r0.co, r0.no2, r0.c2h5oh, r0.voc,
+                 (r0.co / cal.co - 1) * 100, (r0.no2 / cal.no2 - 1) * 100,
+                 (r0.c2h5oh / cal.c2h5oh - 1) * 100, (r0.voc / cal.voc - 1) * 100);
+    }
+}
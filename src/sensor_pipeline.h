@@ -0,0 +1,38 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include "data_manager.h"
+#include "gas_sensor.h"
+#include "sensor_source.h"
+
+// ==========================================================================
+// == 传感器处理流程 (与硬件无关的部分) ==
+// == 读数只来自当前数据源 (sensor_source.h), 时间均由调用方传入, 不访问驱动和任务,
+// == 因此也能在主机上 (env:native) 用模拟/回放数据源和虚拟时钟驱动整条流程.
+// == 采样任务和 LED 见 sensor_handler.cpp.
+// ==========================================================================
+
+// -- 采样周期 (采样任务按固定周期调用) --
+void resetSensorPipeline();                                  // 清空滤波、基线跟踪和蜂鸣器节奏 (任务启动/回放开始时)
+void sampleGasSensor(unsigned long nowMs);                   // 每个过采样周期: 读取气体通道并送入滤波器
+void processSensorReport(DeviceState& state, unsigned long nowMs); // 每个上报周期: 校准 -> 读数 -> 警报 -> 基线跟踪
+
+// -- 传感器数据处理与计算 --
+void readSensors(DeviceState& state, const SensorParams& params, unsigned long nowMs); // 取回温湿度和滤波后的气体读数
+void calculatePpm(DeviceState& state, const GasRawReading& raw, const SensorParams& params); // 查表换算, R0 变化时重建查找表
+void checkAlarms(DeviceState& state, const SensorParams& params);
+void controlBuzzer(const DeviceState& state, unsigned long nowMs); // loop 任务调用, 按报警状态驱动蜂鸣器节奏
+
+// -- 运行参数 (阈值和 R0) --
+// loop 任务加载/修改配置后发布, 采样任务每个上报周期取一份副本使用.
+// 采样任务修改 R0 后递增 getR0Revision(), loop 任务用 getSensorParams() 取回并保存.
+void publishSensorParams(const DeviceConfig& config);          // 阈值和 R0 (加载或重置配置后)
+void publishAlarmThresholds(const AlarmThresholds& thresholds); // 只更新阈值, 不覆盖采样任务调整过的 R0
+SensorParams getSensorParams();                                 // 在临界区内复制
+uint32_t getR0Revision();                                       // R0 被校准或基线跟踪修改的次数, 变化时需保存配置
+
+// -- 传感器校准 --
+void startCalibration();                             // 请求在线校准, 由采样任务基于实时数据完成
+CalibrationStatus getCalibrationStatus();            // 在临界区内复制完整的校准状态
+
+#endif // SENSOR_PIPELINE_H
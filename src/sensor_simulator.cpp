@@ -0,0 +1,91 @@
+#include "sensor_simulator.h"
+#include "gas_ppm.h"
+
+// ==========================================================================
+// == 模块内部使用的全局对象和变量 ==
+// ==========================================================================
+
+struct SimulatorEvent {
+    GasChannel channel;
+    float rsFactor;
+    unsigned long startMs;
+    unsigned long durationMs;
+};
+
+const SimulatorProfile DEFAULT_SIMULATOR_PROFILE = {
+    24.0f, 3.0f, 45.0f,
+    { DEFAULT_R0_CO, DEFAULT_R0_NO2, DEFAULT_R0_C2H5OH, DEFAULT_R0_VOC },
+    0.01f, 1
+};
+
+static SimulatorProfile profile = DEFAULT_SIMULATOR_PROFILE;
+static SimulatorEvent events[SIMULATOR_MAX_EVENTS];
+static size_t eventCount = 0;
+static uint32_t noiseState = 1;
+static bool dhtConnected = true;
+static bool dhtStarted = false;
+static unsigned long dhtStartMs = 0;   // 与硬件一致, 取回的是开始读取时的温湿度
+
+#define SIMULATOR_DAY_MS 86400000.0f
+
+// ==========================================================================
+// == 函数实现 ==
+// ==========================================================================
+
+void simulatorBegin(const SimulatorProfile& newProfile) {
+    profile = newProfile;
+    eventCount = 0;
+    noiseState = newProfile.seed ? newProfile.seed : 1;
+    dhtConnected = true;
+    dhtStarted = false;
+}
+
+bool simulatorInjectGas(GasChannel channel, float rsFactor, unsigned long startMs, unsigned long durationMs) {
+    if (eventCount >= SIMULATOR_MAX_EVENTS || channel >= GAS_CHANNEL_COUNT) return false;
+    events[eventCount++] = { channel, rsFactor, startMs, durationMs };
+    return true;
+}
+
+void simulatorSetDhtConnected(bool connected) {
+    dhtConnected = connected;
+}
+
+// xorshift32, 返回 [-1, 1) 内的均匀噪声
+static float nextNoise() {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return (float)(noiseState >> 8) / (float)(1UL << 23) - 1.0f;
+}
+
+static GasReadResult readSimulatedGas(GasRawReading& out) {
+    const unsigned long now = millis();
+    const float clean[GAS_CHANNEL_COUNT] = { profile.cleanRs.co, profile.cleanRs.no2, profile.cleanRs.c2h5oh, profile.cleanRs.voc };
+    uint32_t* adc[GAS_CHANNEL_COUNT] = { &out.co, &out.no2, &out.c2h5oh, &out.voc };
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        float rs = clean[ch] * (1.0f + profile.rsNoise * nextNoise());
+        for (size_t i = 0; i < eventCount; i++) {
+            if (events[i].channel == ch && now - events[i].startMs < events[i].durationMs) rs *= events[i].rsFactor;
+        }
+        *adc[ch] = (uint32_t)rsToAdc(rs);
+    }
+    return GAS_READ_OK;
+}
+
+// 与硬件数据源一致: 取回的是上一次 startDht() 开始的读数, 第一次调用没有结果
+static DhtRmtResult fetchSimulatedDht(DhtReading& out) {
+    if (!dhtStarted) return DHT_RMT_NONE;
+    dhtStarted = false;
+    if (!dhtConnected) return DHT_RMT_FAILED;
+    const float phase = (float)(dhtStartMs % (unsigned long)SIMULATOR_DAY_MS) / SIMULATOR_DAY_MS;
+    out.temperature = profile.temperature + profile.temperatureSwing * sinf(2.0f * (float)M_PI * phase);
+    out.humidity = profile.humidity - profile.temperatureSwing * sinf(2.0f * (float)M_PI * phase);
+    return DHT_RMT_OK;
+}
+
+static void startSimulatedDht() {
+    dhtStartMs = millis();
+    dhtStarted = true;
+}
+
+const SensorSource SIMULATED_SENSOR_SOURCE = { "simulator", readSimulatedGas, fetchSimulatedDht, startSimulatedDht };
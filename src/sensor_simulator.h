@@ -0,0 +1,33 @@
+#ifndef SENSOR_SIMULATOR_H
+#define SENSOR_SIMULATOR_H
+
+#include "data_manager.h"
+#include "sensor_source.h"
+
+// ==========================================================================
+// == 模拟数据源 ==
+// == 按 millis() 生成读数: 温度按日周期缓慢变化, 各气体通道在洁净空气 Rs 附近
+// == 叠加确定性噪声, 可注入一段时间内的气体事件 (Rs 按倍数变化). 固件中以
+// == SENSOR_SIMULATION 开启; 主机测试中 millis() 为虚拟时钟, 结果可重复.
+// ==========================================================================
+
+struct SimulatorProfile {
+    float temperature;        // 日平均温度 (°C)
+    float temperatureSwing;   // 日周期振幅 (°C)
+    float humidity;           // 相对湿度 (%)
+    GasResistData cleanRs;    // 洁净空气中的 Rs (kOhm)
+    float rsNoise;            // Rs 相对噪声幅度 (0.01 表示 ±1%)
+    uint32_t seed;            // 噪声种子
+};
+
+extern const SimulatorProfile DEFAULT_SIMULATOR_PROFILE;
+extern const SensorSource SIMULATED_SENSOR_SOURCE;
+
+void simulatorBegin(const SimulatorProfile& profile);   // 重新开始 (清除事件, 重置噪声序列)
+// 从 startMs 起 durationMs 内该通道 Rs 乘以 rsFactor (还原性气体 <1, NO2 >1), 同时最多 SIMULATOR_MAX_EVENTS 个
+bool simulatorInjectGas(GasChannel channel, float rsFactor, unsigned long startMs, unsigned long durationMs);
+void simulatorSetDhtConnected(bool connected);         // 模拟温湿度传感器断开/恢复
+
+#define SIMULATOR_MAX_EVENTS 4
+
+#endif // SENSOR_SIMULATOR_H
@@ -0,0 +1,28 @@
+#ifndef SENSOR_SOURCE_H
+#define SENSOR_SOURCE_H
+
+#include "gas_sensor.h"
+#include "dht_rmt.h"
+
+// ==========================================================================
+// == 传感器数据源 ==
+// == 采样任务只通过当前数据源读取气体和温湿度, 不直接访问驱动. 默认为硬件数据源;
+// == 替换为模拟数据源 (sensor_simulator.h) 或回放数据源 (主机测试中按记录的 Rs/温湿度
+// == 序列返回读数, 见 test/native/trace_replay.h) 即可驱动 换算 -> 警报 -> 历史 整条处理流程.
+// == 处理流程中的时间均由调用方传入 (nowMs/timestamp), 回放时可使用虚拟时钟.
+// ==========================================================================
+
+struct SensorSource {
+    const char* name;
+    GasReadResult (*readGas)(GasRawReading& out);   // 过采样周期调用, 一次读取四个通道
+    DhtRmtResult (*fetchDht)(DhtReading& out);      // 上报周期调用, 取回上一次温湿度读数
+    void (*startDht)();                             // 取回后立即调用, 开始下一次温湿度读取
+};
+
+extern const SensorSource HARDWARE_SENSOR_SOURCE;
+
+// 替换数据源 (NULL 恢复硬件数据源), 从采样任务的下一个周期开始生效
+void setSensorSource(const SensorSource* source);
+const SensorSource& getSensorSource();
+
+#endif // SENSOR_SOURCE_H
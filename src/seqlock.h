@@ -0,0 +1,47 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// ==========================================================================
+// == 单写者顺序锁 (seqlock) ==
+// == 写者发布整份数据时序号先变为奇数, 写完再变为偶数; 读者复制数据前后
+// == 序号一致且为偶数才算读到一致的快照, 否则重试. 写者从不等待读者.
+// == T 必须可按字节复制 (不含指针所有权/String 等成员).
+// ==========================================================================
+
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : seq(0) {}
+
+    // 仅允许一个写者任务调用
+    void publish(const T& value) {
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&data, &value, sizeof(T));
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // 复制最近一次发布的数据, 返回发布次数 (0 表示尚未发布过, out 为初始值)
+    uint32_t read(T& out) const {
+        for (;;) {
+            const uint32_t s1 = seq.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            memcpy(&out, &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1) return s1 / 2;
+        }
+    }
+
+    uint32_t version() const { return seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    T data;
+    std::atomic<uint32_t> seq;
+};
+
+#endif // SEQLOCK_H
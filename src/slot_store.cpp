@@ -0,0 +1,82 @@
+#include "slot_store.h"
+#include "history_log.h"
+#include "config.h"
+
+SlotStore::SlotStore(const char* pathA, const char* pathB, uint16_t magic, size_t payloadSize) :
+    fs(NULL), magic(magic),
+    payloadSize(min(payloadSize, (size_t)SLOT_STORE_MAX_PAYLOAD)),
+    nextSlot(0), nextSeq(1), writes(0) {
+    paths[0] = pathA;
+    paths[1] = pathB;
+}
+
+bool SlotStore::readSlot(uint8_t index, uint8_t* payload, uint32_t* seq) {
+    uint8_t buf[sizeof(RecordLogHeader) + SLOT_STORE_MAX_PAYLOAD + sizeof(uint32_t)];
+    const size_t recSize = sizeof(RecordLogHeader) + payloadSize + sizeof(uint32_t);
+
+    File file = fs->open(paths[index], "r");
+    if (!file) return false;
+    bool ok = (file.read(buf, recSize) == recSize);
+    file.close();
+    if (!ok) return false;
+
+    RecordLogHeader header;
+    memcpy(&header, buf, sizeof(header));
+    if (header.magic != magic || header.payloadSize != payloadSize) return false;
+
+    uint32_t storedCrc;
+    memcpy(&storedCrc, buf + recSize - sizeof(uint32_t), sizeof(storedCrc));
+    if (crc32Compute(buf, recSize - sizeof(uint32_t)) != storedCrc) return false;
+
+    memcpy(payload, buf + sizeof(header), payloadSize);
+    *seq = header.seq;
+    return true;
+}
+
+bool SlotStore::load(fs::FS& filesystem, void* payload) {
+    fs = &filesystem;
+    uint8_t slotPayload[2][SLOT_STORE_MAX_PAYLOAD];
+    uint32_t seq[2] = {0, 0};
+    bool valid[2];
+    for (uint8_t i = 0; i < 2; i++) {
+        valid[i] = fs->exists(paths[i]) && readSlot(i, slotPayload[i], &seq[i]);
+    }
+
+    int newest = -1;
+    if (valid[0] && valid[1]) {
+        newest = ((int32_t)(seq[1] - seq[0]) > 0) ? 1 : 0; // 序号回绕安全的比较
+    } else if (valid[0] || valid[1]) {
+        newest = valid[0] ? 0 : 1;
+    }
+    if (newest < 0) return false;
+
+    memcpy(payload, slotPayload[newest], payloadSize);
+    nextSlot = 1 - newest;
+    nextSeq = seq[newest] + 1;
+    if (!valid[1 - newest] && fs->exists(paths[1 - newest])) {
+        P_PRINTF("[SLOT] 槽 %s 无效 (可能是写入时掉电), 已使用 %s.\n", paths[1 - newest], paths[newest]);
+    }
+    return true;
+}
+
+bool SlotStore::save(const void* payload) {
+    if (fs == NULL) return false;
+    uint8_t buf[sizeof(RecordLogHeader) + SLOT_STORE_MAX_PAYLOAD + sizeof(uint32_t)];
+    RecordLogHeader header = { magic, (uint16_t)payloadSize, nextSeq };
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header), payload, payloadSize);
+    uint32_t crc = crc32Compute(buf, sizeof(header) + payloadSize);
+    memcpy(buf + sizeof(header) + payloadSize, &crc, sizeof(crc));
+    const size_t recSize = sizeof(header) + payloadSize + sizeof(crc);
+
+    File file = fs->open(paths[nextSlot], "w");
+    if (!file) return false;
+    bool ok = (file.write(buf, recSize) == recSize);
+    file.close();
+    if (!ok) return false;
+
+    nextSlot = 1 - nextSlot;
+    nextSeq++;
+    writes++;
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef SLOT_STORE_H
+#define SLOT_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// ==========================================================================
+// == A/B 双槽二进制记录存储 ==
+// == 同一份定长记录交替写入两个文件, 每次写入带递增序号和CRC32. 加载时取两个槽中
+// == 序号最新且校验通过的一份, 写入过程中掉电只会损坏正在写的槽, 另一槽保持完好.
+// == 磁盘布局与 RecordLog 的单条记录相同: [RecordLogHeader][负载][CRC32].
+// ==========================================================================
+
+#define SLOT_STORE_MAX_PAYLOAD 192   // 负载上限 (字节)
+
+class SlotStore {
+public:
+    SlotStore(const char* pathA, const char* pathB, uint16_t magic, size_t payloadSize);
+
+    // 读取两个槽, 将最新的有效负载复制到 payload. 两个槽都无效时返回 false.
+    bool load(fs::FS& filesystem, void* payload);
+    // 写入较旧 (或无效) 的那个槽
+    bool save(const void* payload);
+
+    uint32_t writeCount() const { return writes; }
+
+private:
+    bool readSlot(uint8_t index, uint8_t* payload, uint32_t* seq);
+
+    fs::FS* fs;
+    const char* paths[2];
+    uint16_t magic;
+    size_t payloadSize;
+    uint8_t nextSlot;
+    uint32_t nextSeq;
+    uint32_t writes;
+};
+
+#endif // SLOT_STORE_H
@@ -0,0 +1,193 @@
+#include "storage_task.h"
+#include "config.h"
+#include "perf_stats.h"
+#include "health_monitor.h"
+#include <esp_timer.h>
+
+// ==========================================================================
+// == 作业队列 ==
+// == 循环数组, 由 storageMux 保护 (临界区内只做负载复制, 不做任何 I/O).
+// == 作业记录合并进来的最早票据 firstTicket: 只要还有 firstTicket <= t 的作业在
+// == 排队或执行, 票据 t 就未完成 (合并后的作业包含或取代了 t 的数据).
+// ==========================================================================
+
+struct StorageJob {
+    StorageJobHandler handler;
+    uint16_t mergeKey;
+    uint16_t length;
+    uint32_t firstTicket;
+    uint32_t submitUs;          // 最早一次提交的时间
+    uint8_t payload[STORAGE_JOB_MAX_PAYLOAD];
+};
+
+static StorageJob jobQueue[STORAGE_QUEUE_DEPTH];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static uint32_t nextTicket = 1;
+static uint32_t runningTicket = 0;  // 正在执行的作业的 firstTicket, 0 表示空闲
+static StorageStats stats;
+static TaskHandle_t storageTaskHandle = NULL;
+static portMUX_TYPE storageMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void runJob(const StorageJob& job) {
+    const uint32_t startUs = (uint32_t)esp_timer_get_time();
+    {
+        PERF_SCOPE(PERF_STORAGE_JOB);
+        job.handler(job.payload, job.length);
+    }
+    const uint32_t endUs = (uint32_t)esp_timer_get_time();
+    const uint32_t latencyUs = endUs - job.submitUs;
+    const uint32_t execUs = endUs - startUs;
+
+    portENTER_CRITICAL(&storageMux);
+    runningTicket = 0;
+    stats.completed++;
+    stats.lastLatencyUs = latencyUs;
+    stats.totalLatencyUs += latencyUs;
+    if (latencyUs > stats.maxLatencyUs) stats.maxLatencyUs = latencyUs;
+    stats.lastExecUs = execUs;
+    if (execUs > stats.maxExecUs) stats.maxExecUs = execUs;
+    portEXIT_CRITICAL(&storageMux);
+}
+
+static bool takeNextJob(StorageJob& job) {
+    bool found = false;
+    portENTER_CRITICAL(&storageMux);
+    if (queueCount > 0) {
+        const StorageJob& head = jobQueue[queueHead];
+        job.handler = head.handler;
+        job.mergeKey = head.mergeKey;
+        job.length = head.length;
+        job.firstTicket = head.firstTicket;
+        job.submitUs = head.submitUs;
+        memcpy(job.payload, head.payload, head.length);
+        queueHead = (queueHead + 1) % STORAGE_QUEUE_DEPTH;
+        queueCount--;
+        runningTicket = job.firstTicket;
+        found = true;
+    }
+    portEXIT_CRITICAL(&storageMux);
+    return found;
+}
+
+static void storageTask(void* pvParameters) {
+    static StorageJob job; // 只在本任务中使用, 不占任务堆栈
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (takeNextJob(job)) {
+            runJob(job);
+        }
+    }
+}
+
+void startStorageTask() {
+    xTaskCreatePinnedToCore(
+        storageTask, "StorageTask", STORAGE_TASK_STACK_SIZE, NULL, STORAGE_TASK_PRIORITY, &storageTaskHandle, STORAGE_TASK_CORE
+    );
+    healthRegisterTask(storageTaskHandle, "StorageTask", STORAGE_TASK_STACK_SIZE);
+    P_PRINTLN("[STORAGE] 存储任务已创建并启动.");
+}
+
+// ==========================================================================
+// == 提交与完成查询 ==
+// ==========================================================================
+
+uint32_t storageSubmit(StorageJobHandler handler, uint16_t mergeKey, const void* payload, size_t len) {
+    if (len > STORAGE_JOB_MAX_PAYLOAD) {
+        P_PRINTF("[STORAGE] 作业负载过大 (%u B), 已拒绝.\n", (unsigned)len);
+        return 0;
+    }
+    const uint32_t nowUs = (uint32_t)esp_timer_get_time();
+
+    // 任务尚未启动 (启动阶段): 直接在调用方上下文中执行
+    if (storageTaskHandle == NULL) {
+        StorageJob job;
+        job.handler = handler;
+        job.mergeKey = mergeKey;
+        job.length = (uint16_t)len;
+        job.submitUs = nowUs;
+        if (len > 0) memcpy(job.payload, payload, len);
+        portENTER_CRITICAL(&storageMux);
+        job.firstTicket = nextTicket++;
+        runningTicket = job.firstTicket;
+        stats.submitted++;
+        portEXIT_CRITICAL(&storageMux);
+        runJob(job);
+        return job.firstTicket;
+    }
+
+    uint32_t ticket = 0;
+    bool merged = false;
+    portENTER_CRITICAL(&storageMux);
+    stats.submitted++;
+    if (mergeKey != STORAGE_MERGE_NONE) {
+        for (uint8_t i = 0; i < queueCount; i++) {
+            StorageJob& queued = jobQueue[(queueHead + i) % STORAGE_QUEUE_DEPTH];
+            if (queued.mergeKey != mergeKey) continue;
+            queued.handler = handler;
+            queued.length = (uint16_t)len;
+            if (len > 0) memcpy(queued.payload, payload, len);
+            ticket = nextTicket++;
+            stats.merged++;
+            merged = true;
+            break;
+        }
+    }
+    if (!merged && queueCount < STORAGE_QUEUE_DEPTH) {
+        StorageJob& slot = jobQueue[(queueHead + queueCount) % STORAGE_QUEUE_DEPTH];
+        slot.handler = handler;
+        slot.mergeKey = mergeKey;
+        slot.length = (uint16_t)len;
+        slot.submitUs = nowUs;
+        if (len > 0) memcpy(slot.payload, payload, len);
+        ticket = nextTicket++;
+        slot.firstTicket = ticket;
+        queueCount++;
+        if (queueCount > stats.maxQueueDepth) stats.maxQueueDepth = queueCount;
+    } else if (!merged) {
+        stats.dropped++;
+    }
+    portEXIT_CRITICAL(&storageMux);
+
+    if (ticket == 0) {
+        P_PRINTLN("[STORAGE] 作业队列已满, 丢弃写入作业.");
+        return 0;
+    }
+    if (!merged) xTaskNotifyGive(storageTaskHandle);
+    return ticket;
+}
+
+bool storageIsDone(uint32_t ticket) {
+    bool done = true;
+    portENTER_CRITICAL(&storageMux);
+    if (runningTicket != 0 && runningTicket <= ticket) done = false;
+    for (uint8_t i = 0; done && i < queueCount; i++) {
+        if (jobQueue[(queueHead + i) % STORAGE_QUEUE_DEPTH].firstTicket <= ticket) done = false;
+    }
+    portEXIT_CRITICAL(&storageMux);
+    return done;
+}
+
+bool storageWaitFor(uint32_t ticket, uint32_t timeoutMs) {
+    const unsigned long start = millis();
+    while (!storageIsDone(ticket)) {
+        if (millis() - start >= timeoutMs) return false;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return true;
+}
+
+bool storageFlush(uint32_t timeoutMs) {
+    portENTER_CRITICAL(&storageMux);
+    const uint32_t lastTicket = nextTicket - 1;
+    portEXIT_CRITICAL(&storageMux);
+    return storageWaitFor(lastTicket, timeoutMs);
+}
+
+StorageStats getStorageStats() {
+    portENTER_CRITICAL(&storageMux);
+    StorageStats copy = stats;
+    copy.queueDepth = queueCount;
+    portEXIT_CRITICAL(&storageMux);
+    return copy;
+}
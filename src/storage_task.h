@@ -0,0 +1,50 @@
+#ifndef STORAGE_TASK_H
+#define STORAGE_TASK_H
+
+#include <Arduino.h>
+
+// ==========================================================================
+// == 后台存储任务 ==
+// == 所有 flash 写入 (配置、历史日志) 由一个低优先级任务串行执行. 调用方把要写的
+// == 数据复制进作业后立即返回, 不会被 SPIFFS 的擦写阻塞.
+// ==  - 队列定长 (STORAGE_QUEUE_DEPTH), 满时新作业被丢弃并计数
+// ==  - mergeKey 非零的作业若已有同 key 的作业在排队, 只替换其负载 (只写最新的数据)
+// ==  - 每个作业返回一个递增票据, 可用 storageIsDone()/storageWaitFor() 查询完成
+// == 任务启动前提交的作业在调用方上下文中直接执行 (启动阶段的加载/迁移).
+// ==========================================================================
+
+#define STORAGE_JOB_MAX_PAYLOAD 192     // 单个作业的负载上限 (字节)
+#define STORAGE_MERGE_NONE 0            // 不合并的作业 (如日志追加, 每条都要写)
+
+// 作业处理函数, 在存储任务中执行; payload 为提交时复制的数据
+typedef void (*StorageJobHandler)(const void* payload, size_t len);
+
+struct StorageStats {
+    uint16_t queueDepth;        // 当前排队的作业数
+    uint16_t maxQueueDepth;     // 排队作业数峰值
+    uint32_t submitted;         // 提交次数 (含被合并的)
+    uint32_t merged;            // 合并进已排队作业的次数
+    uint32_t dropped;           // 队列已满被丢弃的次数
+    uint32_t completed;         // 执行完成的作业数
+    uint32_t lastLatencyUs;     // 最近一个作业从提交到完成的时间
+    uint32_t maxLatencyUs;
+    uint64_t totalLatencyUs;
+    uint32_t lastExecUs;        // 最近一个作业的执行时间 (flash 操作本身)
+    uint32_t maxExecUs;
+};
+
+void startStorageTask();
+
+// 提交作业, 返回票据; 队列已满时返回 0
+uint32_t storageSubmit(StorageJobHandler handler, uint16_t mergeKey, const void* payload, size_t len);
+
+// 票据 ticket 及之前提交的所有作业均已执行完成时返回 true (ticket 为 0 视为已完成)
+bool storageIsDone(uint32_t ticket);
+// 等待票据完成, 超时返回 false
+bool storageWaitFor(uint32_t ticket, uint32_t timeoutMs);
+// 等待目前已提交的所有作业完成 (重启前调用)
+bool storageFlush(uint32_t timeoutMs);
+
+StorageStats getStorageStats();
+
+#endif // STORAGE_TASK_H
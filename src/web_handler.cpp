@@ -2,6 +2,12 @@
 #include "data_manager.h"
 #include "sensor_handler.h" 
 #include "config.h"
+#include "sensor_frame.h"
+#include "storage_task.h"
+#include "perf_stats.h"
+#include "health_monitor.h"
+#include "gas_sensor.h"
+#include "perfect_hash.h"
 
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
@@ -9,13 +15,38 @@
 #include <DNSServer.h>
 #include <time.h>
 #include <SPIFFS.h>
+#include <lwip/sockets.h>
+#include <atomic>
+
+#ifdef EMBED_WEB_ASSETS
+#include "web_assets_data.h"   // 构建脚本生成的 gzip 网页资源数组 (位于 flash)
+#endif
 
 // ==========================================================================
 // == 模块内部使用的全局对象和变量 ==
 // ==========================================================================
 static DNSServer dnsServer;
 static AsyncWebServer server(80);
-static WebSocketsServer webSocket(81);
+
+// 库的发送是同步的 (写满 TCP 发送缓冲区时阻塞到 WEBSOCKETS_TCP_TIMEOUT).
+// 订阅推送前先用零超时的 select() 检查客户端套接字是否可写, 不可写的客户端本轮跳过.
+class SubscriptionServer : public WebSocketsServer {
+public:
+    explicit SubscriptionServer(uint16_t port) : WebSocketsServer(port) {}
+
+    bool clientWritable(uint8_t num) {
+        if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !_clients[num].tcp) return false;
+        const int fd = _clients[num].tcp->fd();
+        if (fd < 0) return false;
+        fd_set writeSet;
+        FD_ZERO(&writeSet);
+        FD_SET(fd, &writeSet);
+        struct timeval timeout = { 0, 0 };
+        return select(fd + 1, NULL, &writeSet, NULL, &timeout) > 0;
+    }
+};
+
+static SubscriptionServer webSocket(81);
 
 // NTP状态变量
 bool ntpSynced = false;
@@ -24,8 +55,247 @@ int ntpInitialAttempts = 0;
 unsigned long lastNtpAttemptTime = 0;
 unsigned long lastNtpSyncTime = 0;
 
-// WebSocket action handlers map
-static std::map<String, WebSocketActionHandler> wsActionHandlers;
+// 已协商二进制实时数据协议的客户端 (断开连接时复位)
+static bool clientBinaryMode[WEBSOCKETS_SERVER_CLIENT_MAX] = { false };
+
+// ==========================================================================
+// == 出站消息缓冲池 ==
+// == WebSocket 消息都在 loop 任务中构建和发送 (事件回调在 webSocket.loop() 中执行).
+// == 预先静态分配 WS_MESSAGE_POOL_SIZE 个 JSON 文档 + 帧缓冲区, 每条消息借用一个,
+// == 离开作用域时归还, 稳态下收发消息不分配堆内存. 处理请求时最多同时占用两个
+// == (请求的响应 + 处理函数主动发送的消息).
+// == 帧缓冲区前部预留 WebSocket 帧头, JSON 直接序列化到帧头之后, 以 headerToPayload
+// == 方式发送, 库不再复制负载. 多个客户端共用一次序列化结果.
+// ==========================================================================
+
+struct WsMessageSlot {
+    StaticJsonDocument<WS_MESSAGE_DOC_SIZE> doc;
+    uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + WS_MESSAGE_BUFFER_SIZE];
+    bool inUse;
+};
+
+static WsMessageSlot wsMessagePool[WS_MESSAGE_POOL_SIZE];
+
+class WsMessage {
+public:
+    WsMessage() : slot(NULL), length(0), prepared(false) {
+        for (WsMessageSlot& s : wsMessagePool) {
+            if (s.inUse) continue;
+            s.inUse = true;
+            s.doc.clear();
+            slot = &s;
+            break;
+        }
+        if (!slot) P_PRINTLN("[WS] 消息缓冲池已耗尽, 丢弃本条消息.");
+    }
+    ~WsMessage() { if (slot) slot->inUse = false; }
+
+    bool valid() const { return slot != NULL; }
+    JsonDocument& doc() { return slot->doc; }
+
+    // 序列化到帧缓冲区 (只做一次), 文档或缓冲区溢出时返回 false
+    bool prepare() {
+        if (!slot) return false;
+        if (prepared) return length > 0;
+        prepared = true;
+        char* text = (char*)slot->frame + WEBSOCKETS_MAX_HEADER_SIZE;
+        length = serializeJson(slot->doc, text, WS_MESSAGE_BUFFER_SIZE);
+        if (slot->doc.overflowed() || length >= WS_MESSAGE_BUFFER_SIZE - 1) {
+            P_PRINTF("[WS] 消息超出缓冲区 (%s, %u B), 未发送.\n", slot->doc["type"] | "?", length);
+            length = 0;
+        }
+        return length > 0;
+    }
+    bool sendTo(uint8_t clientNum) {
+        return prepare() && webSocket.sendTXT(clientNum, slot->frame, length, true);
+    }
+    bool broadcast() {
+        return prepare() && webSocket.broadcastTXT(slot->frame, length, true);
+    }
+
+private:
+    WsMessage(const WsMessage&);
+    WsMessage& operator=(const WsMessage&);
+
+    WsMessageSlot* slot;
+    size_t length;
+    bool prepared;
+};
+
+// IPAddress::toString() 返回 String (堆分配), 消息中改用栈缓冲区
+static void formatIp(const IPAddress& ip, char (&out)[16]) {
+    snprintf(out, sizeof(out), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
+
+// ==========================================================================
+// == 预序列化帧缓存 ==
+// == 每种引导消息 (WiFi 状态、传感器关键帧、设置) 保存最近一次序列化的帧及其源数据版本.
+// == 版本不变时直接发送缓存的帧: 服务器帧不加掩码, 帧头写在预留区, 负载原样重复发送,
+// == 不再构建文档, 也不复制负载. 源数据变化后在下一次发送时重新生成.
+// ==========================================================================
+
+template <size_t SIZE>
+struct CachedFrame {
+    bool valid;
+    uint64_t version;
+    size_t length;
+    uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + SIZE];
+};
+
+static CachedFrame<WS_CACHED_FRAME_SIZE> wifiStatusFrame;
+static CachedFrame<WS_CACHED_FRAME_SIZE> sensorKeyframe;
+static CachedFrame<WS_CACHED_FRAME_SIZE> settingsFrame;
+static CachedFrame<WS_CACHED_FRAME_SIZE> calibrationFrame;   // 以下为订阅主题最近一次发布的帧
+static CachedFrame<WS_CACHED_FRAME_SIZE> historyTailFrame;
+#if PERF_STATS_ENABLED
+static CachedFrame<WS_PERF_FRAME_SIZE> perfFrame;
+static StaticJsonDocument<WS_PERF_DOC_SIZE> perfDoc;   // 生成 perfFrame 用, 只在 loop 任务中使用
+#endif
+
+template <size_t SIZE>
+static bool cachedFrameIsCurrent(const CachedFrame<SIZE>& cache, uint64_t version) {
+    return cache.valid && cache.version == version;
+}
+
+// 将文档序列化进缓存, 超出缓存容量时返回 false (调用方改用消息缓冲池发送)
+template <size_t SIZE>
+static bool storeCachedFrame(CachedFrame<SIZE>& cache, const JsonDocument& doc, uint64_t version) {
+    cache.valid = false;
+    if (doc.overflowed()) return false;
+    size_t len = serializeJson(doc, (char*)cache.frame + WEBSOCKETS_MAX_HEADER_SIZE, SIZE);
+    if (len == 0 || len >= SIZE - 1) return false;
+    cache.length = len;
+    cache.version = version;
+    cache.valid = true;
+    return true;
+}
+
+// specificClientNum 为 255 时广播
+template <size_t SIZE>
+static bool sendCachedFrame(CachedFrame<SIZE>& cache, uint8_t specificClientNum) {
+    if (specificClientNum == 255) return webSocket.broadcastTXT(cache.frame, cache.length, true);
+    return webSocket.sendTXT(specificClientNum, cache.frame, cache.length, true);
+}
+
+// ==========================================================================
+// == 健康数据输出缓冲区 ==
+// == 含采样历史的健康数据较大, 文档和序列化缓冲区静态分配, 由 HTTP (async_tcp 任务) 和
+// == WebSocket (loop 任务) 共用, 同一时刻只服务一个请求. HTTP 响应直接从缓冲区发送,
+// == 连接结束后才释放; 占用期间 HTTP 返回 503, WebSocket 回复错误消息.
+// ==========================================================================
+
+static StaticJsonDocument<HEALTH_JSON_HISTORY_CAPACITY> healthDoc;
+static uint8_t healthFrame[WEBSOCKETS_MAX_HEADER_SIZE + HEALTH_JSON_BUFFER_SIZE];
+static std::atomic<bool> healthBusy(false);
+
+static bool acquireHealthBuffer() {
+    bool expected = false;
+    return healthBusy.compare_exchange_strong(expected, true, std::memory_order_acquire);
+}
+
+static void releaseHealthBuffer() {
+    healthBusy.store(false, std::memory_order_release);
+}
+
+// 生成健康数据并序列化到帧头预留区之后, 返回负载长度; 超出容量时返回 0. 调用前须已占用缓冲区
+static size_t serializeHealthJson(bool withHistory) {
+    healthDoc.clear();
+    buildHealthJson(healthDoc, withHistory);
+    if (healthDoc.overflowed()) return 0;
+    size_t len = serializeJson(healthDoc, (char*)healthFrame + WEBSOCKETS_MAX_HEADER_SIZE, HEALTH_JSON_BUFFER_SIZE);
+    if (len == 0 || len >= HEALTH_JSON_BUFFER_SIZE - 1) return 0;
+    return len;
+}
+
+// ==========================================================================
+// == 客户端订阅 ==
+// == 广播消息按主题发布: 每个主题只保留最新的一帧 (只序列化一次) 和递增的序号.
+// == 每个客户端有一个有界的待发队列: 每个主题一个槽位 (lastSeq != topicSeq 表示有待发帧),
+// == 槽位引用共享的最新帧, 新帧直接取代旧帧 (latest-wins), 所以队列长度不超过主题数.
+// == network_loop() 中轮流排空各客户端的队列, 不阻塞: 套接字不可写 (TCP 发送缓冲区已满)
+// == 的客户端本轮跳过 (busySkips), 帧留在队列中继续被取代, 其他客户端照常发送.
+// == 发送失败或耗时超过 WS_SLOW_SEND_US 的客户端另外暂停 WS_SLOW_BACKOFF_MS.
+// == 因订阅间隔未到而被取代的帧计为合并 (coalesced, 客户端自己要求的),
+// == 客户端不可写或暂停期间被取代以及发送失败的帧计为丢弃 (dropped).
+// ==========================================================================
+
+enum WsTopic {
+    TOPIC_SENSOR,        // 实时数据 (二进制帧或 JSON 增量/关键帧)
+    TOPIC_WIFI,          // WiFi 状态
+    TOPIC_CALIBRATION,   // 校准状态
+    TOPIC_HISTORY_TAIL,  // 新增的原始历史点
+    TOPIC_PERF,          // 分阶段耗时统计
+    TOPIC_COUNT
+};
+
+static const char* const WS_TOPIC_NAMES[TOPIC_COUNT] = { "sensor", "wifi", "calibration", "historyTail", "perf" };
+
+#define WS_TOPIC_OFF UINT32_MAX // 未订阅
+
+struct WsClientTopic {
+    uint32_t intervalMs;        // 最小发送间隔, WS_TOPIC_OFF 表示未订阅
+    uint32_t lastSeq;           // 已发送的主题序号, 0 表示尚未发送 (新订阅时立即发送当前帧)
+    uint32_t accountedSeq;      // 此序号及之前被跳过的帧已计入 coalesced 或 dropped
+    unsigned long lastSentTime;
+};
+
+struct WsClientState {
+    WsClientTopic topics[TOPIC_COUNT];
+    uint32_t sent;
+    uint32_t coalesced;         // 订阅间隔未到时被更新的帧取代的帧数
+    uint32_t dropped;           // 暂停期间被更新的帧取代或发送失败的帧数
+    uint32_t slowSends;
+    uint32_t busySkips;         // 有到期帧但套接字不可写而跳过的轮数
+    uint32_t lastSendUs;
+    uint32_t maxSendUs;
+    unsigned long backoffUntil;
+    bool backoff;
+    bool congested;             // 上一轮因套接字不可写被跳过
+};
+
+static WsClientState wsClients[WEBSOCKETS_SERVER_CLIENT_MAX];
+static uint32_t topicSeq[TOPIC_COUNT] = { 0 };
+
+// 新连接: 默认订阅实时数据/WiFi/校准 (每次发布都发送, 与原广播行为相同).
+// 引导消息已包含当前状态, 从当前序号开始只发送之后的更新.
+static void resetWsClient(uint8_t clientNum) {
+    if (clientNum >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    WsClientState& c = wsClients[clientNum];
+    memset(&c, 0, sizeof(c));
+    for (uint8_t t = 0; t < TOPIC_COUNT; t++) {
+        c.topics[t].intervalMs = (t == TOPIC_HISTORY_TAIL || t == TOPIC_PERF) ? WS_TOPIC_OFF : 0;
+        c.topics[t].lastSeq = topicSeq[t];
+        c.topics[t].accountedSeq = topicSeq[t];
+    }
+}
+
+// 将 accountedSeq 之后到当前最新帧之前 (最新帧仍待发送) 被跳过的帧计入合并或丢弃
+// (backedOff: 客户端处于暂停或不可写状态)
+static void accountSkippedFrames(WsClientState& c, uint8_t topic, bool backedOff) {
+    WsClientTopic& ct = c.topics[topic];
+    if (ct.intervalMs == WS_TOPIC_OFF || topicSeq[topic] == 0) return;
+    const uint32_t upTo = topicSeq[topic] - 1;
+    if ((int32_t)(upTo - ct.accountedSeq) <= 0) return;
+    if (backedOff) c.dropped += upTo - ct.accountedSeq;
+    else c.coalesced += upTo - ct.accountedSeq;
+    ct.accountedSeq = upTo;
+}
+
+static uint8_t wsClientQueueDepth(uint8_t clientNum) {
+    uint8_t depth = 0;
+    for (uint8_t t = 0; t < TOPIC_COUNT; t++) {
+        const WsClientTopic& ct = wsClients[clientNum].topics[t];
+        if (ct.intervalMs != WS_TOPIC_OFF && ct.lastSeq != topicSeq[t]) depth++;
+    }
+    return depth;
+}
+
+static bool topicHasSubscribers(WsTopic topic) {
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        if (wsClients[num].topics[topic].intervalMs != WS_TOPIC_OFF && webSocket.clientIsConnected(num)) return true;
+    }
+    return false;
+}
 
 // ==========================================================================
 // == 函数声明 (内部使用) ==
@@ -38,6 +308,11 @@ void handleScanWifiRequest(uint8_t clientNum, const JsonDocument& request, JsonD
 void handleConnectWifiRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
 void handleResetSettingsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
 void handleStartCalibrationRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response); // 新增
+void handleSetProtocolRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
+void handleGetPerfStatsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
+void handleGetHealthRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
+void handleSubscribeRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
+void handleGetClientStatsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
 void startWifiScan(uint8_t clientNum, WifiState& wifiStatus, JsonDocument& responseDoc);
 
 // ==========================================================================
@@ -59,17 +334,16 @@ void initWiFiAndWebServer(DeviceConfig& config, WifiState& wifiStatus) {
     server.begin();
     P_PRINTLN("[HTTP] HTTP服务器已启动");
 
-    setupWebSocketActions();
     webSocket.begin();
     webSocket.onEvent(onWebSocketEvent);
     P_PRINTLN("[WS] WebSocket服务器已启动");
 
     if (config.currentSsidForSettings.length() > 0) {
         P_PRINTF("[WIFI] 检测到保存的SSID: %s, 尝试自动连接...\n", config.currentSsidForSettings.c_str());
-        wifiStatus.ssidToTry = config.currentSsidForSettings;
-        wifiStatus.passwordToTry = config.currentPasswordForSettings;
+        strlcpy(wifiStatus.ssidToTry, config.currentSsidForSettings.c_str(), sizeof(wifiStatus.ssidToTry));
+        strlcpy(wifiStatus.passwordToTry, config.currentPasswordForSettings.c_str(), sizeof(wifiStatus.passwordToTry));
         wifiStatus.connectInitiatorClientNum = 255;
-        WiFi.begin(wifiStatus.ssidToTry.c_str(), wifiStatus.passwordToTry.c_str());
+        WiFi.begin(wifiStatus.ssidToTry, wifiStatus.passwordToTry);
         wifiStatus.connectProgress = WIFI_CP_CONNECTING;
         wifiStatus.connectAttemptStartTime = millis();
     } else {
@@ -80,13 +354,103 @@ void initWiFiAndWebServer(DeviceConfig& config, WifiState& wifiStatus) {
     configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER1, NTP_SERVER2);
 }
 
+// ==========================================================================
+// == 静态网页资源 ==
+// ==========================================================================
+
+// SPIFFS 中只有构建脚本压缩后的 xxx.gz; AsyncFileResponse 找不到原路径时会自动改用 .gz 文件
+// 并添加 Content-Encoding: gzip. ETag 为资源内容哈希, 从资源清单加载.
+// 定义 EMBED_WEB_ASSETS 时改为直接发送固件中的压缩数据, 不再读取 SPIFFS.
+struct WebAsset {
+    const char* path;
+    const char* contentType;
+    bool versioned;    // HTML 中以 ?v=<哈希> 引用, 可长期缓存; 否则每次用 ETag 重新验证
+    char etag[24];
+    const uint8_t* embeddedData;   // 固件内嵌的 gzip 数据 (未内嵌时为 NULL)
+    size_t embeddedLength;
+};
+
+static WebAsset webAssets[] = {
+    { "/index.html",    "text/html",              false, "", NULL, 0 },
+    { "/settings.html", "text/html",              false, "", NULL, 0 },
+    { "/lang.json",     "application/json",       false, "", NULL, 0 },
+    { "/style.css",     "text/css",               true,  "", NULL, 0 },
+    { "/script.js",     "application/javascript", true,  "", NULL, 0 },
+    { "/chart.min.js",  "application/javascript", true,  "", NULL, 0 },
+};
+
+#ifdef EMBED_WEB_ASSETS
+static void loadWebAssetManifest() {
+    size_t bound = 0;
+    for (WebAsset& asset : webAssets) {
+        for (size_t i = 0; i < EMBEDDED_WEB_ASSET_COUNT; i++) {
+            if (strcmp(asset.path, EMBEDDED_WEB_ASSETS[i].path) != 0) continue;
+            snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", EMBEDDED_WEB_ASSETS[i].etag);
+            asset.embeddedData = EMBEDDED_WEB_ASSETS[i].data;
+            asset.embeddedLength = EMBEDDED_WEB_ASSETS[i].length;
+            bound++;
+        }
+    }
+    P_PRINTF("[HTTP] 使用固件内嵌网页资源 (%u 个).\n", bound);
+}
+#else
+static void loadWebAssetManifest() {
+    File file = SPIFFS.open(WEB_ASSET_MANIFEST, "r");
+    if (!file) {
+        P_PRINTLN("[HTTP] 未找到网页资源清单, 不发送 ETag.");
+        return;
+    }
+    DynamicJsonDocument doc(1024);
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+        P_PRINTF("[HTTP] 解析网页资源清单失败: %s\n", error.c_str());
+        return;
+    }
+    for (WebAsset& asset : webAssets) {
+        const char* hash = doc[asset.path]["etag"];
+        if (hash) snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", hash);
+    }
+}
+#endif
+
+static void serveWebAsset(AsyncWebServerRequest* request, const WebAsset& asset) {
+    static const String immutableCache = "public, max-age=" + String(WEB_ASSET_MAX_AGE_SEC) + ", immutable";
+    const char* cacheControl = asset.versioned ? immutableCache.c_str() : "no-cache";
+
+    // 浏览器缓存的版本仍是最新: 只回复 304, 不读取文件
+    if (asset.etag[0] && request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value().indexOf(asset.etag) >= 0) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        return;
+    }
+
+    AsyncWebServerResponse* response;
+    if (asset.embeddedData) {
+        // 直接从映射到地址空间的 flash 分段发送, 不经过 SPIFFS, 也不复制整个文件到 RAM
+        response = request->beginResponse_P(200, asset.contentType, asset.embeddedData, asset.embeddedLength);
+        if (response) response->addHeader("Content-Encoding", "gzip");
+    } else {
+        response = request->beginResponse(SPIFFS, asset.path, asset.contentType);
+    }
+    if (!response) {
+        request->send(404, "text/plain", "Not found");
+        return;
+    }
+    if (asset.etag[0]) response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
 void configureWebServer() {
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/index.html", "text/html"); });
-    server.on("/settings.html", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/settings.html", "text/html"); });
-    server.on("/style.css", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/style.css", "text/css"); });
-    server.on("/script.js", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/script.js", "application/javascript"); });
-    server.on("/lang.json", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/lang.json", "application/json"); });
-    server.on("/chart.min.js", HTTP_GET, [](AsyncWebServerRequest *request){ request->send(SPIFFS, "/chart.min.js", "application/javascript"); });
+    loadWebAssetManifest();
+    for (const WebAsset& asset : webAssets) {
+        server.on(asset.path, HTTP_GET, [&asset](AsyncWebServerRequest *request){ serveWebAsset(request, asset); });
+    }
+    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){ serveWebAsset(request, webAssets[0]); });
     
     server.on("/generate_204", HTTP_GET, handleCaptivePortal);
     server.on("/gen_204", HTTP_GET, handleCaptivePortal);
@@ -96,12 +460,34 @@ void configureWebServer() {
     server.on("/connecttest.txt", HTTP_GET, handleCaptivePortal);
     server.on("/success.html", HTTP_GET, handleCaptivePortal);
 
+    // 运行健康数据, 供长期运行的设备采集趋势. ?history=1 时附带采样历史
+    server.on("/api/health", HTTP_GET, [](AsyncWebServerRequest *request){
+        bool withHistory = request->hasParam("history") && request->getParam("history")->value() != "0";
+        if (!acquireHealthBuffer()) {
+            request->send(503, "text/plain", "Busy, retry later.");
+            return;
+        }
+        const size_t len = serializeHealthJson(withHistory);
+        if (len == 0) {
+            releaseHealthBuffer();
+            request->send(500, "text/plain", "Health data exceeds buffer.");
+            return;
+        }
+        // 响应体发送时直接从缓冲区读取, 连接断开 (发送完毕或中止) 后才释放
+        request->onDisconnect(releaseHealthBuffer);
+        AsyncWebServerResponse *response = request->beginResponse_P(200, "application/json",
+                                                                    healthFrame + WEBSOCKETS_MAX_HEADER_SIZE, len);
+        response->addHeader("Cache-Control", "no-store");
+        request->send(response);
+    });
+
     server.onNotFound(handleCaptivePortal);
 }
 
 void network_loop() {
     dnsServer.processNextRequest();
     webSocket.loop();
+    processWebSocketSubscriptions();
     processWiFiConnection(wifiState, currentConfig);
     processWifiScanResults(wifiState);
 
@@ -155,13 +541,11 @@ void processWiFiConnection(WifiState& wifiStatus, DeviceConfig& config) {
     if (wifiStatus.connectProgress == WIFI_CP_IDLE || wifiStatus.connectProgress == WIFI_CP_FAILED) {
         return;
     }
-    DynamicJsonDocument responseDoc(256);
-    responseDoc["type"] = "connectWifiStatus";
     bool sendUpdateToClient = false;
     if (wifiStatus.connectProgress == WIFI_CP_DISCONNECTING) {
         if (WiFi.status() == WL_DISCONNECTED || millis() - wifiStatus.connectAttemptStartTime > 3000) { 
-            P_PRINTF("[WIFI_PROC] 已断开或超时(WIFI_CP_DISCONNECTING). 尝试连接到 %s\n", wifiStatus.ssidToTry.c_str());
-            WiFi.begin(wifiStatus.ssidToTry.c_str(), wifiStatus.passwordToTry.c_str());
+            P_PRINTF("[WIFI_PROC] 已断开或超时(WIFI_CP_DISCONNECTING). 尝试连接到 %s\n", wifiStatus.ssidToTry);
+            WiFi.begin(wifiStatus.ssidToTry, wifiStatus.passwordToTry);
             wifiStatus.connectProgress = WIFI_CP_CONNECTING;
             wifiStatus.connectAttemptStartTime = millis(); 
         }
@@ -169,40 +553,49 @@ void processWiFiConnection(WifiState& wifiStatus, DeviceConfig& config) {
     }
     if (wifiStatus.connectProgress == WIFI_CP_CONNECTING) {
         wl_status_t status = WiFi.status();
+        bool success = false;
+        char message[128];
         if (status == WL_CONNECTED) {
             config.currentSsidForSettings = wifiStatus.ssidToTry; 
             config.currentPasswordForSettings = wifiStatus.passwordToTry;
             saveConfig(config); 
-            P_PRINTF("[WIFI_PROC] 连接成功: SSID=%s, IP=%s\n", wifiStatus.ssidToTry.c_str(), WiFi.localIP().toString().c_str());
-            responseDoc["success"] = true;
-            responseDoc["message"] = "WiFi connected successfully to " + wifiStatus.ssidToTry;
-            responseDoc["ip"] = WiFi.localIP().toString();
+            P_PRINTF("[WIFI_PROC] 连接成功: SSID=%s, IP=%s\n", wifiStatus.ssidToTry, WiFi.localIP().toString().c_str());
+            success = true;
+            snprintf(message, sizeof(message), "WiFi connected successfully to %s", wifiStatus.ssidToTry);
             wifiStatus.connectProgress = WIFI_CP_IDLE;
             sendUpdateToClient = true;
             ntpInitialAttempts = 0; 
             lastNtpAttemptTime = 0;
             ntpGiveUp = false;
         } else if (millis() - wifiStatus.connectAttemptStartTime > 20000) { 
-            P_PRINTF("[WIFI_PROC] 连接超时: SSID=%s. WiFi Status: %d\n", wifiStatus.ssidToTry.c_str(), status); 
+            P_PRINTF("[WIFI_PROC] 连接超时: SSID=%s. WiFi Status: %d\n", wifiStatus.ssidToTry, status); 
             WiFi.disconnect(true); 
-            responseDoc["success"] = false;
-            responseDoc["message"] = "Failed to connect to " + wifiStatus.ssidToTry + " (Timeout, Status: " + String(status) + ")";
+            snprintf(message, sizeof(message), "Failed to connect to %s (Timeout, Status: %d)", wifiStatus.ssidToTry, status);
             wifiStatus.connectProgress = WIFI_CP_FAILED;
             sendUpdateToClient = true;
         } else if (status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED || status == WL_CONNECTION_LOST) { 
-            P_PRINTF("[WIFI_PROC] 连接失败: SSID=%s. WiFi Status: %d\n", wifiStatus.ssidToTry.c_str(), status);
+            P_PRINTF("[WIFI_PROC] 连接失败: SSID=%s. WiFi Status: %d\n", wifiStatus.ssidToTry, status);
             WiFi.disconnect(true); 
-            responseDoc["success"] = false;
-            responseDoc["message"] = "Failed to connect to " + wifiStatus.ssidToTry + " (Error, Status: " + String(status) + ")";
+            snprintf(message, sizeof(message), "Failed to connect to %s (Error, Status: %d)", wifiStatus.ssidToTry, status);
             wifiStatus.connectProgress = WIFI_CP_FAILED;
             sendUpdateToClient = true;
         }
         
         if (sendUpdateToClient) {
             if (wifiStatus.connectInitiatorClientNum != 255 && wifiStatus.connectInitiatorClientNum < webSocket.connectedClients()) {
-                String responseStr;
-                serializeJson(responseDoc, responseStr);
-                webSocket.sendTXT(wifiStatus.connectInitiatorClientNum, responseStr);
+                WsMessage msg;
+                if (msg.valid()) {
+                    JsonDocument& responseDoc = msg.doc();
+                    responseDoc["type"] = "connectWifiStatus";
+                    responseDoc["success"] = success;
+                    responseDoc["message"] = message;
+                    if (success) {
+                        char ip[16];
+                        formatIp(WiFi.localIP(), ip);
+                        responseDoc["ip"] = ip;
+                    }
+                    msg.sendTo(wifiStatus.connectInitiatorClientNum);
+                }
             }
             sendWifiStatusToClients(wifiStatus); 
             wifiStatus.connectInitiatorClientNum = 255; 
@@ -245,14 +638,14 @@ void processWifiScanResults(WifiState& wifiStatus) {
             P_PRINTLN("[WIFI_SCAN_PROC] 扫描超时!");
             WiFi.scanDelete();
             wifiStatus.isScanning = false;
-            DynamicJsonDocument scanTimeoutDoc(128);
-            scanTimeoutDoc["type"] = "wifiScanResults";
-            scanTimeoutDoc["error"] = "Scan timed out.";
-            scanTimeoutDoc.createNestedArray("networks");
-            String timeoutStr;
-            serializeJson(scanTimeoutDoc, timeoutStr);
             if (wifiStatus.scanRequesterClientNum != 255 && wifiStatus.scanRequesterClientNum < webSocket.connectedClients()) {
-                webSocket.sendTXT(wifiStatus.scanRequesterClientNum, timeoutStr);
+                WsMessage msg;
+                if (msg.valid()) {
+                    msg.doc()["type"] = "wifiScanResults";
+                    msg.doc()["error"] = "Scan timed out.";
+                    msg.doc().createNestedArray("networks");
+                    msg.sendTo(wifiStatus.scanRequesterClientNum);
+                }
             }
             wifiStatus.scanRequesterClientNum = 255;
         }
@@ -260,25 +653,26 @@ void processWifiScanResults(WifiState& wifiStatus) {
     }
     P_PRINTF("[WIFI_SCAN_PROC] 异步扫描完成. 结果: %d\n", scanResult);
     wifiStatus.isScanning = false;
-    DynamicJsonDocument doc(scanResult > 0 ? JSON_ARRAY_SIZE(scanResult) + scanResult * JSON_OBJECT_SIZE(3) + 256 : 256);
-    doc["type"] = "wifiScanResults";
-    JsonArray networks = doc.createNestedArray("networks");
-    if (scanResult > 0) {
-        for (int i = 0; i < scanResult; ++i) {
-            JsonObject net = networks.createNestedObject();
-            net["ssid"] = WiFi.SSID(i);
-            net["rssi"] = WiFi.RSSI(i);
-        }
-    } else if (scanResult == WIFI_SCAN_FAILED) {
-         doc["error"] = "Scan failed.";
-         P_PRINTLN("[WIFI_SCAN_PROC] WiFi扫描失败.");
-    } else {
-         P_PRINTLN("[WIFI_SCAN_PROC] 未发现WiFi网络.");
+    if (scanResult == WIFI_SCAN_FAILED) {
+        P_PRINTLN("[WIFI_SCAN_PROC] WiFi扫描失败.");
+    } else if (scanResult <= 0) {
+        P_PRINTLN("[WIFI_SCAN_PROC] 未发现WiFi网络.");
     }
-    String responseStr;
-    serializeJson(doc, responseStr);
     if (wifiStatus.scanRequesterClientNum != 255 && wifiStatus.scanRequesterClientNum < webSocket.connectedClients()) {
-        webSocket.sendTXT(wifiStatus.scanRequesterClientNum, responseStr);
+        WsMessage msg;
+        if (msg.valid()) {
+            JsonDocument& doc = msg.doc();
+            doc["type"] = "wifiScanResults";
+            JsonArray networks = doc.createNestedArray("networks");
+            // 网络数量超出文档容量时只发送前面 (信号较强) 的部分
+            for (int i = 0; i < scanResult && i < WIFI_SCAN_MAX_RESULTS; ++i) {
+                JsonObject net = networks.createNestedObject();
+                net["ssid"] = WiFi.SSID(i);
+                net["rssi"] = WiFi.RSSI(i);
+            }
+            if (scanResult == WIFI_SCAN_FAILED) doc["error"] = "Scan failed.";
+            msg.sendTo(wifiStatus.scanRequesterClientNum);
+        }
     }
     WiFi.scanDelete();
     wifiStatus.scanRequesterClientNum = 255;
@@ -288,53 +682,75 @@ void onWebSocketEvent(uint8_t clientNum, WStype_t type, uint8_t * payload, size_
     switch (type) {
         case WStype_DISCONNECTED:
             P_PRINTF("[%u] WebSocket已断开连接!\n", clientNum);
+            if (clientNum < WEBSOCKETS_SERVER_CLIENT_MAX) clientBinaryMode[clientNum] = false;
             if (wifiState.isScanning && wifiState.scanRequesterClientNum == clientNum) {
                 P_PRINTLN("[WIFI_SCAN] 请求扫描的客户端已断开，取消扫描结果发送。");
                 wifiState.scanRequesterClientNum = 255; 
             }
             break;
         case WStype_CONNECTED: {
-            IPAddress ip = webSocket.remoteIP(clientNum);
-            P_PRINTF("[%u] WebSocket已连接, IP: %s\n", clientNum, ip.toString().c_str());
+            char ip[16];
+            formatIp(webSocket.remoteIP(clientNum), ip);
+            P_PRINTF("[%u] WebSocket已连接, IP: %s\n", clientNum, ip);
+            if (clientNum < WEBSOCKETS_SERVER_CLIENT_MAX) clientBinaryMode[clientNum] = false;
+            resetWsClient(clientNum);
+            // 引导消息在源数据未变化时直接发送缓存的帧, 多个客户端同时连接不重复序列化
             sendWifiStatusToClients(wifiState, clientNum);
-            sendSensorDataToClients(currentState, clientNum);
-            sendHistoricalDataToClient(clientNum, historicalData);
+            DeviceState snapshot;
+            getDeviceStateSnapshot(snapshot);
+            sendSensorDataToClients(snapshot, clientNum);
+            sendHistoricalDataToClient(clientNum, TIER_RAW);
             sendCurrentSettingsToClient(clientNum, currentConfig);
             break;
         }
         case WStype_TEXT: {
             P_PRINTF("[%u] WS收到文本: %s\n", clientNum, (char *)payload);
-            DynamicJsonDocument doc(1024); 
-            DeserializationError error = deserializeJson(doc, payload, length);
-            DynamicJsonDocument responseDoc(512); 
+            static StaticJsonDocument<WS_REQUEST_DOC_SIZE> requestDoc; // 只在 loop 任务中使用
+            requestDoc.clear();
+            DeserializationError error = deserializeJson(requestDoc, payload, length);
+            WsMessage response;
+            if (!response.valid()) break;
             if (error) {
                 P_PRINTF("[%u] WS JSON解析失败: %s\n", clientNum, error.c_str());
-                responseDoc["type"] = "error";
-                responseDoc["message"] = "Invalid JSON payload.";
+                response.doc()["type"] = "error";
+                response.doc()["message"] = "Invalid JSON payload.";
             } else {
-                handleWebSocketMessage(clientNum, doc, responseDoc);
-            }
-            if (responseDoc.size() > 0) {
-                String responseStr;
-                serializeJson(responseDoc, responseStr);
-                webSocket.sendTXT(clientNum, responseStr);
+                handleWebSocketMessage(clientNum, requestDoc, response.doc());
             }
+            if (response.doc().size() > 0) response.sendTo(clientNum);
             break;
         }
         default: break;
     }
 }
 
-void setupWebSocketActions() {
-    wsActionHandlers["getCurrentSettings"] = handleGetCurrentSettingsRequest;
-    wsActionHandlers["getHistoricalData"] = handleGetHistoricalDataRequest;
-    wsActionHandlers["saveThresholds"] = handleSaveThresholdsRequest;
-    wsActionHandlers["saveLedBrightness"] = handleSaveLedBrightnessRequest;
-    wsActionHandlers["scanWifi"] = handleScanWifiRequest;
-    wsActionHandlers["connectWifi"] = handleConnectWifiRequest;
-    wsActionHandlers["resetSettings"] = handleResetSettingsRequest;
-    wsActionHandlers["startCalibration"] = handleStartCalibrationRequest; // 新增
-}
+// -- WebSocket action 表 --
+// 新增 action 只需在表中添加一项. 槽位表在编译期生成 (perfect_hash.h), 分派时不分配内存.
+
+struct WsAction {
+    const char* name;
+    WebSocketActionHandler handler;
+};
+
+static constexpr WsAction WS_ACTIONS[] = {
+    { "getCurrentSettings", handleGetCurrentSettingsRequest },
+    { "getHistoricalData",  handleGetHistoricalDataRequest },
+    { "saveThresholds",     handleSaveThresholdsRequest },
+    { "saveLedBrightness",  handleSaveLedBrightnessRequest },
+    { "scanWifi",           handleScanWifiRequest },
+    { "connectWifi",        handleConnectWifiRequest },
+    { "resetSettings",      handleResetSettingsRequest },
+    { "startCalibration",   handleStartCalibrationRequest },
+    { "setProtocol",        handleSetProtocolRequest },
+    { "getPerfStats",       handleGetPerfStatsRequest },
+    { "getHealth",          handleGetHealthRequest },
+    { "subscribe",          handleSubscribeRequest },
+    { "getClientStats",     handleGetClientStatsRequest },
+};
+
+static constexpr size_t WS_ACTION_SLOTS = phash::tableSize(sizeof(WS_ACTIONS) / sizeof(WS_ACTIONS[0]));
+static constexpr phash::SlotTable<WS_ACTION_SLOTS> wsActionSlots = phash::build<WS_ACTION_SLOTS>(WS_ACTIONS);
+static_assert(wsActionSlots.seed != phash::NO_SEED, "No perfect hash seed found for WS_ACTIONS (duplicate action name?)");
 
 void handleWebSocketMessage(uint8_t clientNum, const JsonDocument& doc, JsonDocument& responseDoc) {
     const char* action = doc["action"];
@@ -345,14 +761,15 @@ void handleWebSocketMessage(uint8_t clientNum, const JsonDocument& doc, JsonDocu
         return;
     }
     P_PRINTF("[%u] WS action: %s\n", clientNum, action);
-    String actionStr = String(action);
-    auto it = wsActionHandlers.find(actionStr);
-    if (it != wsActionHandlers.end()) {
-        it->second(clientNum, doc, responseDoc);
+    const WsAction* entry = phash::lookup(WS_ACTIONS, wsActionSlots, action);
+    if (entry) {
+        entry->handler(clientNum, doc, responseDoc);
     } else {
         P_PRINTF("[%u] 未知WS action: %s\n", clientNum, action);
+        char message[64];
+        snprintf(message, sizeof(message), "Unknown action: %s", action);
         responseDoc["type"] = "error";
-        responseDoc["message"] = "Unknown action: " + actionStr;
+        responseDoc["message"] = message;
     }
 }
 
@@ -361,7 +778,41 @@ void handleGetCurrentSettingsRequest(uint8_t clientNum, const JsonDocument& requ
     sendCurrentSettingsToClient(clientNum, currentConfig);
 }
 void handleGetHistoricalDataRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
-    sendHistoricalDataToClient(clientNum, historicalData);
+    const char* tierName = request["tier"] | "raw";
+    HistoryTier tier = TIER_RAW;
+    if (strcmp(tierName, "minute") == 0) tier = TIER_MINUTE;
+    else if (strcmp(tierName, "hour") == 0) tier = TIER_HOUR;
+
+    HistoryQuery query;
+    query.from = request["from"] | query.from;
+    query.to = request["to"] | query.to;
+    query.limit = request["limit"] | query.limit;
+    sendHistoricalDataToClient(clientNum, tier, query);
+}
+// 协商实时数据格式: 客户端声明支持的二进制帧版本, 版本一致时改为发送二进制帧
+void handleSetProtocolRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
+    bool wantBinary = request["binary"] | false;
+    int version = request["version"] | 0;
+    bool accepted = wantBinary && version == SENSOR_FRAME_VERSION && clientNum < WEBSOCKETS_SERVER_CLIENT_MAX;
+    if (clientNum < WEBSOCKETS_SERVER_CLIENT_MAX) clientBinaryMode[clientNum] = accepted;
+    P_PRINTF("[%u] 实时数据协议: %s\n", clientNum, accepted ? "二进制" : "JSON");
+    response["type"] = "protocolAck";
+    response["binary"] = accepted;
+    response["version"] = SENSOR_FRAME_VERSION;
+}
+// 返回各阶段耗时直方图; {"reset":true} 在发送后清零统计
+void handleGetPerfStatsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
+#if PERF_STATS_ENABLED
+    sendPerfStatsToClient(clientNum);
+    if (request["reset"] | false) perfReset();
+#else
+    response["type"] = "error";
+    response["message"] = "Perf stats are disabled in this build.";
+#endif
+}
+// 返回运行健康数据; {"history":true} 时附带采样历史
+void handleGetHealthRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
+    sendHealthToClient(clientNum, request["history"] | false);
 }
 void handleSaveThresholdsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
     currentConfig.thresholds.tempMin = request["tempMin"] | currentConfig.thresholds.tempMin;
@@ -372,8 +823,8 @@ void handleSaveThresholdsRequest(uint8_t clientNum, const JsonDocument& request,
     currentConfig.thresholds.no2PpmMax  = request["no2PpmMax"]  | currentConfig.thresholds.no2PpmMax;
     currentConfig.thresholds.c2h5ohPpmMax = request["c2h5ohPpmMax"] | currentConfig.thresholds.c2h5ohPpmMax;
     currentConfig.thresholds.vocPpmMax  = request["vocPpmMax"]  | currentConfig.thresholds.vocPpmMax;
+    publishAlarmThresholds(currentConfig.thresholds); // 在采样任务的下一次警报检查中生效
     saveConfig(currentConfig);
-    checkAlarms(currentState, currentConfig);
     response["type"] = "saveSettingsStatus";
     response["success"] = true;
     response["message"] = "Thresholds saved.";
@@ -405,21 +856,29 @@ void handleConnectWifiRequest(uint8_t clientNum, const JsonDocument& request, Js
         response["success"] = false;
         response["message"] = "Connection attempt already in progress.";
     } else {
-        wifiState.ssidToTry = request["ssid"].as<String>();
-        wifiState.passwordToTry = request["password"].as<String>();
-        P_PRINTF("[WIFI_CONN] 收到连接请求: SSID=%s\n", wifiState.ssidToTry.c_str());
-        if (wifiState.ssidToTry.length() == 0) {
+        const char* ssid = request["ssid"] | "";
+        const char* password = request["password"] | "";
+        P_PRINTF("[WIFI_CONN] 收到连接请求: SSID=%s\n", ssid);
+        if (ssid[0] == '\0') {
             response["type"] = "connectWifiStatus";
             response["success"] = false;
             response["message"] = "SSID cannot be empty.";
+        } else if (strlen(ssid) >= sizeof(wifiState.ssidToTry) || strlen(password) >= sizeof(wifiState.passwordToTry)) {
+            response["type"] = "connectWifiStatus";
+            response["success"] = false;
+            response["message"] = "SSID (max 32 bytes) or password (max 64 bytes) too long.";
         } else {
+            strlcpy(wifiState.ssidToTry, ssid, sizeof(wifiState.ssidToTry));
+            strlcpy(wifiState.passwordToTry, password, sizeof(wifiState.passwordToTry));
             wifiState.connectInitiatorClientNum = clientNum;
             wifiState.connectProgress = WIFI_CP_DISCONNECTING; 
             wifiState.connectAttemptStartTime = millis();
             WiFi.disconnect(true); 
             response["type"] = "connectWifiStatus"; 
             response["success"] = false; 
-            response["message"] = "Initiating connection to " + wifiState.ssidToTry + "...";
+            char message[64];
+            snprintf(message, sizeof(message), "Initiating connection to %s...", wifiState.ssidToTry);
+            response["message"] = message; // 非常量字符串, 复制进响应文档的内存池
         }
     }
 }
@@ -427,15 +886,23 @@ void handleConnectWifiRequest(uint8_t clientNum, const JsonDocument& request, Js
 void handleResetSettingsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
     P_PRINTLN("[RESET] 收到恢复出厂设置请求.");
     resetAllSettingsToDefault(currentConfig);
+    publishSensorParams(currentConfig);
     saveConfig(currentConfig);
+    flushConfig(); // 即将重启, 不等待去抖
     historicalData.clear();
-    saveHistoricalDataToFile(historicalData);
-    response["type"] = "resetStatus";
-    response["success"] = true;
-    response["message"] = "Settings reset. Device will restart.";
-    String respStr;
-    serializeJson(response, respStr);
-    webSocket.sendTXT(clientNum, respStr);
+    clearHistoricalDataLog();
+    clearRollupHistory();
+    if (!storageFlush(STORAGE_FLUSH_TIMEOUT_MS)) {
+        P_PRINTLN("[RESET] 等待存储作业完成超时.");
+    }
+    // 重启前直接发送, 不经过请求处理结束后的统一响应
+    WsMessage reply;
+    if (reply.valid()) {
+        reply.doc()["type"] = "resetStatus";
+        reply.doc()["success"] = true;
+        reply.doc()["message"] = "Settings reset. Device will restart.";
+        reply.sendTo(clientNum);
+    }
     P_PRINTLN("[RESET] 设置已重置, 准备重启...");
     delay(1000);
     ESP.restart();
@@ -450,97 +917,463 @@ void handleStartCalibrationRequest(uint8_t clientNum, const JsonDocument& reques
     response["message"] = "Calibration process initiated.";
 }
 
-void sendSensorDataToClients(const DeviceState& state, uint8_t specificClientNum) {
-    DynamicJsonDocument doc(1024); 
-    doc["type"] = "sensorData";
+// ==========================================================================
+// == 实时数据按变化上报 ==
+// ==========================================================================
 
-    if (isnan(state.temperature)) doc["temperature"] = nullptr; else doc["temperature"] = state.temperature;
-    if (isnan(state.humidity)) doc["humidity"] = nullptr; else doc["humidity"] = state.humidity;
-    
-    JsonObject gas = doc.createNestedObject("gasPpm");
-    if (isnan(state.gasPpmValues.co)) gas["co"] = nullptr; else gas["co"] = state.gasPpmValues.co;
-    if (isnan(state.gasPpmValues.no2)) gas["no2"] = nullptr; else gas["no2"] = state.gasPpmValues.no2;
-    if (isnan(state.gasPpmValues.c2h5oh)) gas["c2h5oh"] = nullptr; else gas["c2h5oh"] = state.gasPpmValues.c2h5oh;
-    if (isnan(state.gasPpmValues.voc)) gas["voc"] = nullptr; else gas["voc"] = state.gasPpmValues.voc;
-
-    doc["tempStatus"] = getSensorStatusString(state.tempStatus);
-    doc["humStatus"]  = getSensorStatusString(state.humStatus);
-    doc["gasCoStatus"] = getSensorStatusString(state.gasCoStatus);
-    doc["gasNo2Status"] = getSensorStatusString(state.gasNo2Status);
-    doc["gasC2h5ohStatus"] = getSensorStatusString(state.gasC2h5ohStatus);
-    doc["gasVocStatus"] = getSensorStatusString(state.gasVocStatus);
-    doc["timeIsRelative"] = !ntpSynced;
+// 最近一次发给客户端的数值 (所有客户端看到的都是这份快照)
+static DeviceState liveSnapshot;
+static bool liveSnapshotValid = false;
+static uint32_t liveSnapshotRevision = 0;  // 快照每次变化加一, 用于缓存的 JSON 关键帧
+static unsigned long lastKeyframeTime = 0;
+
+static bool exceedsDeadband(float last, float current, float deadband) {
+    if (isnan(last) || isnan(current)) return isnan(last) != isnan(current);
+    return fabsf(current - last) >= deadband;
+}
+
+// 将超出死区的字段写入快照, 返回变化位
+static uint8_t updateLiveSnapshot(const DeviceState& state) {
+    uint8_t changed = 0;
+    if (abs(state.temperature - liveSnapshot.temperature) >= LIVE_DEADBAND_TEMP_C) {
+        liveSnapshot.temperature = state.temperature; changed |= LF_TEMP;
+    }
+    if (exceedsDeadband(liveSnapshot.humidity, state.humidity, LIVE_DEADBAND_HUM_PCT)) {
+        liveSnapshot.humidity = state.humidity; changed |= LF_HUM;
+    }
+    if (exceedsDeadband(liveSnapshot.gasPpmValues.co, state.gasPpmValues.co, LIVE_DEADBAND_CO_PPM)) {
+        liveSnapshot.gasPpmValues.co = state.gasPpmValues.co; changed |= LF_CO;
+    }
+    if (exceedsDeadband(liveSnapshot.gasPpmValues.no2, state.gasPpmValues.no2, LIVE_DEADBAND_NO2_PPM)) {
+        liveSnapshot.gasPpmValues.no2 = state.gasPpmValues.no2; changed |= LF_NO2;
+    }
+    if (exceedsDeadband(liveSnapshot.gasPpmValues.c2h5oh, state.gasPpmValues.c2h5oh, LIVE_DEADBAND_C2H5OH_PPM)) {
+        liveSnapshot.gasPpmValues.c2h5oh = state.gasPpmValues.c2h5oh; changed |= LF_C2H5OH;
+    }
+    if (exceedsDeadband(liveSnapshot.gasPpmValues.voc, state.gasPpmValues.voc, LIVE_DEADBAND_VOC_PPM)) {
+        liveSnapshot.gasPpmValues.voc = state.gasPpmValues.voc; changed |= LF_VOC;
+    }
+    if (state.tempStatus != liveSnapshot.tempStatus || state.humStatus != liveSnapshot.humStatus ||
+        state.gasCoStatus != liveSnapshot.gasCoStatus || state.gasNo2Status != liveSnapshot.gasNo2Status ||
+        state.gasC2h5ohStatus != liveSnapshot.gasC2h5ohStatus || state.gasVocStatus != liveSnapshot.gasVocStatus) {
+        liveSnapshot.tempStatus = state.tempStatus;
+        liveSnapshot.humStatus = state.humStatus;
+        liveSnapshot.gasCoStatus = state.gasCoStatus;
+        liveSnapshot.gasNo2Status = state.gasNo2Status;
+        liveSnapshot.gasC2h5ohStatus = state.gasC2h5ohStatus;
+        liveSnapshot.gasVocStatus = state.gasVocStatus;
+        changed |= LF_STATUS;
+    }
+    if (changed) liveSnapshotRevision++;
+    return changed;
+}
+
+// 快照的时间标签: 发布时取一次, 同一次发布的各种编码共用
+struct LiveLabel {
+    bool timeIsRelative;
+    uint32_t timestamp;
+    uint32_t labelSeconds;
     char timeStr[12];
+};
+
+static void captureLiveLabel(LiveLabel& label) {
+    label.timeIsRelative = !ntpSynced;
     if (ntpSynced) {
         struct timeval tv;
         gettimeofday(&tv, NULL);
-        generateTimeStr(tv.tv_sec, false, timeStr);
+        generateTimeStr(tv.tv_sec, false, label.timeStr);
+        time_t now = tv.tv_sec;
+        struct tm* p_tm = localtime(&now);
+        label.timestamp = tv.tv_sec;
+        label.labelSeconds = p_tm ? (p_tm->tm_hour * 3600UL + p_tm->tm_min * 60UL + p_tm->tm_sec) : 0;
     } else {
-        generateTimeStr(millis(), true, timeStr);
+        unsigned long nowMs = millis();
+        generateTimeStr(nowMs, true, label.timeStr);
+        label.timestamp = nowMs;
+        label.labelSeconds = nowMs / 1000;
     }
-    doc["timeStr"] = timeStr;
-    String jsonString;
-    serializeJson(doc, jsonString);
-    if (specificClientNum != 255 && specificClientNum < webSocket.connectedClients()) webSocket.sendTXT(specificClientNum, jsonString);
-    else webSocket.broadcastTXT(jsonString);
 }
 
-void sendWifiStatusToClients(const WifiState& currentWifiState, uint8_t specificClientNum) {
-    DynamicJsonDocument doc(512);
+// JSON 关键帧按 (快照版本, 时间标签所在秒) 缓存, 同一秒内的新客户端和落后的订阅者共用
+static bool ensureSensorKeyframe(const LiveLabel& label) {
+    const uint64_t version = ((uint64_t)liveSnapshotRevision << 32) | (label.timeIsRelative ? label.timestamp / 1000 : label.timestamp);
+    if (cachedFrameIsCurrent(sensorKeyframe, version)) return true;
+    WsMessage json;
+    if (!json.valid()) return false;
+    buildSensorDataJson(liveSnapshot, LF_ALL, label.timeIsRelative, label.timeStr, json.doc());
+    return storeCachedFrame(sensorKeyframe, json.doc(), version);
+}
+
+// sensor 主题最近一次发布的内容: 二进制完整帧 (前部预留帧头), 以及增量发布时的 JSON 增量帧
+static LiveLabel sensorPublishLabel;
+static uint8_t sensorBinaryFrame[WEBSOCKETS_MAX_HEADER_SIZE + SENSOR_FRAME_SIZE];
+static CachedFrame<WS_CACHED_FRAME_SIZE> sensorDeltaFrame;
+static bool sensorPublishWasDelta = false;
+
+static void publishLiveSnapshot(uint8_t fields) {
+    captureLiveLabel(sensorPublishLabel);
+    const LiveLabel& label = sensorPublishLabel;
+    encodeSensorFrame(liveSnapshot, label.timeIsRelative, label.timestamp, label.labelSeconds, sensorBinaryFrame + WEBSOCKETS_MAX_HEADER_SIZE);
+    sensorPublishWasDelta = (fields != LF_ALL);
+    sensorDeltaFrame.valid = false;
+    if (sensorPublishWasDelta) {
+        // 增量只对收到了上一次发布的 JSON 订阅者有效, 没有 JSON 订阅者时不编码
+        bool jsonSubscriber = false;
+        for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX && !jsonSubscriber; num++) {
+            jsonSubscriber = !clientBinaryMode[num] && wsClients[num].topics[TOPIC_SENSOR].intervalMs != WS_TOPIC_OFF &&
+                             webSocket.clientIsConnected(num);
+        }
+        WsMessage json;
+        if (jsonSubscriber && json.valid()) {
+            buildSensorDataJson(liveSnapshot, fields, label.timeIsRelative, label.timeStr, json.doc());
+            storeCachedFrame(sensorDeltaFrame, json.doc(), 0);
+        }
+    }
+    topicSeq[TOPIC_SENSOR]++;
+}
+
+// 按客户端协商的协议发送 sensor 主题的最新一帧: 二进制客户端收到完整帧;
+// JSON 客户端收到了上一次发布时发送增量, 否则 (新订阅或跳过了帧) 发送关键帧.
+static bool sendSensorTopicFrame(uint8_t clientNum, uint32_t lastSeq) {
+    if (clientBinaryMode[clientNum]) {
+        return webSocket.sendBIN(clientNum, sensorBinaryFrame, SENSOR_FRAME_SIZE, true);
+    }
+    if (sensorPublishWasDelta && sensorDeltaFrame.valid && lastSeq != 0 && lastSeq + 1 == topicSeq[TOPIC_SENSOR]) {
+        return sendCachedFrame(sensorDeltaFrame, clientNum);
+    }
+    return ensureSensorKeyframe(sensorPublishLabel) && sendCachedFrame(sensorKeyframe, clientNum);
+}
+
+// 广播 (specificClientNum 为 255) 时发布到 sensor 主题; 发给单个客户端时按其协议直接发送完整快照.
+static void sendLiveSnapshot(uint8_t fields, uint8_t specificClientNum) {
+    if (specificClientNum == 255) {
+        publishLiveSnapshot(fields);
+        return;
+    }
+    if (!webSocket.clientIsConnected(specificClientNum)) return;
+    LiveLabel label;
+    captureLiveLabel(label);
+    if (clientBinaryMode[specificClientNum]) {
+        uint8_t frame[SENSOR_FRAME_SIZE];
+        encodeSensorFrame(liveSnapshot, label.timeIsRelative, label.timestamp, label.labelSeconds, frame);
+        webSocket.sendBIN(specificClientNum, frame, SENSOR_FRAME_SIZE);
+    } else if (ensureSensorKeyframe(label)) {
+        sendCachedFrame(sensorKeyframe, specificClientNum);
+    }
+}
+
+// 完整关键帧. 广播时以当前状态重置快照; 发给单个新客户端时发送其他客户端正在显示的快照.
+void sendSensorDataToClients(const DeviceState& state, uint8_t specificClientNum) {
+    if (specificClientNum == 255 || !liveSnapshotValid) {
+        liveSnapshot = state;
+        liveSnapshotValid = true;
+        liveSnapshotRevision++;
+    }
+    if (specificClientNum == 255) lastKeyframeTime = millis();
+    sendLiveSnapshot(LF_ALL, specificClientNum);
+}
+
+bool sendSensorDataChanges(const DeviceState& state) {
+    if (!liveSnapshotValid || millis() - lastKeyframeTime >= LIVE_KEYFRAME_INTERVAL_MS) {
+        sendSensorDataToClients(state);
+        return true;
+    }
+    uint8_t changed = updateLiveSnapshot(state);
+    if (changed == 0) return false;
+    sendLiveSnapshot(changed, 255);
+    return true;
+}
+
+// WiFi 状态中决定客户端显示内容的部分, 用于只在状态转换时广播
+struct WifiStatusSnapshot {
+    bool connected;
+    uint32_t ip;
+    uint8_t mode;
+    WifiConnectProgress connectProgress;
+    bool ntpSynced;
+};
+static WifiStatusSnapshot lastWifiStatusSent;
+static bool wifiStatusSentValid = false;
+
+static WifiStatusSnapshot captureWifiStatus(const WifiState& currentWifiState) {
+    WifiStatusSnapshot snap;
+    snap.connected = WiFi.isConnected();
+    snap.ip = snap.connected ? (uint32_t)WiFi.localIP() : 0;
+    snap.mode = (uint8_t)WiFi.getMode();
+    snap.connectProgress = currentWifiState.connectProgress;
+    snap.ntpSynced = ntpSynced;
+    return snap;
+}
+
+static bool sameWifiStatus(const WifiStatusSnapshot& a, const WifiStatusSnapshot& b) {
+    return a.connected == b.connected && a.ip == b.ip && a.mode == b.mode &&
+           a.connectProgress == b.connectProgress && a.ntpSynced == b.ntpSynced;
+}
+
+// 缓存的 WiFi 状态帧对应的状态 (连接请求总会改变 connectProgress, 因此也覆盖 SSID 的变化)
+static WifiStatusSnapshot wifiStatusFrameSource;
+
+bool sendWifiStatusChanges(const WifiState& currentWifiState) {
+    WifiStatusSnapshot snap = captureWifiStatus(currentWifiState);
+    if (wifiStatusSentValid && sameWifiStatus(snap, lastWifiStatusSent)) {
+        return false;
+    }
+    sendWifiStatusToClients(currentWifiState);
+    return true;
+}
+
+static void buildWifiStatusJson(const WifiState& currentWifiState, JsonDocument& doc) {
+    char ip[16];
     doc["type"] = "wifiStatus";
     if (WiFi.isConnected()) {
-        doc["connected"] = true; doc["ssid"] = WiFi.SSID(); doc["ip"] = WiFi.localIP().toString();
+        formatIp(WiFi.localIP(), ip);
+        doc["connected"] = true; doc["ssid"] = WiFi.SSID(); doc["ip"] = ip;
     } else {
         doc["connected"] = false; doc["ssid"] = "N/A";
         if (WiFi.getMode() == WIFI_AP || WiFi.getMode() == WIFI_AP_STA) {
-             doc["ip"] = WiFi.softAPIP().toString(); doc["ap_mode"] = true; doc["ap_ssid"] = WIFI_AP_SSID;
+             formatIp(WiFi.softAPIP(), ip);
+             doc["ip"] = ip; doc["ap_mode"] = true; doc["ap_ssid"] = WIFI_AP_SSID;
         } else { doc["ip"] = "N/A"; }
     }
-    doc["connecting_attempt_ssid"] = (currentWifiState.connectProgress == WIFI_CP_CONNECTING || currentWifiState.connectProgress == WIFI_CP_DISCONNECTING) ? currentWifiState.ssidToTry : "";
+    const bool attempting = (currentWifiState.connectProgress == WIFI_CP_CONNECTING || currentWifiState.connectProgress == WIFI_CP_DISCONNECTING);
+    doc["connecting_attempt_ssid"] = attempting ? currentWifiState.ssidToTry : "";
     doc["connection_failed"] = (currentWifiState.connectProgress == WIFI_CP_FAILED);
     doc["ntp_synced"] = ntpSynced;
-    String jsonString;
-    serializeJson(doc, jsonString);
-    if (specificClientNum != 255 && specificClientNum < webSocket.connectedClients()) webSocket.sendTXT(specificClientNum, jsonString);
-    else webSocket.broadcastTXT(jsonString);
 }
 
-void sendHistoricalDataToClient(uint8_t clientNum, const CircularBuffer& histBuffer) {
-    if (clientNum >= webSocket.connectedClients()) return;
-    const std::vector<SensorDataPoint>& dataToSend = histBuffer.getData();
-    P_PRINTF("[HISTORY] 发送历史数据给客户端 %u (%u 条)\n", clientNum, dataToSend.size());
-    DynamicJsonDocument doc(min((size_t)(1024 * 16), (size_t)(JSON_ARRAY_SIZE(dataToSend.size()) + dataToSend.size() * JSON_OBJECT_SIZE(8)))); 
-    doc["type"] = "historicalData";
-    JsonArray historyArr = doc.createNestedArray("history");
-    for (const auto& dp : dataToSend) {
-        JsonObject dataPoint = historyArr.createNestedObject();
-        dataPoint["time"] = dp.timeStr;
-        dataPoint["rel"] = dp.isTimeRelative; 
-        
-        dataPoint["temp"] = dp.temp;
-        dataPoint["hum"] = dp.hum;
-        dataPoint["co"] = dp.gas.co;
-        dataPoint["no2"] = dp.gas.no2;
-        dataPoint["c2h5oh"] = dp.gas.c2h5oh;
-        dataPoint["voc"] = dp.gas.voc;
-    }
-    String jsonString;
-    if (serializeJson(doc, jsonString) > 0) {
-        webSocket.sendTXT(clientNum, jsonString);
+void sendWifiStatusToClients(const WifiState& currentWifiState, uint8_t specificClientNum) {
+    const WifiStatusSnapshot snap = captureWifiStatus(currentWifiState);
+    const uint8_t target = (specificClientNum != 255 && specificClientNum < webSocket.connectedClients()) ? specificClientNum : 255;
+    if (!wifiStatusFrame.valid || !sameWifiStatus(snap, wifiStatusFrameSource)) {
+        WsMessage msg;
+        if (!msg.valid()) return;
+        buildWifiStatusJson(currentWifiState, msg.doc());
+        wifiStatusFrameSource = snap;
+        if (!storeCachedFrame(wifiStatusFrame, msg.doc(), 0)) {
+            if (target == 255) msg.broadcast(); else msg.sendTo(target);
+        }
+    }
+    if (wifiStatusFrame.valid) {
+        if (target == 255) topicSeq[TOPIC_WIFI]++; // 广播改为发布, 由订阅发送
+        else sendCachedFrame(wifiStatusFrame, target);
+    }
+    if (target == 255) {
+        lastWifiStatusSent = snap;
+        wifiStatusSentValid = true;
+    }
+}
+
+// ==========================================================================
+// == 历史数据分块发送 ==
+// ==========================================================================
+
+// 块文档和输出缓冲区只在 loop 任务中使用, 静态分配后逐块复用, 不随历史长度占用堆内存
+static StaticJsonDocument<HISTORY_CHUNK_DOC_SIZE> historyChunkDoc;
+// 前部预留 WebSocket 帧头, 以 headerToPayload 方式发送
+static uint8_t historyChunkBuffer[WEBSOCKETS_MAX_HEADER_SIZE + HISTORY_CHUNK_BUFFER_SIZE];
+
+// 最近一次历史响应的全部块帧 (每块前部同样预留帧头). 历史版本和查询结果相同时
+// (页面加载时连接引导和页面请求的原始层历史即为同一结果) 直接重发, 不再序列化.
+// 生成响应时依次写入缓存区, 缓存区或块数不足 (如1小时层) 时本次响应不缓存.
+struct HistoryFrameCache {
+    bool valid;
+    bool recording;
+    uint32_t revision;
+    HistoryTier tier;
+    unsigned long from, to;
+    size_t count;            // 发送的点数: limit 不同但结果相同的请求共用缓存
+    size_t used;
+    uint8_t parts;
+    uint16_t offset[HISTORY_FRAME_CACHE_PARTS];
+    uint16_t length[HISTORY_FRAME_CACHE_PARTS];
+    uint8_t arena[HISTORY_FRAME_CACHE_SIZE];
+};
+static_assert(HISTORY_FRAME_CACHE_SIZE <= UINT16_MAX, "History frame cache offsets are 16-bit");
+
+static HistoryFrameCache historyCache;
+
+static bool historyCacheMatches(HistoryTier tier, const HistoryQuery& query, size_t count) {
+    return historyCache.valid && historyCache.revision == getHistoryRevision() && historyCache.tier == tier &&
+           historyCache.from == query.from && historyCache.to == query.to && historyCache.count == count;
+}
+
+static void historyCacheBegin(HistoryTier tier, const HistoryQuery& query, size_t count) {
+    historyCache.valid = false;
+    historyCache.recording = true;
+    historyCache.revision = getHistoryRevision();
+    historyCache.tier = tier;
+    historyCache.from = query.from;
+    historyCache.to = query.to;
+    historyCache.count = count;
+    historyCache.used = 0;
+    historyCache.parts = 0;
+}
+
+// 为下一块分配缓存空间 (帧头 + len 个字符 + 结尾0), 放不下时放弃本次缓存并返回 NULL
+static uint8_t* historyCacheReserve(size_t len) {
+    if (!historyCache.recording) return NULL;
+    const size_t need = WEBSOCKETS_MAX_HEADER_SIZE + len + 1;
+    if (historyCache.parts >= HISTORY_FRAME_CACHE_PARTS || historyCache.used + need > HISTORY_FRAME_CACHE_SIZE) {
+        historyCache.recording = false;
+        return NULL;
+    }
+    uint8_t* out = historyCache.arena + historyCache.used;
+    historyCache.offset[historyCache.parts] = historyCache.used;
+    historyCache.length[historyCache.parts] = len;
+    historyCache.parts++;
+    historyCache.used += need;
+    return out;
+}
+
+static void historyCacheEnd() {
+    historyCache.valid = historyCache.recording;
+    historyCache.recording = false;
+}
+
+static const char* historyTierName(HistoryTier tier) {
+    if (tier == TIER_MINUTE) return "minute";
+    if (tier == TIER_HOUR) return "hour";
+    return "raw";
+}
+
+// 聚合点的时间标签: 绝对时间带日期 (小时层跨越多天), 相对时间沿用运行时间格式
+static void generateRollupTimeStr(const RollupDataPoint& rp, char* buffer, size_t bufferLen) {
+    if (rp.isTimeRelative) {
+        generateTimeStr(rp.timestamp, true, buffer);
+        return;
+    }
+    time_t ts = rp.timestamp;
+    struct tm* p_tm = localtime(&ts);
+    if (p_tm) {
+        strftime(buffer, bufferLen, "%m-%d %H:%M", p_tm);
     } else {
-        P_PRINTLN("[HISTORY] 序列化历史数据失败 (可能JSON过大).");
-        DynamicJsonDocument errDoc(128); 
-        errDoc["type"] = "historicalData"; 
-        errDoc["error"] = "Failed to serialize history (too large).";
-        errDoc.createNestedArray("history");
-        String errStr; serializeJson(errDoc, errStr); webSocket.sendTXT(clientNum, errStr);
+        strcpy(buffer, "00-00 00:00");
     }
 }
 
-void sendCurrentSettingsToClient(uint8_t clientNum, const DeviceConfig& config) {
+static void addRollupChannel(JsonObject& obj, const char* key, const char* minKey, const char* maxKey,
+                             const RollupDataPoint& rp, RollupChannel ch) {
+    if (rp.count[ch] == 0) {
+        obj[key] = nullptr;
+        obj[minKey] = nullptr;
+        obj[maxKey] = nullptr;
+    } else {
+        obj[key] = rollupDecode(ch, rp.avg[ch]);
+        obj[minKey] = rollupDecode(ch, rp.min[ch]);
+        obj[maxKey] = rollupDecode(ch, rp.max[ch]);
+    }
+}
+
+static void writeHistoryPoint(JsonObject& dataPoint, const SensorDataPoint& dp) {
+    dataPoint["ts"] = dp.timestamp;
+    dataPoint["time"] = dp.timeStr;
+    dataPoint["rel"] = dp.isTimeRelative;
+    dataPoint["temp"] = dp.temp;
+    dataPoint["hum"] = dp.hum;
+    dataPoint["co"] = dp.gas.co;
+    dataPoint["no2"] = dp.gas.no2;
+    dataPoint["c2h5oh"] = dp.gas.c2h5oh;
+    dataPoint["voc"] = dp.gas.voc;
+}
+
+static void writeHistoryPoint(JsonObject& dataPoint, const RollupDataPoint& rp) {
+    char timeStr[16];
+    generateRollupTimeStr(rp, timeStr, sizeof(timeStr));
+    dataPoint["ts"] = rp.timestamp;
+    dataPoint["time"] = timeStr;
+    dataPoint["rel"] = rp.isTimeRelative;
+    uint8_t samples = 0;
+    for (int ch = 0; ch < RC_COUNT; ch++) samples = max(samples, rp.count[ch]);
+    dataPoint["n"] = samples; // 饱和于255
+    addRollupChannel(dataPoint, "temp", "tempMin", "tempMax", rp, RC_TEMP);
+    addRollupChannel(dataPoint, "hum", "humMin", "humMax", rp, RC_HUM);
+    addRollupChannel(dataPoint, "co", "coMin", "coMax", rp, RC_CO);
+    addRollupChannel(dataPoint, "no2", "no2Min", "no2Max", rp, RC_NO2);
+    addRollupChannel(dataPoint, "c2h5oh", "c2h5ohMin", "c2h5ohMax", rp, RC_C2H5OH);
+    addRollupChannel(dataPoint, "voc", "vocMin", "vocMax", rp, RC_VOC);
+}
+
+// 按 from/to 过滤, 只保留最新的 limit 个点, 每 pointsPerChunk 个点序列化为一条消息发送.
+// openPoint 为聚合层尚未结束的时间桶 (可为NULL), 视为最新的一个点.
+template <typename Point>
+static void streamHistoryChunks(uint8_t clientNum, HistoryTier tier, const RingView<Point>& points,
+                                const Point* openPoint, const HistoryQuery& query, size_t pointsPerChunk) {
+    const size_t total = points.size() + (openPoint ? 1 : 0);
+    size_t matched = 0;
+    for (size_t i = 0; i < total; i++) {
+        const Point& p = (i < points.size()) ? points[i] : *openPoint;
+        if (p.timestamp >= query.from && p.timestamp <= query.to) matched++;
+    }
+    size_t skip = (query.limit > 0 && matched > query.limit) ? matched - query.limit : 0;
+    const size_t toSend = matched - skip;
+    if (historyCacheMatches(tier, query, toSend)) {
+        P_PRINTF("[HISTORY] 发送缓存的%s历史数据给客户端 %u (%u 条, %u 块)\n", historyTierName(tier), clientNum, toSend, historyCache.parts);
+        for (uint8_t i = 0; i < historyCache.parts; i++) {
+            webSocket.sendTXT(clientNum, historyCache.arena + historyCache.offset[i], historyCache.length[i], true);
+        }
+        return;
+    }
+    P_PRINTF("[HISTORY] 发送%s历史数据给客户端 %u (%u/%u 条)\n", historyTierName(tier), clientNum, toSend, total);
+    historyCacheBegin(tier, query, toSend);
+
+    size_t index = 0, sent = 0;
+    int part = 0;
+    do {
+        historyChunkDoc.clear();
+        historyChunkDoc["type"] = "historicalData";
+        historyChunkDoc["tier"] = historyTierName(tier);
+        historyChunkDoc["part"] = part;
+        historyChunkDoc["total"] = toSend;
+        JsonArray historyArr = historyChunkDoc.createNestedArray("history");
+        size_t inChunk = 0;
+        for (; index < total && inChunk < pointsPerChunk; index++) {
+            const Point& p = (index < points.size()) ? points[index] : *openPoint;
+            if (p.timestamp < query.from || p.timestamp > query.to) continue;
+            if (skip > 0) { skip--; continue; }
+            JsonObject dataPoint = historyArr.createNestedObject();
+            writeHistoryPoint(dataPoint, p);
+            inChunk++;
+        }
+        sent += inChunk;
+        historyChunkDoc["final"] = (sent >= toSend);
+
+        size_t len = measureJson(historyChunkDoc);
+        if (historyChunkDoc.overflowed() || len >= HISTORY_CHUNK_BUFFER_SIZE) {
+            P_PRINTF("[HISTORY] 历史数据块 %d 超出缓冲区 (%u B), 停止发送.\n", part, len);
+            historyChunkDoc.clear();
+            historyChunkDoc["type"] = "historicalData";
+            historyChunkDoc["tier"] = historyTierName(tier);
+            historyChunkDoc["part"] = part;
+            historyChunkDoc["final"] = true;
+            historyChunkDoc["error"] = "History chunk too large.";
+            historyChunkDoc.createNestedArray("history");
+            len = measureJson(historyChunkDoc);
+            sent = toSend;
+        }
+        uint8_t* out = historyCacheReserve(len);
+        if (out) {
+            serializeJson(historyChunkDoc, (char*)out + WEBSOCKETS_MAX_HEADER_SIZE, len + 1);
+        } else {
+            out = historyChunkBuffer;
+            serializeJson(historyChunkDoc, (char*)out + WEBSOCKETS_MAX_HEADER_SIZE, HISTORY_CHUNK_BUFFER_SIZE);
+        }
+        webSocket.sendTXT(clientNum, out, len, true);
+        part++;
+    } while (sent < toSend);
+    historyCacheEnd();
+}
+
+void sendHistoricalDataToClient(uint8_t clientNum, HistoryTier tier, const HistoryQuery& query) {
     if (clientNum >= webSocket.connectedClients()) return;
-    P_PRINTF("[SETTINGS] 发送当前设置给客户端 %u\n", clientNum);
-    DynamicJsonDocument doc(2048); 
+    if (tier == TIER_RAW) {
+        streamHistoryChunks<SensorDataPoint>(clientNum, tier, historicalData.view(), NULL, query, HISTORY_CHUNK_RAW_POINTS);
+    } else {
+        const RingView<RollupDataPoint> buffer = (tier == TIER_HOUR) ? hourRollups.view() : minuteRollups.view();
+        streamHistoryChunks<RollupDataPoint>(clientNum, tier, buffer, getOpenRollup(tier), query, HISTORY_CHUNK_ROLLUP_POINTS);
+    }
+}
+
+static void buildSettingsJson(const DeviceConfig& config, JsonDocument& doc) {
     doc["type"] = "settingsData";
     JsonObject settingsObj = doc.createNestedObject("settings");
     JsonObject thresholdsObj = settingsObj.createNestedObject("thresholds");
@@ -560,21 +1393,184 @@ void sendCurrentSettingsToClient(uint8_t clientNum, const DeviceConfig& config)
     r0Obj["c2h5oh"] = config.r0Values.c2h5oh;
     r0Obj["voc"] = config.r0Values.voc;
 
+    // 基线跟踪相对校准值的累计漂移 (%)
+    JsonObject driftObj = settingsObj.createNestedObject("r0Drift");
+    driftObj["co"] = (config.r0Values.co / config.r0Calibrated.co - 1.0f) * 100.0f;
+    driftObj["no2"] = (config.r0Values.no2 / config.r0Calibrated.no2 - 1.0f) * 100.0f;
+    driftObj["c2h5oh"] = (config.r0Values.c2h5oh / config.r0Calibrated.c2h5oh - 1.0f) * 100.0f;
+    driftObj["voc"] = (config.r0Values.voc / config.r0Calibrated.voc - 1.0f) * 100.0f;
+
     settingsObj["currentSSID"] = WiFi.isConnected() ? WiFi.SSID() : config.currentSsidForSettings;
     settingsObj["ledBrightness"] = config.ledBrightness;
-    String jsonString;
-    serializeJson(doc, jsonString);
-    webSocket.sendTXT(clientNum, jsonString);
+}
+
+// 设置帧的版本: 配置修订号 (每次 saveConfig) + R0 修订号 (采样任务修改 R0, 保存前) + 是否已连接 WiFi
+static uint64_t settingsFrameVersion() {
+    return ((uint64_t)getConfigRevision() << 32) | ((uint64_t)getR0Revision() << 1) | (WiFi.isConnected() ? 1 : 0);
+}
+
+void sendCurrentSettingsToClient(uint8_t clientNum, const DeviceConfig& config) {
+    if (clientNum >= webSocket.connectedClients()) return;
+    P_PRINTF("[SETTINGS] 发送当前设置给客户端 %u\n", clientNum);
+    const uint64_t version = settingsFrameVersion();
+    if (!cachedFrameIsCurrent(settingsFrame, version)) {
+        WsMessage msg;
+        if (!msg.valid()) return;
+        buildSettingsJson(config, msg.doc());
+        if (!storeCachedFrame(settingsFrame, msg.doc(), version)) {
+            msg.sendTo(clientNum);
+            return;
+        }
+    }
+    sendCachedFrame(settingsFrame, clientNum);
+}
+
+#if PERF_STATS_ENABLED
+static void buildPerfStatsJson(JsonDocument& doc) {
+    doc["type"] = "perfStats";
+    doc["uptimeMs"] = millis();
+    doc["cpuMhz"] = ESP.getCpuFreqMHz();
+    JsonArray stages = doc.createNestedArray("stages");
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        PerfStageStats s;
+        perfGetStage((PerfStage)i, s);
+        JsonObject stage = stages.createNestedObject();
+        stage["name"] = perfStageName((PerfStage)i);
+        stage["count"] = s.count;
+        stage["avgUs"] = s.count ? (uint32_t)(s.totalUs / s.count) : 0;
+        stage["maxUs"] = s.maxUs;
+        stage["p50Us"] = perfPercentileUs(s, 0.5f);
+        stage["p99Us"] = perfPercentileUs(s, 0.99f);
+        // 直方图: 下标 i 为 [2^(i-1), 2^i) us 的次数, 省略末尾的空桶
+        uint8_t used = PERF_BUCKET_COUNT;
+        while (used > 0 && s.buckets[used - 1] == 0) used--;
+        JsonArray hist = stage.createNestedArray("hist");
+        for (uint8_t b = 0; b < used; b++) hist.add(s.buckets[b]);
+    }
+}
+
+// 重新生成 perf 主题的帧, 超出帧缓冲区时返回 false
+static bool refreshPerfFrame() {
+    perfDoc.clear();
+    buildPerfStatsJson(perfDoc);
+    return storeCachedFrame(perfFrame, perfDoc, 0);
+}
+
+// 复用 perf 主题的帧缓冲区, 不改变主题序号: 尚未收到当前帧的订阅者会收到这次更新的数据
+void sendPerfStatsToClient(uint8_t clientNum) {
+    if (!webSocket.clientIsConnected(clientNum)) return;
+    if (refreshPerfFrame()) sendCachedFrame(perfFrame, clientNum);
+    else P_PRINTLN("[PERF] 统计数据超出帧缓冲区, 未发送.");
+}
+#endif
+
+// -- 运行健康数据 --
+// 最新一次采样 + 存储队列和气体传感器总线统计; withHistory 时按列附带全部采样历史
+
+void buildHealthJson(JsonDocument& doc, bool withHistory) {
+    doc["type"] = "health";
+    doc["uptimeS"] = millis() / 1000;
+
+    const uint8_t taskCount = healthTaskCount();
+    HealthSample latest;
+    if (healthGetLatest(latest)) {
+        JsonObject heap = doc.createNestedObject("heap");
+        heap["free"] = latest.freeHeap;
+        heap["minFree"] = latest.minFreeHeap;
+        heap["largestBlock"] = latest.largestFreeBlock;
+        heap["fragmentationPct"] = latest.fragmentationPct;
+        heap["sampledAtS"] = latest.uptimeS;
+
+        JsonArray tasks = doc.createNestedArray("tasks");
+        for (uint8_t i = 0; i < taskCount; i++) {
+            JsonObject task = tasks.createNestedObject();
+            task["name"] = healthTaskName(i);
+            if (healthTaskStackSize(i)) task["stackSize"] = healthTaskStackSize(i);
+            task["stackFree"] = latest.stackFree[i];
+            if (latest.cpuPermille[i] >= 0) task["cpuPct"] = latest.cpuPermille[i] / 10.0f;
+            else task["cpuPct"] = nullptr;
+        }
+    }
+
+    StorageStats storage = getStorageStats();
+    JsonObject storageObj = doc.createNestedObject("storage");
+    storageObj["queueDepth"] = storage.queueDepth;
+    storageObj["maxQueueDepth"] = storage.maxQueueDepth;
+    storageObj["submitted"] = storage.submitted;
+    storageObj["merged"] = storage.merged;
+    storageObj["dropped"] = storage.dropped;
+    storageObj["completed"] = storage.completed;
+    storageObj["avgLatencyUs"] = storage.completed ? (uint32_t)(storage.totalLatencyUs / storage.completed) : 0;
+    storageObj["maxLatencyUs"] = storage.maxLatencyUs;
+    storageObj["maxExecUs"] = storage.maxExecUs;
+
+    GasBusStats gas = getGasBusStats();
+    JsonObject gasObj = doc.createNestedObject("gasBus");
+    gasObj["present"] = gas.present;
+    gasObj["bursts"] = gas.bursts;
+    gasObj["failures"] = gas.failures;
+    gasObj["consecutiveFailures"] = gas.consecutiveFailures;
+    gasObj["avgBurstUs"] = gas.bursts ? (uint32_t)(gas.totalBurstUs / gas.bursts) : 0;
+    gasObj["maxBurstUs"] = gas.maxBurstUs;
+    gasObj["retryIntervalMs"] = gas.retryIntervalMs;
+
+    if (!withHistory) return;
+    JsonObject history = doc.createNestedObject("history");
+    JsonArray uptime = history.createNestedArray("uptimeS");
+    JsonArray freeHeap = history.createNestedArray("freeHeap");
+    JsonArray largest = history.createNestedArray("largestBlock");
+    JsonArray frag = history.createNestedArray("fragmentationPct");
+    JsonObject stackFree = history.createNestedObject("stackFree");
+    const size_t n = healthSampleCount();
+    HealthSample sample;
+    for (size_t k = 0; k < n && healthGetSample(k, sample); k++) {
+        uptime.add(sample.uptimeS);
+        freeHeap.add(sample.freeHeap);
+        largest.add(sample.largestFreeBlock);
+        frag.add(sample.fragmentationPct);
+        for (uint8_t i = 0; i < taskCount; i++) {
+            JsonArray column = stackFree[healthTaskName(i)];
+            if (column.isNull()) column = stackFree.createNestedArray(healthTaskName(i));
+            column.add(sample.stackFree[i]);
+        }
+    }
+}
+
+void sendHealthToClient(uint8_t clientNum, bool withHistory) {
+    if (!webSocket.clientIsConnected(clientNum)) return;
+    if (!withHistory) {
+        WsMessage msg;
+        if (!msg.valid()) return;
+        buildHealthJson(msg.doc(), false);
+        msg.sendTo(clientNum);
+        return;
+    }
+    // 采样历史较大, 使用与 /api/health 共用的静态缓冲区, 同步发送后立即释放
+    if (!acquireHealthBuffer()) {
+        WsMessage msg;
+        if (!msg.valid()) return;
+        msg.doc()["type"] = "error";
+        msg.doc()["message"] = "Health data busy, retry later.";
+        msg.sendTo(clientNum);
+        return;
+    }
+    const size_t len = serializeHealthJson(true);
+    if (len) webSocket.sendTXT(clientNum, healthFrame, len, true);
+    else P_PRINTLN("[HEALTH] 健康数据超出输出缓冲区, 未发送.");
+    releaseHealthBuffer();
 }
 
 // 新增: 发送校准状态
 void sendCalibrationStatusToClients(uint8_t specificClientNum) {
-    DynamicJsonDocument doc(1024);
+    WsMessage msg;
+    if (!msg.valid()) return;
+    JsonDocument& doc = msg.doc();
     doc["type"] = "calibrationStatusUpdate";
 
+    CalibrationStatus calibration = getCalibrationStatus();
     JsonObject calStatus = doc.createNestedObject("calibration");
-    calStatus["state"] = currentState.calibrationState; // 0: IDLE, 1: IN_PROGRESS, 2: COMPLETED, 3: FAILED
-    calStatus["progress"] = currentState.calibrationProgress;
+    calStatus["state"] = calibration.state; // 0: IDLE, 1: IN_PROGRESS, 2: COMPLETED, 3: FAILED
+    calStatus["progress"] = calibration.progress;
 
     JsonObject currentR0 = calStatus.createNestedObject("currentR0");
     currentR0["co"] = currentConfig.r0Values.co;
@@ -583,17 +1579,215 @@ void sendCalibrationStatusToClients(uint8_t specificClientNum) {
     currentR0["voc"] = currentConfig.r0Values.voc;
     
     JsonObject measuredR0 = calStatus.createNestedObject("measuredR0");
-    if (isnan(currentState.measuredR0.co)) measuredR0["co"] = nullptr; else measuredR0["co"] = currentState.measuredR0.co;
-    if (isnan(currentState.measuredR0.no2)) measuredR0["no2"] = nullptr; else measuredR0["no2"] = currentState.measuredR0.no2;
-    if (isnan(currentState.measuredR0.c2h5oh)) measuredR0["c2h5oh"] = nullptr; else measuredR0["c2h5oh"] = currentState.measuredR0.c2h5oh;
-    if (isnan(currentState.measuredR0.voc)) measuredR0["voc"] = nullptr; else measuredR0["voc"] = currentState.measuredR0.voc;
-
-    String jsonString;
-    serializeJson(doc, jsonString);
+    if (isnan(calibration.measuredR0.co)) measuredR0["co"] = nullptr; else measuredR0["co"] = calibration.measuredR0.co;
+    if (isnan(calibration.measuredR0.no2)) measuredR0["no2"] = nullptr; else measuredR0["no2"] = calibration.measuredR0.no2;
+    if (isnan(calibration.measuredR0.c2h5oh)) measuredR0["c2h5oh"] = nullptr; else measuredR0["c2h5oh"] = calibration.measuredR0.c2h5oh;
+    if (isnan(calibration.measuredR0.voc)) measuredR0["voc"] = nullptr; else measuredR0["voc"] = calibration.measuredR0.voc;
 
     if (specificClientNum != 255 && specificClientNum < webSocket.connectedClients()) {
-        webSocket.sendTXT(specificClientNum, jsonString);
+        msg.sendTo(specificClientNum);
+    } else if (storeCachedFrame(calibrationFrame, doc, 0)) {
+        topicSeq[TOPIC_CALIBRATION]++; // 广播改为发布, 由订阅发送
     } else {
-        webSocket.broadcastTXT(jsonString);
+        msg.broadcast();
     }
 }
+
+// ==========================================================================
+// == 订阅发送 ==
+// ==========================================================================
+
+// 按需生成的主题: 有订阅者时才编码
+static void refreshOnDemandTopics(unsigned long now) {
+    // historyTail: 原始历史新增点
+    static uint32_t historyTailRevision = 0;
+    const uint32_t revision = getHistoryRevision();
+    if (revision != historyTailRevision) {
+        historyTailRevision = revision;
+        WsMessage msg;
+        if (!historicalData.isEmpty() && topicHasSubscribers(TOPIC_HISTORY_TAIL) && msg.valid()) {
+            msg.doc()["type"] = "historyTail";
+            msg.doc()["tier"] = "raw";
+            JsonObject point = msg.doc().createNestedObject("point");
+            writeHistoryPoint(point, historicalData.newest());
+            if (storeCachedFrame(historyTailFrame, msg.doc(), 0)) topicSeq[TOPIC_HISTORY_TAIL]++;
+        }
+    }
+
+#if PERF_STATS_ENABLED
+    // perf: 有新订阅者, 或订阅者已收到当前帧且到期时重新生成
+    bool perfDue = false;
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX && !perfDue; num++) {
+        const WsClientTopic& ct = wsClients[num].topics[TOPIC_PERF];
+        perfDue = ct.intervalMs != WS_TOPIC_OFF && !wsClients[num].backoff && webSocket.clientIsConnected(num) &&
+                  (ct.lastSeq == 0 || (ct.lastSeq == topicSeq[TOPIC_PERF] && now - ct.lastSentTime >= ct.intervalMs));
+    }
+    if (perfDue && refreshPerfFrame()) topicSeq[TOPIC_PERF]++;
+#endif
+}
+
+// 帧在发布后被重建且未能缓存时 (超出容量) 跳过, 不视为客户端发送失败
+template <size_t SIZE>
+static bool sendPublishedFrame(CachedFrame<SIZE>& frame, uint8_t clientNum) {
+    return !frame.valid || sendCachedFrame(frame, clientNum);
+}
+
+// 发送失败 (连接已断开或写超时) 时返回 false
+static bool sendTopicFrame(WsTopic topic, uint8_t clientNum, uint32_t lastSeq) {
+    switch (topic) {
+        case TOPIC_SENSOR:       return sendSensorTopicFrame(clientNum, lastSeq);
+        case TOPIC_WIFI:         return sendPublishedFrame(wifiStatusFrame, clientNum);
+        case TOPIC_CALIBRATION:  return sendPublishedFrame(calibrationFrame, clientNum);
+        case TOPIC_HISTORY_TAIL: return sendPublishedFrame(historyTailFrame, clientNum);
+#if PERF_STATS_ENABLED
+        case TOPIC_PERF:         return sendPublishedFrame(perfFrame, clientNum);
+#endif
+        default:                 return false;
+    }
+}
+
+static bool wsTopicDue(const WsClientTopic& ct, uint8_t topic, unsigned long now) {
+    if (ct.intervalMs == WS_TOPIC_OFF || ct.lastSeq == topicSeq[topic]) return false;
+    return ct.lastSeq == 0 || now - ct.lastSentTime >= ct.intervalMs;
+}
+
+// 在 network_loop 中调用. 每次从不同的客户端开始, 慢客户端不总是排在前面
+void processWebSocketSubscriptions() {
+    const unsigned long now = millis();
+    refreshOnDemandTopics(now);
+
+    static uint8_t firstClient = 0;
+    for (uint8_t k = 0; k < WEBSOCKETS_SERVER_CLIENT_MAX; k++) {
+        const uint8_t num = (firstClient + k) % WEBSOCKETS_SERVER_CLIENT_MAX;
+        if (!webSocket.clientIsConnected(num)) continue;
+        WsClientState& c = wsClients[num];
+        if (c.backoff) {
+            if ((long)(now - c.backoffUntil) < 0) continue;
+            c.backoff = false;
+            for (uint8_t t = 0; t < TOPIC_COUNT; t++) accountSkippedFrames(c, t, true);
+        }
+        bool due = false;
+        for (uint8_t t = 0; t < TOPIC_COUNT && !due; t++) due = wsTopicDue(c.topics[t], t, now);
+        if (!due) continue;
+
+        // 写满发送缓冲区的客户端不发送 (否则阻塞整个循环), 待发帧留在队列中被新帧取代
+        if (!webSocket.clientWritable(num)) {
+            if (!c.congested) {
+                c.congested = true;
+                for (uint8_t t = 0; t < TOPIC_COUNT; t++) accountSkippedFrames(c, t, false);
+            }
+            c.busySkips++;
+            continue;
+        }
+        if (c.congested) {
+            c.congested = false;
+            for (uint8_t t = 0; t < TOPIC_COUNT; t++) accountSkippedFrames(c, t, true);
+        }
+
+        for (uint8_t t = 0; t < TOPIC_COUNT; t++) {
+            WsClientTopic& ct = c.topics[t];
+            if (!wsTopicDue(ct, t, now)) continue;
+
+            const uint32_t start = micros();
+            const bool ok = sendTopicFrame((WsTopic)t, num, ct.lastSeq);
+            const uint32_t elapsed = micros() - start;
+            accountSkippedFrames(c, t, false);
+            ct.lastSeq = topicSeq[t];
+            ct.accountedSeq = topicSeq[t];
+            ct.lastSentTime = now;
+            c.lastSendUs = elapsed;
+            if (elapsed > c.maxSendUs) c.maxSendUs = elapsed;
+            if (ok) c.sent++;
+            else c.dropped++;
+
+            if (!ok || elapsed > WS_SLOW_SEND_US) {
+                c.slowSends++;
+                c.backoff = true;
+                c.backoffUntil = now + WS_SLOW_BACKOFF_MS;
+                // 暂停前已被取代的帧属于订阅间隔合并; 暂停开始时待发的帧若在暂停期间被取代则计为丢弃
+                for (uint8_t u = 0; u < TOPIC_COUNT; u++) accountSkippedFrames(c, u, false);
+                P_PRINTF("[WS] 客户端 %u 发送%s (%lu us), 暂停 %d ms.\n", num, ok ? "缓慢" : "失败", (unsigned long)elapsed, WS_SLOW_BACKOFF_MS);
+                break;
+            }
+        }
+    }
+    firstClient = (firstClient + 1) % WEBSOCKETS_SERVER_CLIENT_MAX;
+}
+
+static void writeClientSubscriptions(JsonObject& topics, uint8_t clientNum) {
+    for (uint8_t t = 0; t < TOPIC_COUNT; t++) {
+        const uint32_t interval = wsClients[clientNum].topics[t].intervalMs;
+        if (interval == WS_TOPIC_OFF) topics[WS_TOPIC_NAMES[t]] = false;
+        else topics[WS_TOPIC_NAMES[t]] = interval;
+    }
+}
+
+// 各已连接客户端的待发帧数、发送/丢弃计数和订阅
+static void writeWsClientStats(JsonDocument& doc) {
+    doc["type"] = "clientStats";
+    JsonArray clients = doc.createNestedArray("clients");
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        if (!webSocket.clientIsConnected(num)) continue;
+        const WsClientState& c = wsClients[num];
+        JsonObject client = clients.createNestedObject();
+        client["num"] = num;
+        client["binary"] = clientBinaryMode[num];
+        client["queueDepth"] = wsClientQueueDepth(num);
+        client["sent"] = c.sent;
+        client["coalesced"] = c.coalesced;
+        client["dropped"] = c.dropped;
+        client["slowSends"] = c.slowSends;
+        client["busySkips"] = c.busySkips;
+        client["lastSendUs"] = c.lastSendUs;
+        client["maxSendUs"] = c.maxSendUs;
+        client["backoff"] = c.backoff;
+        client["congested"] = c.congested;
+        JsonObject topics = client.createNestedObject("topics");
+        writeClientSubscriptions(topics, num);
+    }
+}
+
+// {"action":"subscribe","topics":{"sensor":5000,"perf":10000,"wifi":false}}
+// 数值为最小间隔 (毫秒, 0 表示每次发布都发送), false/null 取消订阅; 未列出的主题保持不变
+void handleSubscribeRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
+    if (clientNum >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    JsonObjectConst topics = request["topics"].as<JsonObjectConst>();
+    if (topics.isNull()) {
+        response["type"] = "error";
+        response["message"] = "Missing 'topics' object.";
+        return;
+    }
+    for (JsonPairConst kv : topics) {
+        int topic = -1;
+        for (uint8_t t = 0; t < TOPIC_COUNT; t++) {
+            if (strcmp(kv.key().c_str(), WS_TOPIC_NAMES[t]) == 0) topic = t;
+        }
+#if !PERF_STATS_ENABLED
+        if (topic == TOPIC_PERF) topic = -1;
+#endif
+        if (topic < 0) {
+            P_PRINTF("[%u] 未知订阅主题: %s\n", clientNum, kv.key().c_str());
+            continue;
+        }
+        WsClientTopic& ct = wsClients[clientNum].topics[topic];
+        const bool wasSubscribed = ct.intervalMs != WS_TOPIC_OFF;
+        if (kv.value().isNull() || (kv.value().is<bool>() && !kv.value().as<bool>())) {
+            ct.intervalMs = WS_TOPIC_OFF;
+            continue;
+        }
+        const long interval = kv.value().as<long>();
+        ct.intervalMs = interval > 0 ? (uint32_t)interval : 0;
+        // 新订阅立即发送当前帧; historyTail 只发送之后新增的点
+        if (!wasSubscribed) {
+            ct.lastSeq = (topic == TOPIC_HISTORY_TAIL) ? topicSeq[topic] : 0;
+            ct.accountedSeq = (topic == TOPIC_HISTORY_TAIL || topicSeq[topic] == 0) ? topicSeq[topic] : topicSeq[topic] - 1;
+        }
+    }
+    response["type"] = "subscriptions";
+    JsonObject current = response.createNestedObject("topics");
+    writeClientSubscriptions(current, clientNum);
+}
+
+void handleGetClientStatsRequest(uint8_t clientNum, const JsonDocument& request, JsonDocument& response) {
+    writeWsClientStats(response);
+}
@@ -2,8 +2,7 @@
 #define WEB_HANDLER_H
 
 #include "data_manager.h"
-#include <map>
-#include <functional>
+#include <limits.h>
 
 #include <ESPAsyncWebServer.h>
 #include <WebSocketsServer.h>
@@ -19,8 +18,17 @@ extern int ntpInitialAttempts;
 extern unsigned long lastNtpAttemptTime;
 extern unsigned long lastNtpSyncTime;
 
+// 历史数据查询参数: 时间戳范围 [from, to] (单位与数据点的 ts 字段相同), limit 为只取最新的点数 (0 表示不限)
+struct HistoryQuery {
+    unsigned long from;
+    unsigned long to;
+    size_t limit;
+
+    HistoryQuery() : from(0), to(ULONG_MAX), limit(0) {}
+};
+
 // 定义 WebSocket Action Handler 类型
-typedef std::function<void(uint8_t, const JsonDocument&, JsonDocument&)> WebSocketActionHandler;
+typedef void (*WebSocketActionHandler)(uint8_t clientNum, const JsonDocument& request, JsonDocument& response);
 
 // ==========================================================================
 // == 函数声明 ==
@@ -29,7 +37,6 @@ typedef std::function<void(uint8_t, const JsonDocument&, JsonDocument&)> WebSock
 // -- 初始化 --
 void initWiFiAndWebServer(DeviceConfig& config, WifiState& wifiStatus);
 void configureWebServer();
-void setupWebSocketActions();
 void handleCaptivePortal(AsyncWebServerRequest* request);
 
 
@@ -37,6 +44,7 @@ void handleCaptivePortal(AsyncWebServerRequest* request);
 void network_loop();
 void processWiFiConnection(WifiState& wifiStatus, DeviceConfig& config);
 void processWifiScanResults(WifiState& wifiStatus);
+void processWebSocketSubscriptions();   // 按各客户端的订阅发送到期主题的最新帧
 void attemptNtpSync();
 
 // -- WebSocket 事件处理 --
@@ -44,11 +52,18 @@ void onWebSocketEvent(uint8_t clientNum, WStype_t type, uint8_t * payload, size_
 void handleWebSocketMessage(uint8_t clientNum, const JsonDocument& doc, JsonDocument& responseDoc);
 
 // -- WebSocket 数据发送 --
-void sendSensorDataToClients(const DeviceState& state, uint8_t specificClientNum = 255);
+void sendSensorDataToClients(const DeviceState& state, uint8_t specificClientNum = 255); // 完整关键帧
+bool sendSensorDataChanges(const DeviceState& state);              // 只发送超出死区的字段, 到期时发送关键帧
 void sendWifiStatusToClients(const WifiState& currentWifiState, uint8_t specificClientNum = 255);
-void sendHistoricalDataToClient(uint8_t clientNum, const CircularBuffer& histBuffer);
+bool sendWifiStatusChanges(const WifiState& currentWifiState);     // 仅在状态转换时广播
+void sendHistoricalDataToClient(uint8_t clientNum, HistoryTier tier, const HistoryQuery& query = HistoryQuery()); // 分块发送, 每块一条消息
 void sendCurrentSettingsToClient(uint8_t clientNum, const DeviceConfig& config);
 void sendCalibrationStatusToClients(uint8_t specificClientNum = 255); // 新增: 发送校准状态
+void buildHealthJson(JsonDocument& doc, bool withHistory);         // 运行健康数据 (WebSocket getHealth 与 HTTP /api/health 共用)
+void sendHealthToClient(uint8_t clientNum, bool withHistory);
+#if PERF_STATS_ENABLED
+void sendPerfStatsToClient(uint8_t clientNum);                     // 分阶段耗时直方图 (getPerfStats)
+#endif
 
 
 #endif // WEB_HANDLER_H
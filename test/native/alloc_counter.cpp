@@ -0,0 +1,70 @@
+#include "alloc_counter.h"
+#include <stddef.h>
+
+#if defined(__GLIBC__)
+
+// 可执行文件中定义的 malloc 会覆盖 libc 的同名符号 (libstdc++ 的 operator new 也会调用到这里),
+// 真正的分配转交给 glibc 导出的 __libc_* 实现
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+
+extern "C" void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    if (p) {
+        allocCount++;
+        allocBytes += size;
+    }
+    return p;
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    if (p) {
+        allocCount++;
+        allocBytes += n * size;
+    }
+    return p;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    void* p = __libc_realloc(ptr, size);
+    if (p && size) {
+        allocCount++;
+        allocBytes += size;
+    }
+    return p;
+}
+
+extern "C" void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+AllocStats allocStats() {
+    AllocStats stats = { allocCount, allocBytes };
+    return stats;
+}
+
+bool allocCountingAvailable() {
+    return true;
+}
+
+#else
+
+AllocStats allocStats() {
+    AllocStats stats = { 0, 0 };
+    return stats;
+}
+
+bool allocCountingAvailable() {
+    return false;
+}
+
+#endif
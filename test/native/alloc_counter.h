@@ -0,0 +1,21 @@
+#ifndef NATIVE_ALLOC_COUNTER_H
+#define NATIVE_ALLOC_COUNTER_H
+
+// ==========================================================================
+// == 堆分配计数 ==
+// == 包装 malloc/calloc/realloc (operator new 和 String 最终都经过这里), 累计
+// == 分配次数和请求的字节数. 依赖 glibc 的 __libc_malloc, 其他平台上计数恒为 0,
+// == allocCountingAvailable() 返回 false, 相关断言应跳过.
+// ==========================================================================
+
+#include <stdint.h>
+
+struct AllocStats {
+    uint64_t count;   // malloc/calloc/realloc 调用次数 (realloc(p, 0) 和失败的调用不计)
+    uint64_t bytes;   // 请求的字节数之和
+};
+
+AllocStats allocStats();                 // 进程启动以来的累计值
+bool allocCountingAvailable();
+
+#endif // NATIVE_ALLOC_COUNTER_H
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "alloc_counter.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+volatile uint32_t benchSink = 0;
+
+struct BenchBaseline {
+    const char* name;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+static const BenchBaseline BENCH_BASELINES[] = {
+#define BENCH_BASELINE(name, ns, allocs, bytes) { name, ns, allocs, bytes },
+#include "bench_baseline.h"
+#undef BENCH_BASELINE
+};
+
+static const BenchBaseline* findBaseline(const char* name) {
+    for (size_t i = 0; i < sizeof(BENCH_BASELINES) / sizeof(BENCH_BASELINES[0]); i++) {
+        if (strcmp(BENCH_BASELINES[i].name, name) == 0) return &BENCH_BASELINES[i];
+    }
+    return NULL;
+}
+
+BenchResult benchRunOp(const char* name, uint32_t iterations, BenchOp op, void* ctx) {
+    // 预热: 填充缓存, 触发被测代码中的一次性初始化 (例如首次构建查找表), 不计入结果
+    const uint32_t warmup = iterations / 10 < 1000 ? iterations / 10 : 1000;
+    for (uint32_t i = 0; i < warmup; i++) op(ctx, i);
+
+    const AllocStats before = allocStats();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) op(ctx, i);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const AllocStats after = allocStats();
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    result.allocsPerOp = (double)(after.count - before.count) / iterations;
+    result.bytesPerOp = (double)(after.bytes - before.bytes) / iterations;
+    return result;
+}
+
+bool benchCheck(const BenchResult& r, char* message, size_t size) {
+    const BenchBaseline* base = findBaseline(r.name);
+    printf("[BENCH] %-28s %10.2f ns/op %8.3f allocs/op %10.1f B/op", r.name, r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+    if (base) printf("   (基线 %.2f ns, %.3f allocs, %.1f B)\n", base->nsPerOp, base->allocsPerOp, base->bytesPerOp);
+    else printf("\n");
+
+    const double eps = 1e-9;
+    bool ok = true;
+    if (!base || base->nsPerOp <= 0) {
+        snprintf(message, size, "%s 没有基线", r.name);
+        ok = false;
+    } else if (r.allocsPerOp > base->allocsPerOp + eps || r.bytesPerOp > base->bytesPerOp + eps) {
+        snprintf(message, size, "%s 堆分配退化: %.3f allocs/op, %.1f B/op (基线 %.3f, %.1f)",
+                 r.name, r.allocsPerOp, r.bytesPerOp, base->allocsPerOp, base->bytesPerOp);
+        ok = false;
+    } else if (r.nsPerOp > base->nsPerOp * BENCH_NS_TOLERANCE + BENCH_NS_SLACK) {
+        snprintf(message, size, "%s 耗时退化: %.2f ns/op (基线 %.2f, 容差 x%.1f)",
+                 r.name, r.nsPerOp, base->nsPerOp, (double)BENCH_NS_TOLERANCE);
+        ok = false;
+    }
+    if (!ok) {
+        // 有意的变化: 用这一行替换 bench_baseline.h 中的对应条目. 分配按打印精度向上取整, 粘贴后不会因舍入判定退化
+        printf("[BENCH] BENCH_BASELINE(\"%s\", %.2f, %.3f, %.1f)\n", r.name, r.nsPerOp,
+               ceil(r.allocsPerOp * 1000) / 1000, ceil(r.bytesPerOp * 10) / 10);
+    }
+    return ok;
+}
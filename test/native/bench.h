@@ -0,0 +1,52 @@
+#ifndef NATIVE_BENCH_H
+#define NATIVE_BENCH_H
+
+// ==========================================================================
+// == 主机基准测试 ==
+// == benchRun() 先预热, 再连续执行 iterations 次, 报告每次操作的耗时 (ns/op,
+// == 主机单调时钟, 与虚拟时钟无关)、堆分配次数 (allocs/op) 和分配字节数 (B/op).
+// == benchCheck() 与 bench_baseline.h 中提交的基线比较:
+// ==  - 分配次数/字节数超过基线即判定退化 (与机器无关, 精确比较)
+// ==  - 耗时超过 基线 x BENCH_NS_TOLERANCE + BENCH_NS_SLACK 判定退化
+// == 没有基线 (或基线耗时未记录, 为 0) 的基准也判定失败: 新增基准时须同时提交在基准机器上
+// == 记录的基线 (输出中给出了可直接粘贴的行).
+// ==========================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef BENCH_NS_TOLERANCE
+#define BENCH_NS_TOLERANCE 2.0
+#endif
+#ifndef BENCH_NS_SLACK
+#define BENCH_NS_SLACK 2.0
+#endif
+
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+typedef void (*BenchOp)(void* ctx, uint32_t i);
+
+BenchResult benchRunOp(const char* name, uint32_t iterations, BenchOp op, void* ctx);
+
+// op(i) 为一次操作, i 为迭代序号 (预热时也从 0 开始)
+template <typename F>
+BenchResult benchRun(const char* name, uint32_t iterations, F op) {
+    struct Trampoline {
+        static void call(void* ctx, uint32_t i) { (*static_cast<F*>(ctx))(i); }
+    };
+    return benchRunOp(name, iterations, &Trampoline::call, &op);
+}
+
+// 与基线比较并打印结果, 退化或缺少基线时返回 false 并把原因写入 message
+bool benchCheck(const BenchResult& result, char* message, size_t size);
+
+// 防止被测表达式被优化掉
+extern volatile uint32_t benchSink;
+
+#endif // NATIVE_BENCH_H
@@ -0,0 +1,28 @@
+// ==========================================================================
+// == 基准测试基线 (test/native/test_bench 等) ==
+// == BENCH_BASELINE(名称, ns/op, allocs/op, B/op)
+// == 分配次数和字节数与机器无关, 必须精确保持; ns/op 是在基准机器上
+// == (x86-64, g++ -O2) 记录的, 换到其他机器时整体重新记录.
+// == 有意的变化: 从测试输出中复制 "[BENCH] BENCH_BASELINE(...)" 行替换对应条目.
+// ==========================================================================
+
+BENCH_BASELINE("ring_push",             11.80, 0, 0)
+BENCH_BASELINE("ring_iterate_128",     143.19, 0, 0)
+BENCH_BASELINE("calculate_ppm",         10.17, 0, 0)
+BENCH_BASELINE("check_alarms",          13.14, 0, 0)
+BENCH_BASELINE("time_str_relative",    216.22, 0, 0)
+BENCH_BASELINE("time_str_absolute",    420.42, 0, 0)
+BENCH_BASELINE("sensor_frame_binary",   30.31, 0, 0)
+BENCH_BASELINE("ring_add_history",       14.50, 0, 0)
+BENCH_BASELINE("ring_iterate_history",  139.53, 0, 0)
+BENCH_BASELINE("legacy_add_history",     24.06, 0, 0)
+BENCH_BASELINE("legacy_iterate_history", 840.42, 0, 0)
+BENCH_BASELINE("gas_ppm_table_build", 77626.17, 0, 0)
+BENCH_BASELINE("gas_ppm_lookup_4ch",      9.80, 0, 0)
+BENCH_BASELINE("gas_ppm_curve_4ch",      89.81, 0, 0)
+BENCH_BASELINE("gas_filter_push_4ch",     44.77, 0, 0)
+BENCH_BASELINE("p2_quantile_add",         18.73, 0, 0)
+BENCH_BASELINE("running_stats_add_4ch",    9.44, 0, 0)
+BENCH_BASELINE("dispatch_perfect_hash",   27.33, 0, 0)
+BENCH_BASELINE("dispatch_strcmp_chain",   43.88, 0, 0)
+BENCH_BASELINE("dispatch_std_map",        49.29, 0.308, 5.6)
@@ -0,0 +1,29 @@
+// ==========================================================================
+// == 主机测试中不编译的模块所定义的全局变量和函数 ==
+// ==========================================================================
+
+#include "sensor_source.h"
+#include "sensor_handler.h"
+#include "gas_sensor.h"
+
+// sensor_handler.cpp: 主机上没有传感器, 硬件数据源始终读不到数据 (用例用 setSensorSource() 换成模拟/回放数据源)
+static GasReadResult readAbsentGas(GasRawReading&) { return GAS_READ_ABSENT; }
+static DhtRmtResult fetchAbsentDht(DhtReading&) { return DHT_RMT_NONE; }
+static void startAbsentDht() {}
+
+const SensorSource HARDWARE_SENSOR_SOURCE = { "hardware", readAbsentGas, fetchAbsentDht, startAbsentDht };
+
+// sensor_handler.cpp: 没有采样任务, 快照始终为初始状态 (序号 0 表示尚无样本); 没有 LED
+uint32_t getDeviceStateSnapshot(DeviceState& out) {
+    out = DeviceState();
+    return 0;
+}
+
+void updateLedBrightness(uint8_t brightness_percent) {}
+
+// gas_sensor.cpp: 没有 I2C 总线
+GasBusStats getGasBusStats() {
+    GasBusStats stats;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
@@ -0,0 +1,662 @@
+// ==========================================================================
+// == 主机替身的实现 (shim/ 中各头文件) ==
+// ==========================================================================
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include <WebSocketsServer.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_timer.h>
+#include <ctype.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+SPIFFSFS SPIFFS;
+
+// ==========================================================================
+// == 虚拟时钟 ==
+// ==========================================================================
+
+static uint64_t clockUs = 0;
+
+unsigned long millis() { return (unsigned long)(clockUs / 1000); }
+unsigned long micros() { return (unsigned long)clockUs; }
+void delay(uint32_t ms) { clockUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { clockUs += us; }
+void shimClockSetUs(uint64_t us) { clockUs = us; }
+void shimClockAdvanceMs(uint32_t ms) { clockUs += (uint64_t)ms * 1000; }
+uint64_t shimClockUs() { return clockUs; }
+int64_t esp_timer_get_time() { return (int64_t)clockUs; }
+
+// ==========================================================================
+// == GPIO 和杂项 ==
+// ==========================================================================
+
+static uint8_t pinLevels[SHIM_PIN_COUNT];
+static uint32_t pinWriteCounts[SHIM_PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= SHIM_PIN_COUNT) return;
+    pinLevels[pin] = val ? HIGH : LOW;
+    pinWriteCounts[pin]++;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < SHIM_PIN_COUNT ? pinLevels[pin] : LOW;
+}
+
+uint32_t shimPinWrites(uint8_t pin) {
+    return pin < SHIM_PIN_COUNT ? pinWriteCounts[pin] : 0;
+}
+
+void shimPinsReset() {
+    memset(pinLevels, 0, sizeof(pinLevels));
+    memset(pinWriteCounts, 0, sizeof(pinWriteCounts));
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    if (inMax == inMin) return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long howBig) { return howBig > 0 ? rand() % howBig : 0; }
+long random(long howSmall, long howBig) { return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall); }
+
+#if !defined(__APPLE__) && (!defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t srcLen = strlen(src);
+    if (size > 0) {
+        size_t n = srcLen < size - 1 ? srcLen : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return srcLen;
+}
+#endif
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2, const char* server3) {}
+bool getLocalTime(struct tm* info, uint32_t ms) { return false; }
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n < 0 ? 0 : (size_t)n;
+}
+
+// ==========================================================================
+// == FreeRTOS ==
+// ==========================================================================
+
+static int currentTaskTag;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t coreId) {
+    if (handle) *handle = NULL;
+    return pdFAIL;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return &currentTaskTag; }
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpu) { return NULL; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) { return 0; }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+    *previousWakeTime += increment;
+    if ((int32_t)(*previousWakeTime - xTaskGetTickCount()) > 0) shimClockSetUs((uint64_t)*previousWakeTime * 1000);
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {}
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) { return 0; }
+
+// ==========================================================================
+// == String ==
+// ==========================================================================
+
+String::String(const char* cstr) : buffer(NULL), capacity(0), len(0) {
+    if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const String& other) : buffer(NULL), capacity(0), len(0) {
+    *this = other;
+}
+
+String::String(String&& other) : buffer(other.buffer), capacity(other.capacity), len(other.len) {
+    other.buffer = NULL;
+    other.capacity = 0;
+    other.len = 0;
+}
+
+String::String(char c) : buffer(NULL), capacity(0), len(0) {
+    char buf[2] = { c, 0 };
+    copy(buf, 1);
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+    char buf[34];
+    if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+    else snprintf(buf, sizeof(buf), "%ld", value);
+    copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+    char buf[34];
+    if (base == 16) snprintf(buf, sizeof(buf), "%lx", value);
+    else snprintf(buf, sizeof(buf), "%lu", value);
+    copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) : buffer(NULL), capacity(0), len(0) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    copy(buf, strlen(buf));
+}
+
+String::~String() {
+    free(buffer);
+}
+
+void String::invalidate() {
+    free(buffer);
+    buffer = NULL;
+    capacity = len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+    if (buffer && capacity >= size) return true;
+    char* grown = (char*)realloc(buffer, size + 1);
+    if (!grown) return false;
+    if (!buffer) grown[0] = '\0';
+    buffer = grown;
+    capacity = size;
+    return true;
+}
+
+bool String::copy(const char* cstr, unsigned int length) {
+    if (!reserve(length)) {
+        invalidate();
+        return false;
+    }
+    memmove(buffer, cstr, length);
+    buffer[length] = '\0';
+    len = length;
+    return true;
+}
+
+String& String::operator=(const String& rhs) {
+    if (this == &rhs) return *this;
+    if (rhs.buffer) copy(rhs.buffer, rhs.len);
+    else invalidate();
+    return *this;
+}
+
+String& String::operator=(String&& rhs) {
+    if (this == &rhs) return *this;
+    free(buffer);
+    buffer = rhs.buffer;
+    capacity = rhs.capacity;
+    len = rhs.len;
+    rhs.buffer = NULL;
+    rhs.capacity = rhs.len = 0;
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    if (cstr) copy(cstr, strlen(cstr));
+    else invalidate();
+    return *this;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+    if (!cstr) return false;
+    if (length == 0) return true;
+    if (!reserve(len + length)) return false;
+    memmove(buffer + len, cstr, length);
+    len += length;
+    buffer[len] = '\0';
+    return true;
+}
+
+bool String::concat(const String& str) { return concat(str.c_str(), str.len); }
+bool String::concat(const char* cstr) { return cstr && concat(cstr, strlen(cstr)); }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+StringSumHelper& operator+(const StringSumHelper& lhs, const String& rhs) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(rhs);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, const char* cstr) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(cstr);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, char c) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(c);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, int num) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(num);
+    return a;
+}
+
+StringSumHelper& operator+(const StringSumHelper& lhs, unsigned long num) {
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs);
+    a.concat(num);
+    return a;
+}
+
+bool String::equals(const String& s) const { return len == s.len && strcmp(c_str(), s.c_str()) == 0; }
+bool String::equals(const char* cstr) const { return strcmp(c_str(), cstr ? cstr : "") == 0; }
+
+bool String::startsWith(const String& prefix) const {
+    return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    if (fromIndex >= len) return -1;
+    const char* p = strchr(buffer + fromIndex, ch);
+    return p ? (int)(p - buffer) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+    if (fromIndex >= len) return -1;
+    const char* p = strstr(buffer + fromIndex, str.c_str());
+    return p ? (int)(p - buffer) : -1;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+    if (beginIndex >= len) return String();
+    if (endIndex > len) endIndex = len;
+    String out;
+    out.copy(buffer + beginIndex, endIndex - beginIndex);
+    return out;
+}
+
+void String::trim() {
+    if (!buffer || len == 0) return;
+    unsigned int begin = 0, end = len;
+    while (begin < end && isspace((unsigned char)buffer[begin])) begin++;
+    while (end > begin && isspace((unsigned char)buffer[end - 1])) end--;
+    memmove(buffer, buffer + begin, end - begin);
+    len = end - begin;
+    buffer[len] = '\0';
+}
+
+// ==========================================================================
+// == 文件系统 ==
+// ==========================================================================
+
+static char fsRoot[160];
+static long writeBudget = -1;
+static uint64_t bytesWritten = 0;
+
+const char* shimFsRoot() {
+    if (fsRoot[0] == '\0') {
+        const char* base = getenv("TMPDIR");
+        snprintf(fsRoot, sizeof(fsRoot), "%s/native_fs_XXXXXX", base && *base ? base : "/tmp");
+        if (!mkdtemp(fsRoot)) {
+            fprintf(stderr, "[SHIM] 无法创建临时目录 %s: %s\n", fsRoot, strerror(errno));
+            abort();
+        }
+    }
+    return fsRoot;
+}
+
+static void hostPath(const char* path, char* out, size_t size) {
+    snprintf(out, size, "%s%s%s", shimFsRoot(), path[0] == '/' ? "" : "/", path);
+}
+
+void shimFsFormat() {
+    DIR* dir = opendir(shimFsRoot());
+    if (!dir) return;
+    struct dirent* entry;
+    char full[320];
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        snprintf(full, sizeof(full), "%s/%s", shimFsRoot(), entry->d_name);
+        unlink(full);
+    }
+    closedir(dir);
+}
+
+void shimFsSetWriteBudget(long bytes) { writeBudget = bytes; }
+void shimFsPowerOn() { writeBudget = -1; }
+bool shimFsPoweredOff() { return writeBudget == 0; }
+uint64_t shimFsBytesWritten() { return bytesWritten; }
+void shimFsResetBytesWritten() { bytesWritten = 0; }
+
+namespace fs {
+
+File::File(FILE* fp, const char* path) : fp(fp), refs(new int(1)) {
+    strlcpy(filePath, path, sizeof(filePath));
+}
+
+File::File(const File& other) : fp(other.fp), refs(other.refs) {
+    memcpy(filePath, other.filePath, sizeof(filePath));
+    if (refs) ++*refs;
+}
+
+File& File::operator=(const File& other) {
+    if (this == &other) return *this;
+    release();
+    fp = other.fp;
+    refs = other.refs;
+    memcpy(filePath, other.filePath, sizeof(filePath));
+    if (refs) ++*refs;
+    return *this;
+}
+
+File::~File() {
+    release();
+}
+
+void File::release() {
+    if (refs && --*refs == 0) {
+        fclose(fp);
+        delete refs;
+    }
+    fp = NULL;
+    refs = NULL;
+}
+
+size_t File::write(const uint8_t* data, size_t size) {
+    if (!fp) return 0;
+    size_t allowed = size;
+    if (writeBudget >= 0 && (long)allowed > writeBudget) allowed = (size_t)writeBudget;
+    size_t written = allowed ? fwrite(data, 1, allowed, fp) : 0;
+    if (writeBudget >= 0) {
+        writeBudget -= (long)written;
+        fflush(fp); // 掉电前已写入的部分必须真正落盘
+    }
+    bytesWritten += written;
+    return written;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return fp ? fread(buf, 1, size, fp) : 0;
+}
+
+int File::read() {
+    if (!fp) return -1;
+    int c = fgetc(fp);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!fp) return -1;
+    int c = fgetc(fp);
+    if (c == EOF) return -1;
+    ungetc(c, fp);
+    return c;
+}
+
+int File::available() {
+    return fp ? (int)(size() - position()) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return fp && fseek(fp, (long)pos, mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END)) == 0;
+}
+
+size_t File::position() const {
+    return fp ? (size_t)ftell(fp) : 0;
+}
+
+size_t File::size() const {
+    if (!fp) return 0;
+    fflush(fp);
+    struct stat st;
+    return fstat(fileno(fp), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::flush() {
+    if (fp) fflush(fp);
+}
+
+void File::close() {
+    release();
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    char full[320];
+    hostPath(path, full, sizeof(full));
+    // 只支持 SPIFFS 的 "r"/"w"/"a"; 以二进制方式打开
+    char hostMode[4] = { mode[0], 'b', mode[1] == '+' ? '+' : '\0', '\0' };
+    FILE* fp = fopen(full, hostMode);
+    return fp ? File(fp, path) : File();
+}
+
+bool FS::exists(const char* path) {
+    char full[320];
+    hostPath(path, full, sizeof(full));
+    struct stat st;
+    return stat(full, &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    char full[320];
+    hostPath(path, full, sizeof(full));
+    return unlink(full) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    char from[320], to[320];
+    hostPath(pathFrom, from, sizeof(from));
+    hostPath(pathTo, to, sizeof(to));
+    return ::rename(from, to) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return true; // SPIFFS 没有目录, 路径中的 '/' 只是文件名的一部分
+}
+
+} // namespace fs
+
+// ==========================================================================
+// == 网络 ==
+// ==========================================================================
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+// -- WebSocketsServer --
+
+static WebSocketsServer* lastWsServer = NULL;
+
+WebSocketsServer::WebSocketsServer(uint16_t port) {
+    memset(connected, 0, sizeof(connected));
+    memset(stats, 0, sizeof(stats));
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        _clients[i].num = i;
+        _clients[i].tcp = NULL;
+        peerFds[i] = -1;
+    }
+    lastWsServer = this;
+}
+
+WebSocketsServer* WebSocketsServer::shimInstance() { return lastWsServer; }
+
+uint8_t WebSocketsServer::connectedClients(bool ping) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) count += connected[i];
+    return count;
+}
+
+// 写满 fd 的发送缓冲区 (非阻塞写到 EAGAIN)
+static void fillSocket(int fd) {
+    static const char junk[4096] = { 0 };
+    while (send(fd, junk, sizeof(junk), MSG_DONTWAIT) > 0) {}
+}
+
+static void drainSocket(int fd) {
+    char buf[4096];
+    while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {}
+}
+
+static bool socketWritable(int fd) {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(fd, &writeSet);
+    struct timeval timeout = { 0, 0 };
+    return select(fd + 1, NULL, &writeSet, NULL, &timeout) > 0;
+}
+
+bool WebSocketsServer::record(uint8_t num, size_t length, bool binary) {
+    if (!clientIsConnected(num)) return false;
+    if (!socketWritable(tcpClients[num].socketFd)) { // 真实库的写操作阻塞到超时
+        shimClockAdvanceMs(WEBSOCKETS_TCP_TIMEOUT);
+        return false;
+    }
+    if (binary) stats[num].binaryFrames++;
+    else stats[num].textFrames++;
+    stats[num].bytes += length;
+    return true;
+}
+
+bool WebSocketsServer::broadcast(size_t length, bool binary) {
+    bool ok = true;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (connected[i]) ok &= record(i, length, binary);
+    }
+    return ok;
+}
+
+uint32_t WebSocketsServer::shimTotalFrames() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) total += stats[i].textFrames + stats[i].binaryFrames;
+    return total;
+}
+
+void WebSocketsServer::shimConnect(uint8_t num) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || connected[num]) return;
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return;
+    tcpClients[num].socketFd = fds[0];
+    peerFds[num] = fds[1];
+    _clients[num].tcp = &tcpClients[num];
+    connected[num] = true;
+    if (event) event(num, WStype_CONNECTED, (uint8_t*)"/", 1);
+}
+
+void WebSocketsServer::shimDisconnect(uint8_t num) {
+    if (!clientIsConnected(num)) return;
+    connected[num] = false;
+    _clients[num].tcp = NULL;
+    close(tcpClients[num].socketFd);
+    close(peerFds[num]);
+    tcpClients[num].socketFd = peerFds[num] = -1;
+    if (event) event(num, WStype_DISCONNECTED, NULL, 0);
+}
+
+void WebSocketsServer::shimSetWritable(uint8_t num, bool writable) {
+    if (!clientIsConnected(num)) return;
+    if (writable) drainSocket(peerFds[num]);
+    else fillSocket(tcpClients[num].socketFd);
+}
+
+// 与真实库相同: 负载可被回调修改 (ArduinoJson 原地解析), 末尾补 '\0'
+void WebSocketsServer::shimReceive(uint8_t num, const char* text) {
+    if (!clientIsConnected(num) || !event) return;
+    const size_t len = strlcpy(receiveBuffer, text, sizeof(receiveBuffer));
+    event(num, WStype_TEXT, (uint8_t*)receiveBuffer, len < sizeof(receiveBuffer) ? len : sizeof(receiveBuffer) - 1);
+}
+
+// -- ESPAsyncWebServer --
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const char* content) {
+    response.status = code;
+    response.contentLength = content ? strlen(content) : 0;
+    response.content = NULL;
+    return &response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(fs::FS& fs, const char* path, const char* contentType, bool download) {
+    char gz[160];
+    snprintf(gz, sizeof(gz), "%s.gz", path);
+    if (!fs.exists(path) && (download || !fs.exists(gz))) return NULL;
+    return beginResponse(200, contentType);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const char* contentType, const uint8_t* content, size_t len) {
+    response.status = code;
+    response.contentLength = len;
+    response.content = content;
+    return &response;
+}
+
+void AsyncWebServerRequest::shimAddParam(const char* name, const char* value) {
+    if (paramCount >= SHIM_HTTP_MAX_PARAMS) return;
+    params[paramCount].paramName = name;
+    params[paramCount].paramValue = value;
+    paramCount++;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::findParam(const char* name) const {
+    for (uint8_t i = 0; i < paramCount; i++) {
+        if (params[i].paramName == name) return const_cast<AsyncWebParameter*>(&params[i]);
+    }
+    return NULL;
+}
+
+static AsyncWebServer* lastHttpServer = NULL;
+
+AsyncWebServer::AsyncWebServer(uint16_t port) { lastHttpServer = this; }
+
+AsyncWebServer* AsyncWebServer::shimInstance() { return lastHttpServer; }
+
+void AsyncWebServer::on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction onRequest) {
+    if (routeCount >= SHIM_HTTP_MAX_ROUTES) return;
+    routes[routeCount].uri = uri;
+    routes[routeCount].method = method;
+    routes[routeCount].handler = onRequest;
+    routeCount++;
+}
+
+bool AsyncWebServer::shimHandle(AsyncWebServerRequest& request) {
+    for (uint8_t i = 0; i < routeCount; i++) {
+        if ((routes[i].method & request.method()) && request.url() == routes[i].uri) {
+            routes[i].handler(&request);
+            return true;
+        }
+    }
+    if (notFound) notFound(&request);
+    return false;
+}
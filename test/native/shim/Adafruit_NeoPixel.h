@@ -0,0 +1,8 @@
+#ifndef NATIVE_SHIM_ADAFRUIT_NEOPIXEL_H
+#define NATIVE_SHIM_ADAFRUIT_NEOPIXEL_H
+
+// Adafruit_NeoPixel 替身: 主机上没有 LED, 只供 sensor_handler.h 的包含关系编译
+
+#include <Arduino.h>
+
+#endif // NATIVE_SHIM_ADAFRUIT_NEOPIXEL_H
@@ -0,0 +1,212 @@
+#ifndef NATIVE_SHIM_ARDUINO_H
+#define NATIVE_SHIM_ARDUINO_H
+
+// ==========================================================================
+// == 主机 (env:native) 上的 Arduino 最小替身 ==
+// == 只提供 src/ 中可在主机上编译的模块实际用到的部分: 虚拟时钟 (millis/micros),
+// == GPIO 电平数组, 输出到 stdout 的 Serial, 基于 malloc 的 String (分配计入
+// == alloc_counter), 以及 FreeRTOS 的单线程替身 (见 freertos/FreeRTOS.h).
+// ==========================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <cmath>
+
+#include "freertos/FreeRTOS.h"
+
+using std::min;
+using std::max;
+using std::isnan;
+using std::isinf;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define PROGMEM
+#define F(s) (s)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ==========================================================================
+// == 虚拟时钟 ==
+// == millis()/micros()/esp_timer_get_time() 都读同一个微秒计数, 只由测试推进
+// == (delay()/vTaskDelay() 也会推进), 因此回放和定时逻辑的结果与机器快慢无关.
+// ==========================================================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void shimClockSetUs(uint64_t us);
+void shimClockAdvanceMs(uint32_t ms);
+uint64_t shimClockUs();
+
+// ==========================================================================
+// == GPIO ==
+// ==========================================================================
+
+#define SHIM_PIN_COUNT 64
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint32_t shimPinWrites(uint8_t pin);   // 该引脚被写入的次数 (蜂鸣器节奏测试用)
+void shimPinsReset();
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long howBig);
+long random(long howSmall, long howBig);
+
+// NTP: 主机上不联网, getLocalTime() 始终失败 (固件保持相对时间)
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2 = NULL, const char* server3 = NULL);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+// glibc 2.38 之前没有 strlcpy
+#if !defined(__APPLE__) && (!defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38))
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+// ==========================================================================
+// == String ==
+// == 与 Arduino String 的常用接口一致, 缓冲区用 malloc/realloc 管理,
+// == 因此 alloc_counter 能统计到 String 拼接造成的堆分配.
+// ==========================================================================
+
+class StringSumHelper;
+
+class String {
+public:
+    String(const char* cstr = "");
+    String(const String& other);
+    String(String&& other);
+    explicit String(char c);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+    ~String();
+
+    String& operator=(const String& rhs);
+    String& operator=(String&& rhs);
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    const char* c_str() const { return buffer ? buffer : ""; }
+
+    bool concat(const String& str);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(int num);
+    bool concat(unsigned int num);
+    bool concat(long num);
+    bool concat(unsigned long num);
+    bool concat(float num);
+    bool concat(double num);
+
+    template <typename T> String& operator+=(const T& rhs) { concat(rhs); return *this; }
+
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, const String& rhs);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, const char* cstr);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, char c);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, int num);
+    friend StringSumHelper& operator+(const StringSumHelper& lhs, unsigned long num);
+
+    bool equals(const String& s) const;
+    bool equals(const char* cstr) const;
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& rhs) const { return strcmp(c_str(), rhs.c_str()) < 0; }
+
+    char charAt(unsigned int index) const { return index < len ? buffer[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const String& str, unsigned int fromIndex = 0) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, len); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+    void trim();
+    long toInt() const { return buffer ? atol(buffer) : 0; }
+    float toFloat() const { return buffer ? (float)atof(buffer) : 0; }
+
+private:
+    char* buffer;
+    unsigned int capacity;
+    unsigned int len;
+    void invalidate();
+    bool copy(const char* cstr, unsigned int length);
+};
+
+// 与 Arduino 相同: 拼接表达式的临时对象, ArduinoJson 也按此类型识别 String
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+    StringSumHelper(char c) : String(c) {}
+    StringSumHelper(int num) : String(num) {}
+    StringSumHelper(unsigned long num) : String(num) {}
+};
+
+// ==========================================================================
+// == Serial / ESP ==
+// ==========================================================================
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    // 不加 format 属性: 固件按 32 位 size_t/long 写的格式串在 64 位主机上会产生大量无关警告
+    size_t printf(const char* format, ...);
+    size_t print(const char* s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c) { return putchar(c) == EOF ? 0 : 1; }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return print("\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t write(const uint8_t* data, size_t size) { return fwrite(data, 1, size, stdout); }
+    size_t write(uint8_t c) { return putchar(c) == EOF ? 0 : 1; }
+    void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getMinFreeHeap() { return 200 * 1024; }
+    uint32_t getMaxAllocHeap() { return 128 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount() { return (uint32_t)(shimClockUs() * 240); }
+    void restart() { restartRequested = true; }
+    bool restartRequested = false;
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_SHIM_ARDUINO_H
@@ -0,0 +1,19 @@
+#ifndef NATIVE_SHIM_DNSSERVER_H
+#define NATIVE_SHIM_DNSSERVER_H
+
+// DNSServer 替身: 不处理任何请求
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+enum class DNSReplyCode { NoError = 0, FormError = 1, ServerFailure = 2, NonExistentDomain = 3 };
+
+class DNSServer {
+public:
+    void setErrorReplyCode(const DNSReplyCode& replyCode) {}
+    bool start(const uint16_t& port, const char* domainName, const IPAddress& resolvedIP) { return true; }
+    void processNextRequest() {}
+    void stop() {}
+};
+
+#endif // NATIVE_SHIM_DNSSERVER_H
@@ -0,0 +1,109 @@
+#ifndef NATIVE_SHIM_ESPASYNCWEBSERVER_H
+#define NATIVE_SHIM_ESPASYNCWEBSERVER_H
+
+// ==========================================================================
+// == ESPAsyncWebServer 替身 ==
+// == 不做网络操作: server.on() 注册的处理函数按路径记录, 测试构造请求后用
+// == AsyncWebServer::shimHandle() 同步调用. 响应对象嵌在请求内, 只记录状态码、
+// == 内容长度和 beginResponse_P 的内容指针; shimClose() 模拟连接结束, 调用
+// == onDisconnect() 注册的回调.
+// == 内容类型和头部参数用 const char*: 真实库为请求/响应对象和 String 参数做的分配
+// == 不属于本项目代码, 不计入测试的分配统计.
+// ==========================================================================
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+
+enum WebRequestMethod { HTTP_GET = 0b00000001, HTTP_POST = 0b00000010, HTTP_ANY = 0b01111111 };
+
+#define SHIM_HTTP_MAX_PARAMS 4
+#define SHIM_HTTP_MAX_ROUTES 24
+
+class AsyncWebParameter {
+public:
+    const String& name() const { return paramName; }
+    const String& value() const { return paramValue; }
+    String paramName;
+    String paramValue;
+};
+typedef AsyncWebParameter AsyncWebHeader;
+
+class AsyncWebServerResponse {
+public:
+    void addHeader(const char* name, const char* value) { headers++; }
+    void setCode(int code) { status = code; }
+    void setContentLength(size_t len) { contentLength = len; }
+
+    // -- 测试钩子 --
+    int status = 0;
+    size_t contentLength = 0;
+    const uint8_t* content = NULL;   // beginResponse_P 的内容 (发送期间由调用方保持有效)
+    uint8_t headers = 0;
+};
+
+typedef std::function<void(void)> ArDisconnectHandler;
+
+class AsyncWebServerRequest {
+public:
+    explicit AsyncWebServerRequest(const char* url, WebRequestMethod method = HTTP_GET) : requestUrl(url), requestMethod(method) {}
+
+    WebRequestMethod method() const { return requestMethod; }
+    const String& url() const { return requestUrl; }
+
+    bool hasParam(const char* name) const { return findParam(name) != NULL; }
+    AsyncWebParameter* getParam(const char* name) const { return findParam(name); }
+    bool hasHeader(const char* name) const { return false; }
+    AsyncWebHeader* getHeader(const char* name) const { return NULL; }
+
+    AsyncWebServerResponse* beginResponse(int code, const char* contentType = "", const char* content = "");
+    AsyncWebServerResponse* beginResponse(fs::FS& fs, const char* path, const char* contentType = "", bool download = false);
+    AsyncWebServerResponse* beginResponse_P(int code, const char* contentType, const uint8_t* content, size_t len);
+    void send(AsyncWebServerResponse* response) { sent = true; }
+    void send(int code, const char* contentType = "", const char* content = "") { send(beginResponse(code, contentType, content)); }
+    void redirect(const char* url) { send(beginResponse(302)); }
+    void onDisconnect(ArDisconnectHandler fn) { disconnectHandler = fn; }
+
+    // -- 测试钩子 --
+    void shimAddParam(const char* name, const char* value);
+    void shimClose() { if (disconnectHandler) disconnectHandler(); disconnectHandler = NULL; }
+    bool shimSent() const { return sent; }
+    const AsyncWebServerResponse& shimResponse() const { return response; }
+
+private:
+    String requestUrl;
+    WebRequestMethod requestMethod;
+    AsyncWebParameter params[SHIM_HTTP_MAX_PARAMS];
+    uint8_t paramCount = 0;
+    AsyncWebServerResponse response;
+    ArDisconnectHandler disconnectHandler;
+    bool sent = false;
+
+    AsyncWebParameter* findParam(const char* name) const;
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port);
+    void begin() {}
+    void on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction onRequest);
+    void onNotFound(ArRequestHandlerFunction fn) { notFound = fn; }
+
+    // -- 测试钩子 --
+    static AsyncWebServer* shimInstance();   // 最近构造的实例
+    bool shimHandle(AsyncWebServerRequest& request);   // 按路径和方法分派, 没有匹配时交给 onNotFound, 返回是否匹配到路由
+
+private:
+    struct Route {
+        const char* uri;
+        WebRequestMethod method;
+        ArRequestHandlerFunction handler;
+    };
+    Route routes[SHIM_HTTP_MAX_ROUTES];
+    uint8_t routeCount = 0;
+    ArRequestHandlerFunction notFound;
+};
+
+#endif // NATIVE_SHIM_ESPASYNCWEBSERVER_H
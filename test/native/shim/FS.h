@@ -0,0 +1,76 @@
+#ifndef NATIVE_SHIM_FS_H
+#define NATIVE_SHIM_FS_H
+
+// ==========================================================================
+// == 文件系统替身: 路径映射到主机临时目录下的真实文件 ==
+// == 另外提供两个测试钩子 (对所有 FS 实例生效):
+// ==  - 写入预算: 剩余字节数耗尽后的写入只落盘预算内的部分, 之后的写入全部失败,
+// ==    模拟写到一半掉电 (撕裂写入). 用 shimFsPowerOn() 恢复.
+// ==  - 写入字节计数: 统计实际落盘的字节数, 用于写放大断言.
+// ==========================================================================
+
+#include <Arduino.h>
+#include <stdio.h>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+class File {
+public:
+    File() : fp(NULL), refs(NULL) {}
+    File(FILE* fp, const char* path);
+    File(const File& other);
+    File& operator=(const File& other);
+    ~File();
+
+    explicit operator bool() const { return fp != NULL; }
+    size_t write(const uint8_t* data, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t* buf, size_t size);
+    int read();
+    size_t readBytes(char* buf, size_t size) { return read((uint8_t*)buf, size); }
+    int available();
+    int peek();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    const char* path() const { return filePath; }
+
+private:
+    FILE* fp;
+    int* refs;
+    char filePath[128];
+    void release();
+};
+
+class FS {
+public:
+    FS() {}
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* pathFrom, const char* pathTo);
+    bool mkdir(const char* path);
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+// -- 测试钩子 --
+const char* shimFsRoot();                  // 本进程的临时根目录 (首次使用时创建)
+void shimFsFormat();                       // 删除根目录下的所有文件
+void shimFsSetWriteBudget(long bytes);     // 之后只允许再写入 bytes 字节, -1 表示不限
+void shimFsPowerOn();                      // 取消写入预算 (模拟重新上电)
+bool shimFsPoweredOff();                   // 写入预算是否已耗尽
+uint64_t shimFsBytesWritten();             // 累计落盘字节数
+void shimFsResetBytesWritten();
+
+#endif // NATIVE_SHIM_FS_H
@@ -0,0 +1,18 @@
+#ifndef NATIVE_SHIM_SPIFFS_H
+#define NATIVE_SHIM_SPIFFS_H
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = NULL) { return true; }
+    void end() {}
+    bool format() { shimFsFormat(); return true; }
+    size_t totalBytes() { return 1408 * 1024; }
+    size_t usedBytes() { return 0; }
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif // NATIVE_SHIM_SPIFFS_H
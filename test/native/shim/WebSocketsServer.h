@@ -0,0 +1,105 @@
+#ifndef NATIVE_SHIM_WEBSOCKETSSERVER_H
+#define NATIVE_SHIM_WEBSOCKETSSERVER_H
+
+// ==========================================================================
+// == WebSocketsServer 替身 ==
+// == 不做网络操作: 发送只按客户端统计帧数和字节数. 客户端连接/断开和收到的文本
+// == 消息由测试通过 shimConnect()/shimDisconnect()/shimReceive() 注入, 与真实库在
+// == loop() 中分发事件一样同步调用 onEvent() 注册的回调.
+// == 与真实库一样, 客户端表 _clients 为 protected, 每个客户端的 tcp 带一个本地套接字对的
+// == 一端, shimSetWritable(num, false) 写满其发送缓冲区. 向不可写的客户端发送时与真实库
+// == 一样阻塞到 WEBSOCKETS_TCP_TIMEOUT (虚拟时钟前进) 后失败.
+// == 固件中的实例是文件内的静态对象, 测试通过 WebSocketsServer::shimInstance() 访问.
+// ==========================================================================
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+
+typedef enum {
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG
+} WStype_t;
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5   // 与真实库 ESP32 的默认值相同
+#define WEBSOCKETS_MAX_HEADER_SIZE 14
+#define WEBSOCKETS_TCP_TIMEOUT 5000      // 与真实库 ESP32 的默认值相同 (毫秒)
+
+struct WSclient_t {
+    uint8_t num;
+    WiFiClient* tcp;                     // 未连接时为 NULL
+};
+
+struct ShimWsClientStats {
+    uint32_t textFrames;
+    uint32_t binaryFrames;
+    uint64_t bytes;
+};
+
+class WebSocketsServer {
+public:
+    typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+    explicit WebSocketsServer(uint16_t port);
+
+    void begin() {}
+    void loop() {}
+    void onEvent(WebSocketServerEvent cbEvent) { event = cbEvent; }
+
+    bool sendTXT(uint8_t num, uint8_t* payload, size_t length = 0, bool headerToPayload = false) { return record(num, length, false); }
+    bool sendTXT(uint8_t num, const uint8_t* payload, size_t length = 0) { return record(num, length, false); }
+    bool sendTXT(uint8_t num, char* payload, size_t length = 0, bool headerToPayload = false) { return sendTXT(num, (uint8_t*)payload, length ? length : strlen(payload), headerToPayload); }
+    bool sendTXT(uint8_t num, const char* payload, size_t length = 0) { return record(num, length ? length : strlen(payload), false); }
+    bool sendTXT(uint8_t num, String& payload) { return record(num, payload.length(), false); }
+
+    bool broadcastTXT(uint8_t* payload, size_t length = 0, bool headerToPayload = false) { return broadcast(length, false); }
+    bool broadcastTXT(const uint8_t* payload, size_t length = 0) { return broadcast(length, false); }
+    bool broadcastTXT(char* payload, size_t length = 0, bool headerToPayload = false) { return broadcast(length ? length : strlen(payload), false); }
+    bool broadcastTXT(const char* payload, size_t length = 0) { return broadcast(length ? length : strlen(payload), false); }
+    bool broadcastTXT(String& payload) { return broadcast(payload.length(), false); }
+
+    bool sendBIN(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload = false) { return record(num, length, true); }
+    bool sendBIN(uint8_t num, const uint8_t* payload, size_t length) { return record(num, length, true); }
+    bool broadcastBIN(uint8_t* payload, size_t length, bool headerToPayload = false) { return broadcast(length, true); }
+    bool broadcastBIN(const uint8_t* payload, size_t length) { return broadcast(length, true); }
+
+    uint8_t connectedClients(bool ping = false);
+    bool clientIsConnected(uint8_t num) { return num < WEBSOCKETS_SERVER_CLIENT_MAX && connected[num]; }
+    IPAddress remoteIP(uint8_t num) { return IPAddress(192, 168, 4, (uint8_t)(2 + num)); }
+    void disconnect(uint8_t num) { shimDisconnect(num); }
+
+    // -- 测试钩子 --
+    static WebSocketsServer* shimInstance();   // 最近构造的实例
+    void shimConnect(uint8_t num);
+    void shimDisconnect(uint8_t num);
+    void shimReceive(uint8_t num, const char* text);
+    const ShimWsClientStats& shimStats(uint8_t num) const { return stats[num < WEBSOCKETS_SERVER_CLIENT_MAX ? num : 0]; }
+    uint32_t shimTotalFrames() const;
+    void shimResetStats() { memset(stats, 0, sizeof(stats)); }
+    void shimSetWritable(uint8_t num, bool writable);   // false: 写满该客户端的 TCP 发送缓冲区; true: 对端读空
+
+protected:
+    WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+private:
+    WebSocketServerEvent event;
+    bool connected[WEBSOCKETS_SERVER_CLIENT_MAX];
+    WiFiClient tcpClients[WEBSOCKETS_SERVER_CLIENT_MAX];
+    int peerFds[WEBSOCKETS_SERVER_CLIENT_MAX];          // 套接字对的另一端 (相当于浏览器)
+    ShimWsClientStats stats[WEBSOCKETS_SERVER_CLIENT_MAX];
+    char receiveBuffer[1024];
+
+    bool record(uint8_t num, size_t length, bool binary);
+    bool broadcast(size_t length, bool binary);
+};
+
+#endif // NATIVE_SHIM_WEBSOCKETSSERVER_H
@@ -0,0 +1,75 @@
+#ifndef NATIVE_SHIM_WIFI_H
+#define NATIVE_SHIM_WIFI_H
+
+// WiFi 替身: 连接状态和 SSID 由测试设置, 不做任何网络操作.
+// 连接/扫描请求只计数, 扫描始终失败 (不返回网络列表)
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : addr((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    operator uint32_t() const { return addr; }
+    uint8_t operator[](int index) const { return (uint8_t)(addr >> (8 * index)); }
+    String toString() const;
+
+private:
+    uint32_t addr;
+};
+
+// TCP 连接: 只提供套接字描述符 (WebSocketsServer 替身为每个客户端创建一对本地套接字)
+class WiFiClient {
+public:
+    int fd() const { return socketFd; }
+    int socketFd = -1;
+};
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { currentMode = m; return true; }
+    wifi_mode_t getMode() { return currentMode; }
+    bool softAP(const char* ssid, const char* passphrase = NULL, int channel = 1, int ssidHidden = 0, int maxConnection = 4) { return true; }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    IPAddress localIP() { return connected ? IPAddress(192, 168, 1, 50) : IPAddress(); }
+
+    bool isConnected() { return connected; }
+    wl_status_t status() { return connected ? WL_CONNECTED : WL_DISCONNECTED; }
+    String SSID() { return String(ssid); }
+    String SSID(uint8_t index) { return String(); }
+    int32_t RSSI(uint8_t index) { return 0; }
+
+    wl_status_t begin(const char* ssid, const char* passphrase = NULL) { beginCalls++; return status(); }
+    bool disconnect(bool wifiOff = false) { connected = false; return true; }
+
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                         uint32_t maxMsPerChannel = 300, uint8_t channel = 0) { return WIFI_SCAN_FAILED; }
+    int16_t scanComplete() { return WIFI_SCAN_FAILED; }
+    void scanDelete() {}
+
+    // -- 测试钩子 --
+    bool connected = false;
+    const char* ssid = "";
+    wifi_mode_t currentMode = WIFI_OFF;
+    uint32_t beginCalls = 0;
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_SHIM_WIFI_H
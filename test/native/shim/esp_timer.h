@@ -0,0 +1,9 @@
+#ifndef NATIVE_SHIM_ESP_TIMER_H
+#define NATIVE_SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+// 与 micros() 同一个虚拟时钟
+int64_t esp_timer_get_time();
+
+#endif // NATIVE_SHIM_ESP_TIMER_H
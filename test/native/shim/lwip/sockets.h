@@ -0,0 +1,10 @@
+#ifndef NATIVE_SHIM_LWIP_SOCKETS_H
+#define NATIVE_SHIM_LWIP_SOCKETS_H
+
+// lwIP 套接字接口替身: 主机上直接使用 POSIX 套接字 (select/fd_set 语义相同)
+
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#endif // NATIVE_SHIM_LWIP_SOCKETS_H
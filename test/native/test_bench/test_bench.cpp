@@ -0,0 +1,135 @@
+// ==========================================================================
+// == 热路径基准测试 ==
+// == 每个用例运行一个基准并与 bench_baseline.h 比较, 退化时失败.
+// == 运行: pio test -e native -f native/test_bench -v (-v 才能看到每项的数值)
+// ==========================================================================
+
+#include <unity.h>
+#include "bench.h"
+#include "data_manager.h"
+#include "sensor_pipeline.h"
+#include "sensor_frame.h"
+#include "ring_buffer.h"
+
+static void assertNoRegression(const BenchResult& result) {
+    char message[192];
+    TEST_ASSERT_TRUE_MESSAGE(benchCheck(result, message, sizeof(message)), message);
+}
+
+// 温湿度在阈值内, 气体读数为洁净空气附近的典型值: 稳态下不触发报警 (也就没有打印)
+static SensorParams makeParams() {
+    SensorParams params;
+    params.thresholds = { 10, 35, 20, 80, 50.0f, 5.0f, 500.0f, 500.0f };
+    params.r0Values = { 1.5f, 1.5f, 1.5f, 1.5f };
+    params.r0Calibrated = params.r0Values;
+    return params;
+}
+
+static DeviceState makeSteadyState() {
+    DeviceState state;
+    state.temperature = 24;
+    state.humidity = 45.5f;
+    state.gasPpmValues = { 1.2f, 0.05f, 3.4f, 12.0f };
+    state.gasRsValues = { 1.4f, 1.6f, 1.3f, 1.5f };
+    state.tempStatus = state.humStatus = SS_NORMAL;
+    state.gasCoStatus = state.gasNo2Status = state.gasC2h5ohStatus = state.gasVocStatus = SS_NORMAL;
+    return state;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// -- 环形缓冲区 --
+
+static void bench_ring_push() {
+    static HistoryBuffer ring;
+    SensorDataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    assertNoRegression(benchRun("ring_push", 2000000, [&](uint32_t i) {
+        dp.timestamp = i;
+        ring.push(dp);
+    }));
+}
+
+static void bench_ring_iterate() {
+    static HistoryBuffer ring;
+    SensorDataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    for (uint32_t i = 0; i < HISTORICAL_DATA_POINTS + 7; i++) { // 写满并回绕, 视图分为两段
+        dp.temp = (int)i;
+        ring.push(dp);
+    }
+    assertNoRegression(benchRun("ring_iterate_128", 200000, [&](uint32_t) {
+        int sum = 0;
+        const RingView<SensorDataPoint> view = ring.view();
+        for (RingView<SensorDataPoint>::Iterator it = view.begin(); it != view.end(); ++it) sum += it->temp;
+        benchSink += sum;
+    }));
+}
+
+// -- 换算和报警 --
+
+static void bench_calculate_ppm() {
+    const SensorParams params = makeParams();
+    DeviceState state = makeSteadyState();
+    assertNoRegression(benchRun("calculate_ppm", 2000000, [&](uint32_t i) {
+        GasRawReading raw = { 300 + (i & 63), 400 + (i & 31), 500 + (i & 15), 600 + (i & 7) };
+        calculatePpm(state, raw, params);
+        benchSink += (uint32_t)state.gasPpmValues.co;
+    }));
+}
+
+static void bench_check_alarms() {
+    const SensorParams params = makeParams();
+    DeviceState state = makeSteadyState();
+    assertNoRegression(benchRun("check_alarms", 2000000, [&](uint32_t i) {
+        state.temperature = 20 + (i & 7);
+        state.gasPpmValues.co = (float)(i & 15);
+        checkAlarms(state, params);
+        benchSink += state.buzzerShouldBeActive;
+    }));
+}
+
+// -- 时间标签 --
+
+static void bench_time_str_relative() {
+    char buffer[12];
+    assertNoRegression(benchRun("time_str_relative", 1000000, [&](uint32_t i) {
+        generateTimeStr(3600000UL + i * 2000UL, true, buffer);
+        benchSink += (uint8_t)buffer[7];
+    }));
+}
+
+static void bench_time_str_absolute() {
+    char buffer[12];
+    assertNoRegression(benchRun("time_str_absolute", 500000, [&](uint32_t i) {
+        generateTimeStr(1700000000UL + i * 2, false, buffer);
+        benchSink += (uint8_t)buffer[7];
+    }));
+}
+
+// -- 实时数据编码 --
+
+static void bench_sensor_frame() {
+    const DeviceState state = makeSteadyState();
+    uint8_t frame[SENSOR_FRAME_SIZE];
+    assertNoRegression(benchRun("sensor_frame_binary", 2000000, [&](uint32_t i) {
+        encodeSensorFrame(state, true, i, i / 1000, frame);
+        benchSink += frame[5];
+    }));
+}
+
+int main(int argc, char** argv) {
+    // 与固件中 configTime() 设置的固定偏移时区一致, 也避免 glibc 每次 localtime() 都重新读取 /etc/localtime
+    setenv("TZ", "UTC-8", 1);
+    tzset();
+    UNITY_BEGIN();
+    RUN_TEST(bench_ring_push);
+    RUN_TEST(bench_ring_iterate);
+    RUN_TEST(bench_calculate_ppm);
+    RUN_TEST(bench_check_alarms);
+    RUN_TEST(bench_time_str_relative);
+    RUN_TEST(bench_time_str_absolute);
+    RUN_TEST(bench_sensor_frame);
+    return UNITY_END();
+}
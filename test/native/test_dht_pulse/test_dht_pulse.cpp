@@ -0,0 +1,218 @@
+// ==========================================================================
+// == DHT11 脉冲解码 ==
+// == 用合成的高电平宽度序列 (以及 RMT 风格的电平段) 覆盖: 正常帧, 校验和错误,
+// == 截断的传输, 宽度异常的数据位, 超出范围的数值和负温度.
+// ==========================================================================
+
+#include <unity.h>
+#include <math.h>
+#include "dht_pulse.h"
+
+#define BIT0_US 27
+#define BIT1_US 70
+#define RELEASE_US 30     // 主机释放总线后的上拉
+#define RESPONSE_US 80    // 传感器响应信号的高电平
+
+struct Frame {
+    uint16_t highUs[2 + DHT_DATA_BITS];
+    size_t count;
+};
+
+// 按字节生成一帧高电平宽度序列: 主机释放 + 响应 + 40个数据位 (高位在前)
+static Frame makeFrame(uint8_t humInt, uint8_t humDec, uint8_t tempInt, uint8_t tempDec) {
+    const uint8_t data[5] = { humInt, humDec, tempInt, tempDec, (uint8_t)(humInt + humDec + tempInt + tempDec) };
+    Frame frame;
+    frame.count = 0;
+    frame.highUs[frame.count++] = RELEASE_US;
+    frame.highUs[frame.count++] = RESPONSE_US;
+    for (size_t i = 0; i < DHT_DATA_BITS; i++) {
+        frame.highUs[frame.count++] = (data[i / 8] & (0x80 >> (i % 8))) ? BIT1_US : BIT0_US;
+    }
+    return frame;
+}
+
+// 温度按传感器的格式编码: 负温度为 -(整数+1) + 小数/10, 小数字节 bit7 为负号 (与 Adafruit DHT 库的解码一致)
+static void encodeTemperature(float t, uint8_t& tempInt, uint8_t& tempDec) {
+    const int tenths = (int)lroundf(t * 10);
+    if (tenths >= 0) {
+        tempInt = (uint8_t)(tenths / 10);
+        tempDec = (uint8_t)(tenths % 10);
+    } else {
+        const int floorInt = (tenths - 9) / 10; // 向下取整
+        tempInt = (uint8_t)(-floorInt - 1);
+        tempDec = (uint8_t)(0x80 | (tenths - floorInt * 10));
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_valid_frame() {
+    const Frame frame = makeFrame(45, 0, 23, 0);
+    DhtReading reading;
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 45.0f, reading.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 23.0f, reading.temperature);
+
+    // 只有40个数据位 (没有响应信号) 也能解码
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs + 2, DHT_DATA_BITS, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 23.0f, reading.temperature);
+}
+
+// 全部湿度值和 0~50°C 的温度值 (含小数) 解码后与编码前一致
+static void test_valid_frames_round_trip() {
+    for (int hum = 0; hum <= 99; hum++) {
+        for (int tenths = 0; tenths <= 500; tenths += 7) {
+            uint8_t tempInt, tempDec;
+            encodeTemperature(tenths / 10.0f, tempInt, tempDec);
+            const Frame frame = makeFrame((uint8_t)hum, (uint8_t)(hum % 10), tempInt, tempDec);
+            DhtReading reading;
+            TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, hum + (hum % 10) * 0.1f, reading.humidity);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, tenths / 10.0f, reading.temperature);
+        }
+    }
+}
+
+// 高电平宽度以 DHT_BIT_ONE_THRESHOLD_US 为界, 允许范围的两端都能接受
+static void test_bit_threshold_and_limits() {
+    Frame frame = makeFrame(0, 0, 0, 0);
+    DhtReading reading;
+    frame.highUs[2 + 39] = DHT_BIT_ONE_THRESHOLD_US; // 最后一位 (校验和最低位) 仍为 0
+    frame.highUs[2 + 0] = DHT_BIT_MIN_HIGH_US;
+    frame.highUs[2 + 1] = DHT_BIT_ONE_THRESHOLD_US;
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+
+    // 湿度整数 0x01 / 校验和 0x01: 两位都刚好超过阈值
+    frame.highUs[2 + 7] = DHT_BIT_ONE_THRESHOLD_US + 1;
+    frame.highUs[2 + 39] = DHT_BIT_MAX_HIGH_US;
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, reading.humidity);
+}
+
+static void test_bad_pulse_width() {
+    DhtReading reading;
+    for (size_t bit = 0; bit < DHT_DATA_BITS; bit += 13) {
+        Frame frame = makeFrame(45, 0, 23, 0);
+        frame.highUs[2 + bit] = DHT_BIT_MIN_HIGH_US - 1; // 毛刺
+        TEST_ASSERT_EQUAL_INT(DHT_DECODE_BAD_PULSE, dhtDecodePulses(frame.highUs, frame.count, reading));
+        frame.highUs[2 + bit] = DHT_BIT_MAX_HIGH_US + 1; // 总线被拉高 (传感器无响应)
+        TEST_ASSERT_EQUAL_INT(DHT_DECODE_BAD_PULSE, dhtDecodePulses(frame.highUs, frame.count, reading));
+    }
+}
+
+// 任意一个数据位翻转都会使校验和不匹配; 校验和按 8 位回绕计算
+static void test_checksum_errors() {
+    DhtReading reading;
+    for (size_t bit = 0; bit < DHT_DATA_BITS; bit++) {
+        Frame frame = makeFrame(45, 3, 23, 7);
+        uint16_t& w = frame.highUs[2 + bit];
+        w = (w == BIT1_US) ? BIT0_US : BIT1_US;
+        TEST_ASSERT_EQUAL_INT(DHT_DECODE_CHECKSUM, dhtDecodePulses(frame.highUs, frame.count, reading));
+    }
+
+    const Frame overflow = makeFrame(95, 9, 200, 9); // 和为 313, 校验和为 57
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(overflow.highUs, overflow.count, reading));
+}
+
+// 截断的传输: 少于40个高电平段时不解码; 带响应信号但丢失最后一个数据位时,
+// 响应信号被当作湿度字节的最高位, 无论校验和是否碰巧正确都不能被当作有效读数
+static void test_truncated_traces() {
+    DhtReading reading;
+    const Frame frame = makeFrame(45, 0, 23, 0);
+    for (size_t n = 0; n < DHT_DATA_BITS; n++) {
+        TEST_ASSERT_EQUAL_INT(DHT_DECODE_TOO_FEW_PULSES, dhtDecodePulses(frame.highUs + 2, n, reading));
+    }
+    for (int hum = 0; hum <= 99; hum++) {
+        for (int tenths = -200; tenths <= 500; tenths++) {
+            uint8_t tempInt, tempDec;
+            encodeTemperature(tenths / 10.0f, tempInt, tempDec);
+            const Frame full = makeFrame((uint8_t)hum, (uint8_t)(hum % 10), tempInt, tempDec);
+            TEST_ASSERT_NOT_EQUAL(DHT_DECODE_OK, dhtDecodePulses(full.highUs, full.count - 1, reading));
+        }
+    }
+}
+
+// 校验和正确但数值不可能出现的帧
+static void test_out_of_range_values() {
+    DhtReading reading;
+    Frame frame = makeFrame(DHT_MAX_HUMIDITY + 1, 0, 23, 0);
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OUT_OF_RANGE, dhtDecodePulses(frame.highUs, frame.count, reading));
+    frame = makeFrame(45, DHT_MAX_DECIMAL + 1, 23, 0);
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OUT_OF_RANGE, dhtDecodePulses(frame.highUs, frame.count, reading));
+    frame = makeFrame(45, 0, 23, 0x80 | (DHT_MAX_DECIMAL + 1));
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OUT_OF_RANGE, dhtDecodePulses(frame.highUs, frame.count, reading));
+    frame = makeFrame(DHT_MAX_HUMIDITY, DHT_MAX_DECIMAL, 23, 0x80 | DHT_MAX_DECIMAL);
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+}
+
+// 负温度: 小数字节 bit7 为负号, 数值为 -(整数+1) + 小数/10
+static void test_negative_temperatures() {
+    DhtReading reading;
+    Frame frame = makeFrame(50, 0, 5, 0x83);
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -5.7f, reading.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 50.0f, reading.humidity);
+
+    frame = makeFrame(50, 0, 0, 0x80);
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -1.0f, reading.temperature);
+
+    // -20.0 ~ -0.1 °C 逐个 0.1 度往返
+    for (int tenths = -200; tenths < 0; tenths++) {
+        uint8_t tempInt, tempDec;
+        encodeTemperature(tenths / 10.0f, tempInt, tempDec);
+        frame = makeFrame(40, 0, tempInt, tempDec);
+        TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(frame.highUs, frame.count, reading));
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, tenths / 10.0f, reading.temperature);
+    }
+}
+
+// RMT 捕获的电平段: 低电平和零宽度段被跳过, 超出容量时保留最新的段
+static void test_collect_high_pulses() {
+    const Frame frame = makeFrame(45, 0, 23, 0);
+    uint8_t levels[2 * (2 + DHT_DATA_BITS) + 8];
+    uint16_t durations[sizeof(levels)];
+    size_t segments = 0;
+    // 前导的干扰高电平, 超出 maxHigh 后应被丢弃
+    for (size_t i = 0; i < 3; i++) {
+        levels[segments] = 1; durations[segments++] = 5;
+        levels[segments] = 0; durations[segments++] = 15;
+    }
+    for (size_t i = 0; i < frame.count; i++) {
+        levels[segments] = 0; durations[segments++] = (i < 2) ? 80 : 50;
+        levels[segments] = 1; durations[segments++] = frame.highUs[i];
+    }
+    levels[segments] = 1; durations[segments++] = 0; // 捕获结束标记
+    levels[segments] = 0; durations[segments++] = 50;
+
+    uint16_t highUs[2 + DHT_DATA_BITS];
+    const size_t n = dhtCollectHighPulses(levels, durations, segments, highUs, 2 + DHT_DATA_BITS);
+    TEST_ASSERT_EQUAL_UINT32(2 + DHT_DATA_BITS, n);
+    TEST_ASSERT_EQUAL_MEMORY(frame.highUs, highUs, sizeof(highUs));
+
+    DhtReading reading;
+    TEST_ASSERT_EQUAL_INT(DHT_DECODE_OK, dhtDecodePulses(highUs, n, reading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 45.0f, reading.humidity);
+}
+
+static void test_status_names() {
+    TEST_ASSERT_EQUAL_STRING("OK", dhtDecodeStatusName(DHT_DECODE_OK));
+    TEST_ASSERT_EQUAL_STRING("checksum mismatch", dhtDecodeStatusName(DHT_DECODE_CHECKSUM));
+    TEST_ASSERT_EQUAL_STRING("value out of range", dhtDecodeStatusName(DHT_DECODE_OUT_OF_RANGE));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_frame);
+    RUN_TEST(test_valid_frames_round_trip);
+    RUN_TEST(test_bit_threshold_and_limits);
+    RUN_TEST(test_bad_pulse_width);
+    RUN_TEST(test_checksum_errors);
+    RUN_TEST(test_truncated_traces);
+    RUN_TEST(test_out_of_range_values);
+    RUN_TEST(test_negative_temperatures);
+    RUN_TEST(test_collect_high_pulses);
+    RUN_TEST(test_status_names);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+// ==========================================================================
+// == WebSocket action 分派 ==
+// == 编译期完美哈希 (perfect_hash.h) 的正确性, 以及与逐项 strcmp 比较和
+// == std::map<std::string, std::function> 两种分派方式的吞吐量/分配对比.
+// ==========================================================================
+
+#include <unity.h>
+#include <map>
+#include <string>
+#include <functional>
+#include "bench.h"
+#include "perfect_hash.h"
+
+typedef void (*ActionHandler)(uint8_t clientNum);
+
+struct Action {
+    const char* name;
+    ActionHandler handler;
+};
+
+static void countAction(uint8_t clientNum) { benchSink += clientNum; }
+
+// 与 web_handler.cpp 中的 WS_ACTIONS 相同的名称和顺序
+static constexpr Action ACTIONS[] = {
+    { "getCurrentSettings", countAction },
+    { "getHistoricalData",  countAction },
+    { "saveThresholds",     countAction },
+    { "saveLedBrightness",  countAction },
+    { "scanWifi",           countAction },
+    { "connectWifi",        countAction },
+    { "resetSettings",      countAction },
+    { "startCalibration",   countAction },
+    { "setProtocol",        countAction },
+    { "getPerfStats",       countAction },
+    { "getHealth",          countAction },
+    { "subscribe",          countAction },
+    { "getClientStats",     countAction },
+};
+
+static const size_t ACTION_COUNT = sizeof(ACTIONS) / sizeof(ACTIONS[0]);
+static constexpr size_t ACTION_SLOTS = phash::tableSize(sizeof(ACTIONS) / sizeof(ACTIONS[0]));
+static constexpr phash::SlotTable<ACTION_SLOTS> actionSlots = phash::build<ACTION_SLOTS>(ACTIONS);
+static_assert(actionSlots.seed != phash::NO_SEED, "No perfect hash seed found for ACTIONS");
+
+// 改用哈希表之前的做法: 依次比较
+static const Action* lookupLinear(const char* name) {
+    for (size_t i = 0; i < ACTION_COUNT; i++) {
+        if (strcmp(ACTIONS[i].name, name) == 0) return &ACTIONS[i];
+    }
+    return NULL;
+}
+
+typedef std::map<std::string, std::function<void(uint8_t)> > ActionMap;
+
+static ActionMap makeActionMap() {
+    ActionMap map;
+    for (size_t i = 0; i < ACTION_COUNT; i++) map[ACTIONS[i].name] = ACTIONS[i].handler;
+    return map;
+}
+
+// 请求中的 action 来自解析后的 JSON, 不与表中的字符串常量共用地址
+static char requestNames[ACTION_COUNT][24];
+
+static void assertNoRegression(const BenchResult& result) {
+    char message[192];
+    TEST_ASSERT_TRUE_MESSAGE(benchCheck(result, message, sizeof(message)), message);
+}
+
+void setUp() {
+    for (size_t i = 0; i < ACTION_COUNT; i++) strcpy(requestNames[i], ACTIONS[i].name);
+}
+void tearDown() {}
+
+static void test_every_action_found() {
+    const ActionMap map = makeActionMap();
+    for (size_t i = 0; i < ACTION_COUNT; i++) {
+        TEST_ASSERT_TRUE(phash::lookup(ACTIONS, actionSlots, requestNames[i]) == &ACTIONS[i]);
+        TEST_ASSERT_TRUE(lookupLinear(requestNames[i]) == &ACTIONS[i]);
+        TEST_ASSERT_TRUE(map.find(requestNames[i]) != map.end());
+    }
+}
+
+// 不在表中的名称 (包括前缀, 大小写不同和空串) 返回 NULL
+static void test_unknown_actions_rejected() {
+    const char* unknown[] = { "", "getHealthX", "gethealth", "scanWif", "subscribe ", "foo", "getCurrentSetting" };
+    for (size_t i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++) {
+        TEST_ASSERT_NULL(phash::lookup(ACTIONS, actionSlots, unknown[i]));
+        TEST_ASSERT_NULL(lookupLinear(unknown[i]));
+    }
+}
+
+// 每次操作分派一个请求, 按表中顺序轮流 (迭代次数为表项数的整数倍, 分配次数/操作 与机器无关)
+static void bench_dispatch() {
+    const uint32_t iterations = ACTION_COUNT * 150000;
+    const BenchResult hashed = benchRun("dispatch_perfect_hash", iterations, [&](uint32_t i) {
+        const Action* entry = phash::lookup(ACTIONS, actionSlots, requestNames[i % ACTION_COUNT]);
+        if (entry) entry->handler(1);
+    });
+    const BenchResult linear = benchRun("dispatch_strcmp_chain", iterations, [&](uint32_t i) {
+        const Action* entry = lookupLinear(requestNames[i % ACTION_COUNT]);
+        if (entry) entry->handler(1);
+    });
+    const ActionMap map = makeActionMap();
+    const BenchResult mapped = benchRun("dispatch_std_map", iterations, [&](uint32_t i) {
+        ActionMap::const_iterator it = map.find(requestNames[i % ACTION_COUNT]); // 长名称构造 std::string 时分配
+        if (it != map.end()) it->second(1);
+    });
+    assertNoRegression(hashed);
+    assertNoRegression(linear);
+    assertNoRegression(mapped);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, (float)hashed.allocsPerOp);
+    TEST_ASSERT_TRUE_MESSAGE(hashed.nsPerOp < linear.nsPerOp, "完美哈希应快于逐项比较");
+    TEST_ASSERT_TRUE_MESSAGE(hashed.nsPerOp < mapped.nsPerOp, "完美哈希应快于 std::map");
+    TEST_ASSERT_TRUE(mapped.allocsPerOp > 0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_action_found);
+    RUN_TEST(test_unknown_actions_rejected);
+    RUN_TEST(bench_dispatch);
+    return UNITY_END();
+}
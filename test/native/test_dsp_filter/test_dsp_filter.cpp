@@ -0,0 +1,259 @@
+// ==========================================================================
+// == 定点滤波器和在线统计 ==
+// == 中值滤波的尖峰抑制, EMA 的阶跃响应/稳定时间, P² 分位数估计与精确分位数的误差,
+// == Welford 均值/方差; 以及采样任务中各滤波器每个样本的吞吐量.
+// == 滤波器参数与采样流程相同 (GAS_MEDIAN_WINDOW, GAS_EMA_SHIFT).
+// ==========================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "bench.h"
+#include "config.h"
+#include "dsp_filter.h"
+
+#define CHANNELS 4
+
+typedef DecimatingFilter<CHANNELS, GAS_MEDIAN_WINDOW, GAS_EMA_SHIFT> GasFilter;
+
+static void assertNoRegression(const BenchResult& result) {
+    char message[192];
+    TEST_ASSERT_TRUE_MESSAGE(benchCheck(result, message, sizeof(message)), message);
+}
+
+// xorshift32, 可重复的测试数据
+static uint32_t rngState = 1;
+static uint32_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+static double uniform01() { return (nextRandom() >> 8) / (double)(1UL << 24); }
+
+static void fill(int32_t* samples, int32_t value) {
+    for (size_t ch = 0; ch < CHANNELS; ch++) samples[ch] = value;
+}
+
+void setUp() { rngState = 1; }
+void tearDown() {}
+
+// -- 中值滤波 --
+
+// 连续不超过 (窗口-1)/2 个的尖峰被完全滤除, 输出保持为基线值
+static void test_median_rejects_spikes() {
+    const size_t maxRun = (GAS_MEDIAN_WINDOW - 1) / 2;
+    for (size_t run = 1; run <= maxRun; run++) {
+        MedianFilter<CHANNELS, GAS_MEDIAN_WINDOW> median;
+        int32_t in[CHANNELS], out[CHANNELS];
+        for (size_t i = 0; i < 200; i++) {
+            const bool spike = i >= GAS_MEDIAN_WINDOW && (i % 11) < run;
+            in[0] = spike ? 4095 : 1000;    // 正尖峰
+            in[1] = spike ? 0 : 1000;       // 负尖峰
+            in[2] = spike ? 4095 : 1000 + (int32_t)(i & 1); // 基线有 1 LSB 抖动
+            in[3] = 1000;
+            median.process(in, out);
+            if (i < GAS_MEDIAN_WINDOW) continue;
+            TEST_ASSERT_EQUAL_INT32(1000, out[0]);
+            TEST_ASSERT_EQUAL_INT32(1000, out[1]);
+            TEST_ASSERT_TRUE(out[2] == 1000 || out[2] == 1001);
+            TEST_ASSERT_EQUAL_INT32(1000, out[3]);
+        }
+    }
+
+    // 持续超过半个窗口的变化是真实信号, 必须通过
+    MedianFilter<CHANNELS, GAS_MEDIAN_WINDOW> median;
+    int32_t in[CHANNELS], out[CHANNELS];
+    fill(in, 1000);
+    for (size_t i = 0; i < GAS_MEDIAN_WINDOW; i++) median.process(in, out);
+    fill(in, 3000);
+    for (size_t i = 0; i <= maxRun; i++) median.process(in, out);
+    TEST_ASSERT_EQUAL_INT32(3000, out[0]);
+}
+
+// 窗口未满时取已有样本的中值
+static void test_median_partial_window() {
+    MedianFilter<1, 5> median;
+    const int32_t samples[] = { 50, 10, 30 };
+    const int32_t expected[] = { 50, 50, 30 }; // {50}, {10,50} 取上中值, {10,30,50}
+    for (size_t i = 0; i < 3; i++) {
+        int32_t out;
+        median.process(&samples[i], &out);
+        TEST_ASSERT_EQUAL_INT32(expected[i], out);
+    }
+}
+
+// 完整流水线: 周期性的单点尖峰经过中值滤波后不影响 EMA 输出; 没有中值滤波时 EMA 被明显拉偏
+static void test_pipeline_spike_rejection() {
+    GasFilter filter;
+    EmaFilter<CHANNELS, GAS_EMA_SHIFT> emaOnly;
+    int32_t in[CHANNELS], out[CHANNELS];
+    int32_t worstEma = 0;
+    for (size_t i = 0; i < 400; i++) {
+        fill(in, (i > 10 && i % 7 == 0) ? 4095 : 1000);
+        filter.push(in);
+        emaOnly.process(in);
+        if (i > 10) worstEma = std::max(worstEma, emaOnly.value(0) - 1000);
+        if (i % 20 == 19) {
+            TEST_ASSERT_EQUAL_UINT32(20, filter.take(out));
+            for (size_t ch = 0; ch < CHANNELS; ch++) TEST_ASSERT_EQUAL_INT32(1000, out[ch]);
+        }
+    }
+    TEST_ASSERT_TRUE(worstEma > (4095 - 1000) / (1 << GAS_EMA_SHIFT) - 2);
+    TEST_ASSERT_EQUAL_UINT32(0, filter.take(out));
+
+    filter.reset();
+    fill(in, 2000);
+    filter.push(in); // 重置后第一个样本直接作为初值
+    TEST_ASSERT_EQUAL_UINT32(1, filter.take(out));
+    TEST_ASSERT_EQUAL_INT32(2000, out[0]);
+}
+
+// -- EMA --
+
+// 阶跃响应与 1-(1-2^-n)^k 一致 (误差不超过 1 LSB), 并在理论的稳定时间内精确到达目标值
+static void test_ema_step_settling() {
+    const double alpha = 1.0 / (1 << GAS_EMA_SHIFT);
+    const int32_t from[] = { 0, 3000, -2000 };
+    const int32_t to[] = { 1000, 200, 2000 };
+    for (size_t c = 0; c < 3; c++) {
+        EmaFilter<1, GAS_EMA_SHIFT> ema;
+        ema.process(&from[c]);
+        TEST_ASSERT_EQUAL_INT32(from[c], ema.value(0));
+
+        const double step = to[c] - from[c];
+        // 剩余误差小于半个 LSB 所需的样本数
+        const int settle = (int)ceil(log(0.5 / fabs(step)) / log(1 - alpha));
+        int settledAt = -1;
+        for (int k = 1; k <= settle + 8; k++) {
+            ema.process(&to[c]);
+            const double expected = to[c] - step * pow(1 - alpha, k);
+            TEST_ASSERT_FLOAT_WITHIN(1.0, expected, (double)ema.value(0));
+            if (settledAt < 0 && ema.value(0) == to[c]) settledAt = k;
+        }
+        printf("[DSP] EMA 阶跃 %d -> %d: 理论稳定时间 %d 个样本, 实际 %d\n", from[c], to[c], settle, settledAt);
+        TEST_ASSERT_TRUE(settledAt > 0 && settledAt <= settle + 1);
+        TEST_ASSERT_EQUAL_INT32(to[c], ema.value(0));
+    }
+
+    // 时间常数: 约 2^n 个样本后达到阶跃的 63%
+    EmaFilter<1, GAS_EMA_SHIFT> ema;
+    int32_t x = 0;
+    ema.process(&x);
+    x = 1000;
+    for (int k = 0; k < (1 << GAS_EMA_SHIFT); k++) ema.process(&x);
+    TEST_ASSERT_INT32_WITHIN(50, 632, ema.value(0));
+}
+
+// -- 在线统计 --
+
+// P² 估计与精确分位数的误差, 以估计值在排序样本中的秩表示
+static void test_p2_quantile_error() {
+    const size_t n = 10000;
+    const float quantiles[] = { 0.1f, 0.5f, 0.9f };
+    const char* names[] = { "均匀", "正态", "指数" };
+    for (int dist = 0; dist < 3; dist++) {
+        std::vector<float> samples(n);
+        for (size_t i = 0; i < n; i++) {
+            const double u = uniform01() + 1e-9;
+            if (dist == 0) samples[i] = (float)(1000 * u);
+            else if (dist == 1) samples[i] = (float)(1000 + 50 * sqrt(-2 * log(u)) * cos(2 * M_PI * uniform01()));
+            else samples[i] = (float)(-100 * log(u));
+        }
+        for (size_t q = 0; q < 3; q++) {
+            P2Quantile estimator(quantiles[q]);
+            for (size_t i = 0; i < n; i++) estimator.add(samples[i]);
+            TEST_ASSERT_EQUAL_UINT32(n, estimator.count());
+
+            std::vector<float> sorted(samples);
+            std::sort(sorted.begin(), sorted.end());
+            const float exact = sorted[(size_t)(quantiles[q] * (n - 1))];
+            const float estimate = estimator.value();
+            const double rank = (std::lower_bound(sorted.begin(), sorted.end(), estimate) - sorted.begin()) / (double)n;
+            printf("[DSP] P² %s分布 p=%.1f: 估计 %.2f, 精确 %.2f, 秩误差 %.4f\n",
+                   names[dist], quantiles[q], estimate, exact, fabs(rank - quantiles[q]));
+            TEST_ASSERT_FLOAT_WITHIN(0.005, quantiles[q], rank);
+        }
+    }
+}
+
+// 样本少于5个时返回最接近的顺序统计量
+static void test_p2_quantile_few_samples() {
+    P2Quantile median(0.5f);
+    TEST_ASSERT_FLOAT_IS_NAN(median.value());
+    const float samples[] = { 9, 1, 5 };
+    for (size_t i = 0; i < 3; i++) median.add(samples[i]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, median.value());
+
+    P2Quantile low(0.0f);
+    for (size_t i = 0; i < 3; i++) low.add(samples[i]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, low.value());
+}
+
+// 与两遍法 (double) 计算的均值/方差一致, 各通道独立计数
+static void test_running_stats() {
+    RunningStats<2> stats;
+    TEST_ASSERT_FLOAT_IS_NAN(stats.mean(0));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.variance(0));
+
+    const size_t n = 5000;
+    std::vector<double> samples(n);
+    for (size_t i = 0; i < n; i++) {
+        samples[i] = 2000 + 40 * (uniform01() - 0.5); // 大均值小方差, 单遍朴素算法会失去精度
+        stats.add(0, (float)samples[i]);
+    }
+    double mean = 0, var = 0;
+    for (size_t i = 0; i < n; i++) mean += samples[i];
+    mean /= n;
+    for (size_t i = 0; i < n; i++) var += (samples[i] - mean) * (samples[i] - mean);
+    var /= n - 1;
+
+    TEST_ASSERT_EQUAL_UINT32(n, stats.count(0));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.count(1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5 * mean, mean, stats.mean(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01 * var, var, stats.variance(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.01 * sqrt(var) / mean, sqrt(var) / mean, stats.cv(0));
+
+    stats.add(1, -1.0f);
+    TEST_ASSERT_TRUE(isinf(stats.cv(1))); // 均值非正
+    stats.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.count(0));
+}
+
+// -- 吞吐量 (每个过采样周期/每个样本) --
+
+static void bench_filters() {
+    static GasFilter filter;
+    int32_t in[CHANNELS], out[CHANNELS];
+    assertNoRegression(benchRun("gas_filter_push_4ch", 2000000, [&](uint32_t i) {
+        for (size_t ch = 0; ch < CHANNELS; ch++) in[ch] = 1000 + (int32_t)((i * (ch + 3)) & 63);
+        filter.push(in);
+        if ((i & 31) == 31) benchSink += filter.take(out) + (uint32_t)out[0];
+    }));
+
+    static P2Quantile estimator(0.9f);
+    assertNoRegression(benchRun("p2_quantile_add", 2000000, [&](uint32_t i) {
+        estimator.add((float)((i * 2654435761u) >> 20));
+    }));
+    benchSink += (uint32_t)estimator.value();
+
+    static RunningStats<CHANNELS> stats;
+    assertNoRegression(benchRun("running_stats_add_4ch", 2000000, [&](uint32_t i) {
+        for (size_t ch = 0; ch < CHANNELS; ch++) stats.add(ch, (float)(1000 + (i & 63)));
+    }));
+    benchSink += (uint32_t)stats.mean(0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_median_rejects_spikes);
+    RUN_TEST(test_median_partial_window);
+    RUN_TEST(test_pipeline_spike_rejection);
+    RUN_TEST(test_ema_step_settling);
+    RUN_TEST(test_p2_quantile_error);
+    RUN_TEST(test_p2_quantile_few_samples);
+    RUN_TEST(test_running_stats);
+    RUN_TEST(bench_filters);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// ==========================================================================
+// == 气体浓度换算 ==
+// == 查找表与参考曲线 (按数据手册参数用 double 计算) 的误差, 有限ADC分辨率
+// == 带来的量化误差, Rs <-> ADC 往返和曲线单调性; 以及查表与直接按曲线计算的吞吐量.
+// ==========================================================================
+
+#include <unity.h>
+#include <math.h>
+#include "bench.h"
+#include "config.h"
+#include "gas_ppm.h"
+#include "sensor_pipeline.h"
+
+// 参考曲线: lg(PPM) = slope * lg(Rs/R0) + intercept, 与数据手册一致. 修改 gas_ppm.cpp 中的曲线时须同时修改这里.
+struct ReferenceCurve {
+    double slope;
+    double intercept;
+    double r0;
+};
+
+static const ReferenceCurve REFERENCE[GAS_PPM_CHANNELS] = {
+    { -2.82, -0.12, DEFAULT_R0_CO },
+    {  1.9,  -0.2,  DEFAULT_R0_NO2 },
+    { -2.0,  -0.5,  DEFAULT_R0_C2H5OH },
+    { -2.5,  -0.6,  DEFAULT_R0_VOC }
+};
+
+static double referencePpm(uint8_t channel, double rs) {
+    const ReferenceCurve& c = REFERENCE[channel];
+    return pow(10.0, c.slope * log10(rs / c.r0) + c.intercept);
+}
+
+// 与 adcToRs 相同的分压电路换算, 用 double 计算
+static double referenceRs(int adc) {
+    const double vOut = adc * (double)SENSOR_VCC / ADC_RESOLUTION;
+    return (double)SENSOR_VCC * GAS_RL_VALUE_KOHM / vOut - GAS_RL_VALUE_KOHM;
+}
+
+static void assertNoRegression(const BenchResult& result) {
+    char message[192];
+    TEST_ASSERT_TRUE_MESSAGE(benchCheck(result, message, sizeof(message)), message);
+}
+
+static SensorParams makeParams() {
+    SensorParams params;
+    params.thresholds = { 10, 35, 20, 80, 50.0f, 5.0f, 500.0f, 500.0f };
+    params.r0Values = { DEFAULT_R0_CO, DEFAULT_R0_NO2, DEFAULT_R0_C2H5OH, DEFAULT_R0_VOC };
+    params.r0Calibrated = params.r0Values;
+    return params;
+}
+
+static float stateChannel(const DeviceState& state, uint8_t channel) {
+    const float values[GAS_PPM_CHANNELS] = { state.gasPpmValues.co, state.gasPpmValues.no2, state.gasPpmValues.c2h5oh, state.gasPpmValues.voc };
+    return values[channel];
+}
+
+static float tables[GAS_PPM_CHANNELS][GAS_PPM_TABLE_SIZE];
+
+void setUp() {
+    for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) gasBuildPpmTable(ch, (float)REFERENCE[ch].r0, tables[ch]);
+}
+
+void tearDown() {}
+
+// 每个有效ADC读数的表项都等于 gasCurvePpm, 与参考曲线的相对误差:
+// 工作范围 (0.1~10 倍 R0) 内在 float 精度内; 接近满量程时 Rs -> 0, adcToRs 的减法有抵消误差
+static void test_table_matches_reference_curve() {
+    for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) {
+        const double r0 = REFERENCE[ch].r0;
+        double worst = 0, worstInRange = 0;
+        for (int adc = 1; adc < GAS_PPM_TABLE_SIZE - 1; adc++) {
+            const double rs = referenceRs(adc);
+            const double ref = referencePpm(ch, rs);
+            const double err = fabs(tables[ch][adc] - ref) / ref;
+            if (err > worst) worst = err;
+            if (rs >= 0.1 * r0 && rs <= 10 * r0 && err > worstInRange) worstInRange = err;
+            TEST_ASSERT_EQUAL_FLOAT(gasCurvePpm(ch, adcToRs(adc), (float)r0), tables[ch][adc]);
+        }
+        printf("[GAS] 通道 %u 查找表相对参考曲线的最大误差: 工作范围内 %.2e, 全部读数 %.2e\n", ch, worstInRange, worst);
+        TEST_ASSERT_LESS_THAN(2e-5, worstInRange);
+        TEST_ASSERT_LESS_THAN(1e-3, worst);
+    }
+}
+
+// 采样流程的 calculatePpm 与查找表一致
+static void test_calculate_ppm_uses_table() {
+    const SensorParams params = makeParams();
+    DeviceState state;
+    for (int adc = 1; adc < GAS_PPM_TABLE_SIZE - 1; adc += 17) {
+        const GasRawReading raw = { (uint32_t)adc, (uint32_t)adc, (uint32_t)adc, (uint32_t)adc };
+        calculatePpm(state, raw, params);
+        for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) TEST_ASSERT_EQUAL_FLOAT(tables[ch][adc], stateChannel(state, ch));
+    }
+}
+
+// 连续变化的 Rs 先量化为ADC读数再查表, 与参考曲线的误差不超过半个ADC步进对应的理论值:
+// dln(Rs)/dADC = (Rs + RL) / (Rs * ADC), 误差约为 |slope| * 0.5 * 该值
+static void test_quantization_error_within_half_lsb() {
+    for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) {
+        const double r0 = REFERENCE[ch].r0;
+        double worst = 0;
+        for (int k = 0; k <= 400; k++) {
+            const double rs = r0 * pow(10.0, -1.0 + k / 200.0); // 0.1 ~ 10 倍 R0
+            const int adc = rsToAdc((float)rs);
+            const double ref = referencePpm(ch, rs);
+            const double err = fabs(tables[ch][adc] - ref) / ref;
+            const double bound = fabs(REFERENCE[ch].slope) * 0.5 * (rs + GAS_RL_VALUE_KOHM) / (rs * adc);
+            if (err > worst) worst = err;
+            TEST_ASSERT_LESS_OR_EQUAL(1.1 * bound + 1e-4, err);
+        }
+        printf("[GAS] 通道 %u 在 0.1~10 倍 R0 范围内的最大量化误差 %.2f%%\n", ch, worst * 100);
+    }
+}
+
+static void test_rs_adc_round_trip() {
+    for (int adc = 1; adc < GAS_PPM_TABLE_SIZE - 1; adc++) TEST_ASSERT_EQUAL_INT(adc, rsToAdc(adcToRs(adc)));
+    TEST_ASSERT_EQUAL_INT(1, rsToAdc(1e9f));
+    TEST_ASSERT_EQUAL_INT(GAS_PPM_TABLE_SIZE - 2, rsToAdc(1e-6f));
+    TEST_ASSERT_EQUAL_INT(0, rsToAdc(0));
+    TEST_ASSERT_EQUAL_INT(0, rsToAdc(NAN));
+}
+
+// ADC 读数越大 Rs 越小: 还原性气体浓度随之上升, NO2 (氧化性) 随之下降
+static void test_curves_are_monotonic() {
+    for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) {
+        const bool reducing = gasChannelIsReducing(ch);
+        TEST_ASSERT_EQUAL(REFERENCE[ch].slope < 0, reducing);
+        for (int adc = 2; adc < GAS_PPM_TABLE_SIZE - 1; adc++) {
+            if (reducing) TEST_ASSERT_TRUE(tables[ch][adc] > tables[ch][adc - 1]);
+            else TEST_ASSERT_TRUE(tables[ch][adc] < tables[ch][adc - 1]);
+        }
+    }
+}
+
+static void test_invalid_inputs() {
+    for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) {
+        TEST_ASSERT_FLOAT_IS_NAN(tables[ch][0]);
+        TEST_ASSERT_FLOAT_IS_NAN(tables[ch][GAS_PPM_TABLE_SIZE - 1]);
+        TEST_ASSERT_FLOAT_IS_NAN(gasCurvePpm(ch, 10.0f, 0.0f));
+        TEST_ASSERT_FLOAT_IS_NAN(gasCurvePpm(ch, -1.0f, 10.0f));
+    }
+    TEST_ASSERT_FLOAT_IS_NAN(gasCurvePpm(GAS_PPM_CHANNELS, 10.0f, 10.0f));
+    TEST_ASSERT_FALSE(gasChannelIsReducing(GAS_PPM_CHANNELS));
+    gasBuildPpmTable(GAS_PPM_CHANNELS, 10.0f, tables[0]);
+    TEST_ASSERT_FLOAT_IS_NAN(tables[0][2048]);
+}
+
+// -- 吞吐量 --
+
+// 校准后重建一个通道的查找表
+static void bench_table_build() {
+    assertNoRegression(benchRun("gas_ppm_table_build", 200, [&](uint32_t i) {
+        gasBuildPpmTable((uint8_t)(i & 3), 10.0f + (float)i, tables[i & 3]);
+        benchSink += (uint32_t)tables[i & 3][1000];
+    }));
+}
+
+// 每个上报周期的4通道换算: 查表与直接按曲线计算
+static void bench_lookup_vs_curve() {
+    const SensorParams params = makeParams();
+    DeviceState state;
+    const BenchResult lookup = benchRun("gas_ppm_lookup_4ch", 2000000, [&](uint32_t i) {
+        const GasRawReading raw = { 300 + (i & 63), 400 + (i & 31), 500 + (i & 15), 600 + (i & 7) };
+        calculatePpm(state, raw, params);
+        benchSink += (uint32_t)state.gasPpmValues.co;
+    });
+    const BenchResult curve = benchRun("gas_ppm_curve_4ch", 2000000, [&](uint32_t i) {
+        const int adc[GAS_PPM_CHANNELS] = { 300 + (int)(i & 63), 400 + (int)(i & 31), 500 + (int)(i & 15), 600 + (int)(i & 7) };
+        const float r0[GAS_PPM_CHANNELS] = { DEFAULT_R0_CO, DEFAULT_R0_NO2, DEFAULT_R0_C2H5OH, DEFAULT_R0_VOC };
+        float sum = 0;
+        for (uint8_t ch = 0; ch < GAS_PPM_CHANNELS; ch++) sum += gasCurvePpm(ch, adcToRs(adc[ch]), r0[ch]);
+        benchSink += (uint32_t)sum;
+    });
+    assertNoRegression(lookup);
+    assertNoRegression(curve);
+    TEST_ASSERT_TRUE_MESSAGE(lookup.nsPerOp * 2 < curve.nsPerOp, "查表应明显快于每次按曲线计算");
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_reference_curve);
+    RUN_TEST(test_calculate_ppm_uses_table);
+    RUN_TEST(test_quantization_error_within_half_lsb);
+    RUN_TEST(test_rs_adc_round_trip);
+    RUN_TEST(test_curves_are_monotonic);
+    RUN_TEST(test_invalid_inputs);
+    RUN_TEST(bench_table_build);
+    RUN_TEST(bench_lookup_vs_curve);
+    return UNITY_END();
+}
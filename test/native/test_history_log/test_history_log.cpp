@@ -0,0 +1,217 @@
+// ==========================================================================
+// == 追加式记录日志: 掉电恢复和写放大 ==
+// == 文件系统替身映射到主机临时目录; 用写入预算在记录 (以及恢复时的截断重写)
+// == 的每一个字节偏移处模拟掉电, 重新上电后恢复的必须正好是已完整写入的记录.
+// ==========================================================================
+
+#include <unity.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "history_log.h"
+
+#define TEST_LOG_PREFIX "/test_log"
+#define TEST_PAYLOAD_SIZE 24          // 与历史记录负载相同
+#define TEST_SEGMENTS 4
+#define TEST_RECORDS_PER_SEGMENT 8
+#define TEST_MAX_RECORDS (TEST_SEGMENTS * TEST_RECORDS_PER_SEGMENT)
+
+struct Recovered {
+    uint32_t index[TEST_MAX_RECORDS];
+    uint32_t seq[TEST_MAX_RECORDS];
+    size_t count;
+    bool corrupt;
+};
+
+// 负载由记录编号确定, 恢复时逐字节校验
+static void makePayload(uint32_t index, uint8_t* payload) {
+    memcpy(payload, &index, sizeof(index));
+    for (size_t k = sizeof(index); k < TEST_PAYLOAD_SIZE; k++) payload[k] = (uint8_t)(index * 31 + k);
+}
+
+static void collect(const uint8_t* payload, uint32_t seq, void* ctx) {
+    Recovered* out = static_cast<Recovered*>(ctx);
+    uint32_t index;
+    memcpy(&index, payload, sizeof(index));
+    uint8_t expected[TEST_PAYLOAD_SIZE];
+    makePayload(index, expected);
+    if (memcmp(expected, payload, TEST_PAYLOAD_SIZE) != 0 || out->count >= TEST_MAX_RECORDS) {
+        out->corrupt = true;
+        return;
+    }
+    out->index[out->count] = index;
+    out->seq[out->count] = seq;
+    out->count++;
+}
+
+static RecordLog makeLog() {
+    return RecordLog(TEST_LOG_PREFIX, TEST_PAYLOAD_SIZE, TEST_SEGMENTS, TEST_RECORDS_PER_SEGMENT);
+}
+
+static bool appendIndex(RecordLog& log, uint32_t index) {
+    uint8_t payload[TEST_PAYLOAD_SIZE];
+    makePayload(index, payload);
+    return log.append(payload);
+}
+
+// 模拟重新启动: 新的日志对象扫描全部分段
+static Recovered reboot(RecordLog& log) {
+    Recovered out;
+    memset(&out, 0, sizeof(out));
+    const size_t recovered = log.recover(SPIFFS, collect, &out);
+    TEST_ASSERT_EQUAL_UINT32(recovered, out.count);
+    return out;
+}
+
+// 恢复出的必须是 0..lastIndex 中最新的一段连续记录, 且至少保留 (分段数-1) 个分段
+static void assertRecoveredUpTo(const Recovered& r, uint32_t lastIndex, uint32_t total) {
+    TEST_ASSERT_FALSE(r.corrupt);
+    const uint32_t minKept = total < (TEST_SEGMENTS - 1) * TEST_RECORDS_PER_SEGMENT ? total : (TEST_SEGMENTS - 1) * TEST_RECORDS_PER_SEGMENT;
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(minKept, r.count);
+    if (total == 0) {
+        TEST_ASSERT_EQUAL_UINT32(0, r.count);
+        return;
+    }
+    TEST_ASSERT_EQUAL_UINT32(lastIndex, r.index[r.count - 1]);
+    for (size_t i = 1; i < r.count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(r.index[i - 1] + 1, r.index[i]);
+        TEST_ASSERT_EQUAL_UINT32(r.seq[i - 1] + 1, r.seq[i]);
+    }
+}
+
+void setUp() {
+    shimFsPowerOn();
+    shimFsFormat();
+}
+
+void tearDown() {
+    shimFsPowerOn();
+}
+
+static void test_recover_after_clean_shutdown() {
+    {
+        RecordLog log = makeLog();
+        reboot(log);
+        for (uint32_t i = 0; i < 20; i++) TEST_ASSERT_TRUE(appendIndex(log, i));
+    }
+    RecordLog log = makeLog();
+    const Recovered r = reboot(log);
+    TEST_ASSERT_EQUAL_UINT32(20, r.count);
+    assertRecoveredUpTo(r, 19, 20);
+    TEST_ASSERT_EQUAL_UINT32(20, log.nextSeq());
+}
+
+// 轮转多圈后只保留最新的分段, 序号继续递增
+static void test_recover_after_wraparound() {
+    {
+        RecordLog log = makeLog();
+        reboot(log);
+        for (uint32_t i = 0; i < 100; i++) TEST_ASSERT_TRUE(appendIndex(log, i));
+    }
+    RecordLog log = makeLog();
+    const Recovered r = reboot(log);
+    assertRecoveredUpTo(r, 99, 100);
+    TEST_ASSERT_EQUAL_UINT32(100, log.nextSeq());
+}
+
+// 在第 before+1 条记录的每一个字节偏移处掉电: 恢复出前 before 条, 之后继续追加不受影响.
+// before 覆盖: 空日志, 分段中间, 分段刚满 (掉电的记录是新分段的第一条), 已轮转
+static void test_torn_append_at_every_offset() {
+    const uint32_t prefixes[] = { 0, 3, TEST_RECORDS_PER_SEGMENT, TEST_RECORDS_PER_SEGMENT * TEST_SEGMENTS + 5 };
+    const size_t recSize = makeLog().recordSize();
+    for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+        const uint32_t before = prefixes[p];
+        for (size_t offset = 0; offset < recSize; offset++) {
+            shimFsPowerOn();
+            shimFsFormat();
+            {
+                RecordLog log = makeLog();
+                reboot(log);
+                for (uint32_t i = 0; i < before; i++) TEST_ASSERT_TRUE(appendIndex(log, i));
+                shimFsSetWriteBudget((long)offset);
+                TEST_ASSERT_FALSE(appendIndex(log, before)); // 只写入了 offset 字节
+                TEST_ASSERT_TRUE(shimFsPoweredOff());
+            }
+            shimFsPowerOn();
+
+            RecordLog log = makeLog();
+            const Recovered r = reboot(log);
+            assertRecoveredUpTo(r, before - 1, before);
+            TEST_ASSERT_EQUAL_UINT32(before, log.nextSeq());
+
+            // 恢复后继续追加, 再次重启时新旧记录连续
+            for (uint32_t i = before; i < before + 3; i++) TEST_ASSERT_TRUE(appendIndex(log, i));
+            RecordLog again = makeLog();
+            assertRecoveredUpTo(reboot(again), before + 2, before + 3);
+        }
+    }
+}
+
+// 恢复时截断残缺分段 (重写有效前缀) 的过程中再次掉电: 原分段不受影响, 下次恢复结果相同
+static void test_torn_recovery_rewrite_at_every_offset() {
+    const uint32_t before = 5;
+    const size_t recSize = makeLog().recordSize();
+    for (size_t offset = 0; offset < before * recSize; offset++) {
+        shimFsPowerOn();
+        shimFsFormat();
+        {
+            RecordLog log = makeLog();
+            reboot(log);
+            for (uint32_t i = 0; i < before; i++) TEST_ASSERT_TRUE(appendIndex(log, i));
+            shimFsSetWriteBudget((long)recSize / 2);
+            TEST_ASSERT_FALSE(appendIndex(log, before));
+        }
+        shimFsPowerOn();
+        {
+            shimFsSetWriteBudget((long)offset);
+            RecordLog log = makeLog();
+            Recovered r;
+            memset(&r, 0, sizeof(r));
+            log.recover(SPIFFS, collect, &r);
+            assertRecoveredUpTo(r, before - 1, before); // 回放在重写之前完成
+        }
+        shimFsPowerOn();
+
+        RecordLog log = makeLog();
+        assertRecoveredUpTo(reboot(log), before - 1, before);
+        TEST_ASSERT_TRUE(appendIndex(log, before));
+        RecordLog again = makeLog();
+        const Recovered r = reboot(again);
+        assertRecoveredUpTo(r, before, before + 1);
+        TEST_ASSERT_EQUAL_UINT32(before + 1, r.count);
+    }
+}
+
+// 写放大: 每次追加只写入一条记录 (记录头 + 负载 + CRC), 与历史长度和分段轮转无关
+static void test_bytes_written_per_append() {
+    RecordLog log = makeLog();
+    reboot(log);
+    const size_t recSize = log.recordSize();
+    TEST_ASSERT_EQUAL_UINT32(TEST_PAYLOAD_SIZE + sizeof(RecordLogHeader) + sizeof(uint32_t), recSize);
+
+    const uint32_t appends = 1000; // 约 31 圈轮转
+    shimFsResetBytesWritten();
+    uint64_t lastRound = 0;
+    for (uint32_t i = 0; i < appends; i++) {
+        if (i == appends - 100) lastRound = shimFsBytesWritten();
+        TEST_ASSERT_TRUE(appendIndex(log, i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(appends * recSize, (uint32_t)shimFsBytesWritten());
+    TEST_ASSERT_EQUAL_UINT32(100 * recSize, (uint32_t)(shimFsBytesWritten() - lastRound));
+    TEST_ASSERT_EQUAL_UINT32(appends * recSize, log.totalBytesWritten());
+
+    // 干净关机后的恢复不写入任何数据
+    shimFsResetBytesWritten();
+    RecordLog again = makeLog();
+    assertRecoveredUpTo(reboot(again), appends - 1, appends);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)shimFsBytesWritten());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recover_after_clean_shutdown);
+    RUN_TEST(test_recover_after_wraparound);
+    RUN_TEST(test_torn_append_at_every_offset);
+    RUN_TEST(test_torn_recovery_rewrite_at_every_offset);
+    RUN_TEST(test_bytes_written_per_append);
+    return UNITY_END();
+}
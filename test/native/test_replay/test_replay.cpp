@@ -0,0 +1,400 @@
+// ==========================================================================
+// == 模拟数据源和现场记录回放 ==
+// == 用虚拟时钟驱动 过采样 -> 上报 -> 警报 -> 蜂鸣器 -> 历史 整条处理流程.
+// == 回放外部记录: REPLAY_TRACE=<csv 或二进制文件> pio test -e native -f native/test_replay -v
+// == (REPLAY_ALARM_OUT / REPLAY_HISTORY_OUT 指定输出文件, 默认输出到 stdout)
+// ==========================================================================
+
+#include <unity.h>
+#include "trace_replay.h"
+#include "sensor_pipeline.h"
+#include "sensor_simulator.h"
+#include "gas_ppm.h"
+
+static HistoryBuffer hist;
+
+static ReplayOptions makeOptions(unsigned long durationMs, unsigned long warmupMs) {
+    ReplayOptions options = { durationMs, warmupMs, NULL, NULL };
+    return options;
+}
+
+// 读取 tmpfile() 的全部内容 (测试输出只有几 KB)
+static const char* readBack(FILE* f) {
+    static char text[16384];
+    rewind(f);
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    text[n] = '\0';
+    return text;
+}
+
+// 事件流中 p 所在行的时间字段
+static unsigned long eventTime(const char* text, const char* p) {
+    while (p > text && p[-1] != '\n') p--;
+    return strtoul(p, NULL, 10);
+}
+
+static TraceRecord makeRecord(uint32_t timeMs, float temperature, float humidity, float rsScale) {
+    TraceRecord rec = { timeMs, temperature, humidity,
+                        { DEFAULT_R0_CO * rsScale, DEFAULT_R0_NO2, DEFAULT_R0_C2H5OH, DEFAULT_R0_VOC } };
+    return rec;
+}
+
+void setUp() {
+    hist.clear();
+    publishSensorParams(DeviceConfig());
+}
+
+void tearDown() {
+    setSensorSource(NULL);
+}
+
+// -- 记录格式 --
+
+static void test_csv_and_binary_round_trip() {
+    TraceRecord records[3] = { makeRecord(0, 24.5f, 40.0f, 1.0f), makeRecord(1500, NAN, NAN, 0.5f),
+                               makeRecord(4000, -3.0f, 95.5f, 1.25f) };
+    records[2].rs[GAS_CH_VOC] = NAN;
+
+    FILE* csv = tmpfile();
+    FILE* bin = tmpfile();
+    TEST_ASSERT_TRUE(traceWriteCsv(csv, records, 3));
+    TEST_ASSERT_TRUE(traceWriteBinary(bin, records, 3));
+    rewind(csv);
+    rewind(bin);
+
+    TraceRecord fromCsv[4], fromBin[4];
+    TEST_ASSERT_EQUAL_UINT32(3, traceReadCsv(csv, fromCsv, 4));
+    TEST_ASSERT_EQUAL_UINT32(3, traceReadBinary(bin, fromBin, 4));
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(records[i].timeMs, fromCsv[i].timeMs);
+        TEST_ASSERT_EQUAL_MEMORY(&records[i], &fromBin[i], sizeof(TraceRecord)); // 二进制逐位保留 (包括 NaN)
+        const float expected[6] = { records[i].temperature, records[i].humidity,
+                                    records[i].rs[0], records[i].rs[1], records[i].rs[2], records[i].rs[3] };
+        const float actual[6] = { fromCsv[i].temperature, fromCsv[i].humidity,
+                                  fromCsv[i].rs[0], fromCsv[i].rs[1], fromCsv[i].rs[2], fromCsv[i].rs[3] };
+        for (size_t f = 0; f < 6; f++) {
+            if (isnan(expected[f])) TEST_ASSERT_TRUE(isnan(actual[f]));
+            else TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected[f], actual[f]);
+        }
+    }
+    fclose(csv);
+    fclose(bin);
+}
+
+static void test_rejects_malformed_traces() {
+    TraceRecord out[4];
+    FILE* f = tmpfile();
+    fputs(TRACE_CSV_HEADER "\n2000,24,40,20,10,2,50\n1000,24,40,20,10,2,50\n", f); // 时间倒退
+    rewind(f);
+    TEST_ASSERT_EQUAL_UINT32(0, traceReadCsv(f, out, 4));
+    fclose(f);
+
+    f = tmpfile();
+    TraceRecord rec = makeRecord(0, 20, 50, 1.0f);
+    traceWriteBinary(f, &rec, 1);
+    fwrite("xx", 1, 2, f); // 截断的第二条记录
+    rewind(f);
+    TEST_ASSERT_EQUAL_UINT32(0, traceReadBinary(f, out, 4));
+    fclose(f);
+}
+
+// -- 模拟数据源 --
+
+static void test_simulator_clean_air_has_no_alarms() {
+    simulatorBegin(DEFAULT_SIMULATOR_PROFILE);
+    FILE* alarms = tmpfile();
+    ReplayOptions options = makeOptions(10 * 60000UL, 30000);
+    options.alarmOut = alarms;
+    const ReplaySummary summary = replayRun(SIMULATED_SENSOR_SOURCE, options, hist);
+
+    TEST_ASSERT_EQUAL_UINT32(10 * 60000UL / SENSOR_READ_INTERVAL_MS, summary.reports);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.warnings);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.buzzerBeeps);
+    TEST_ASSERT_EQUAL_UINT32(summary.reports - 1, summary.historyPoints); // 第一个周期还没有温湿度读数, 不记录
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasCoStatus);
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.tempStatus);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, DEFAULT_R0_CO, summary.finalState.gasRsValues.co);
+    TEST_ASSERT_EQUAL_STRING("hardware", getSensorSource().name); // 回放结束后恢复硬件数据源
+
+    // 预热结束时各气体通道从 initializing 变为 normal
+    const char* text = readBack(alarms);
+    TEST_ASSERT_NOT_NULL(strstr(text, "30000,co,normal,"));
+    TEST_ASSERT_NULL(strstr(text, "warning"));
+    fclose(alarms);
+}
+
+static void test_simulator_gas_event_raises_and_clears_alarm() {
+    const float rsFactor = 0.05f;
+    TEST_ASSERT_TRUE(gasCurvePpm(GAS_CH_CO, DEFAULT_R0_CO * rsFactor, DEFAULT_R0_CO) > DEFAULT_CO_PPM_MAX);
+    simulatorBegin(DEFAULT_SIMULATOR_PROFILE);
+    TEST_ASSERT_TRUE(simulatorInjectGas(GAS_CH_CO, rsFactor, 60000, 20000));
+
+    FILE* alarms = tmpfile();
+    ReplayOptions options = makeOptions(120000, 10000);
+    options.alarmOut = alarms;
+    const ReplaySummary summary = replayRun(SIMULATED_SENSOR_SOURCE, options, hist);
+
+    TEST_ASSERT_EQUAL_UINT32(1, summary.warnings);
+    TEST_ASSERT_EQUAL_UINT32(BUZZER_ALARM_COUNT, summary.buzzerBeeps); // 一轮报警只响固定次数
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasCoStatus);
+    TEST_ASSERT_FALSE(summary.finalState.buzzerShouldBeActive);
+
+    const char* text = readBack(alarms);
+    const char* warning = strstr(text, ",co,warning,");
+    const char* cleared = strstr(text, ",co,normal,");
+    const char* beep = strstr(text, ",buzzer,on,");
+    TEST_ASSERT_NOT_NULL(warning);
+    TEST_ASSERT_NOT_NULL(beep);
+    TEST_ASSERT_TRUE(warning < beep);
+    // 第一次 normal 是预热结束, 报警解除是 warning 之后的那一次
+    TEST_ASSERT_NOT_NULL(strstr(warning, ",co,normal,"));
+    TEST_ASSERT_TRUE(cleared < warning);
+    const unsigned long warnAt = eventTime(text, warning);
+    TEST_ASSERT_TRUE(warnAt >= 60000 && warnAt <= 62000 + SENSOR_READ_INTERVAL_MS); // 滤波延迟不超过一个上报周期
+    fclose(alarms);
+}
+
+// 校准和基线跟踪只使用传入的时间: 虚拟时钟下在预热结束后按样本数完成
+static void test_calibration_runs_on_virtual_time() {
+    simulatorBegin(DEFAULT_SIMULATOR_PROFILE);
+    const uint32_t revision = getR0Revision();
+    startCalibration();
+    const ReplaySummary summary = replayRun(SIMULATED_SENSOR_SOURCE, makeOptions(40000, 20000), hist);
+
+    const CalibrationStatus status = getCalibrationStatus();
+    TEST_ASSERT_EQUAL_INT(CAL_COMPLETED, status.state);
+    TEST_ASSERT_EQUAL_UINT32(revision + 1, getR0Revision());
+    const SensorParams params = getSensorParams();
+    TEST_ASSERT_FLOAT_WITHIN(DEFAULT_R0_CO * 0.02f, DEFAULT_R0_CO, params.r0Values.co);
+    TEST_ASSERT_FLOAT_WITHIN(DEFAULT_R0_VOC * 0.02f, DEFAULT_R0_VOC, params.r0Values.voc);
+    TEST_ASSERT_EQUAL_MEMORY(&params.r0Values, &params.r0Calibrated, sizeof(GasResistData));
+    TEST_ASSERT_EQUAL_UINT32(20, summary.reports);
+}
+
+// 聚合层以定点值保存: 还原后与原始历史点的统计一致 (误差不超过分辨率的一半), 样本数饱和于255
+static void test_rollups_store_compact_values() {
+    clearRollupHistory();
+    simulatorBegin(DEFAULT_SIMULATOR_PROFILE);
+    replayRun(SIMULATED_SENSOR_SOURCE, makeOptions(10 * 60000UL, 30000), hist);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(9, minuteRollups.count());
+
+    // 最新的已结束分钟桶, 与原始缓冲区中同一分钟的点对比
+    const RollupDataPoint& rp = minuteRollups.newest();
+    float sumCo = 0, minCo = INFINITY, maxCo = -INFINITY, sumTemp = 0;
+    uint32_t n = 0;
+    for (size_t i = 0; i < hist.count(); i++) {
+        const SensorDataPoint& dp = hist[i];
+        if (dp.timestamp < rp.timestamp || dp.timestamp >= rp.timestamp + 60000UL) continue;
+        sumCo += dp.gas.co;
+        sumTemp += dp.temp;
+        minCo = min(minCo, dp.gas.co);
+        maxCo = max(maxCo, dp.gas.co);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(60000 / SENSOR_READ_INTERVAL_MS, n);
+    TEST_ASSERT_EQUAL_UINT8(n, rp.count[RC_CO]);
+    TEST_ASSERT_FLOAT_WITHIN(0.051f, sumCo / n, rollupDecode(RC_CO, rp.avg[RC_CO]));
+    TEST_ASSERT_FLOAT_WITHIN(0.051f, minCo, rollupDecode(RC_CO, rp.min[RC_CO]));
+    TEST_ASSERT_FLOAT_WITHIN(0.051f, maxCo, rollupDecode(RC_CO, rp.max[RC_CO]));
+    TEST_ASSERT_FLOAT_WITHIN(0.0051f, sumTemp / n, rollupDecode(RC_TEMP, rp.avg[RC_TEMP]));
+
+    // 未结束的小时桶已累计约 300 个样本
+    const RollupDataPoint* hour = getOpenRollup(TIER_HOUR);
+    TEST_ASSERT_NOT_NULL(hour);
+    TEST_ASSERT_EQUAL_UINT8(UINT8_MAX, hour->count[RC_TEMP]);
+    TEST_ASSERT_TRUE(hour->min[RC_CO] <= hour->avg[RC_CO] && hour->avg[RC_CO] <= hour->max[RC_CO]);
+}
+
+// -- 现场记录回放 --
+
+static void test_trace_replay_streams() {
+    // 0~30s 洁净, 30s 起温度超限 10 秒, 40s 起温湿度传感器断开, 50s 恢复
+    TraceRecord records[5] = { makeRecord(0, 25, 50, 1.0f), makeRecord(30000, 36, 50, 1.0f),
+                               makeRecord(40000, NAN, NAN, 1.0f), makeRecord(50000, 25, 50, 1.0f),
+                               makeRecord(60000, 25, 50, 1.0f) };
+    FILE* csv = tmpfile();
+    traceWriteCsv(csv, records, 5);
+    rewind(csv);
+    TraceRecord loaded[8];
+    const size_t count = traceReadCsv(csv, loaded, 8);
+    fclose(csv);
+    TEST_ASSERT_EQUAL_UINT32(5, count);
+    traceSourceBegin(loaded, count);
+
+    FILE* alarms = tmpfile();
+    FILE* history = tmpfile();
+    ReplayOptions options = makeOptions(70000, 5000);
+    options.alarmOut = alarms;
+    options.historyOut = history;
+    const ReplaySummary summary = replayRun(TRACE_SENSOR_SOURCE, options, hist);
+
+    // 温湿度读数滞后一个上报周期 (与 DHT 的异步读取一致)
+    const char* alarmText = readBack(alarms);
+    TEST_ASSERT_NOT_NULL(strstr(alarmText, "32000,temperature,warning,36.000\n"));
+    TEST_ASSERT_NOT_NULL(strstr(alarmText, "42000,temperature,disconnected,"));
+    TEST_ASSERT_NOT_NULL(strstr(alarmText, "52000,temperature,normal,25.000\n"));
+    TEST_ASSERT_EQUAL_UINT32(1, summary.warnings);
+
+    // 每一声 (包括最后一声) 都响满 BUZZER_ALARM_DURATION
+    const char* on = alarmText;
+    for (int beep = 0; beep < BUZZER_ALARM_COUNT; beep++) {
+        on = strstr(on, ",buzzer,on,");
+        TEST_ASSERT_NOT_NULL(on);
+        const char* off = strstr(on, ",buzzer,off,");
+        TEST_ASSERT_NOT_NULL(off);
+        TEST_ASSERT_EQUAL_UINT32(BUZZER_ALARM_DURATION, eventTime(alarmText, off) - eventTime(alarmText, on));
+        on = off;
+    }
+    TEST_ASSERT_NULL(strstr(on, ",buzzer,on,"));
+
+    const char* historyText = readBack(history);
+    TEST_ASSERT_NOT_NULL(strstr(historyText, "time_ms,time_str,temp,hum,co,no2,c2h5oh,voc\n"));
+    TEST_ASSERT_NOT_NULL(strstr(historyText, "\n32000,00:00:32,36,50,"));
+    TEST_ASSERT_EQUAL_UINT32(summary.historyPoints, hist.count());
+    TEST_ASSERT_EQUAL_UINT32(70000UL, hist.newest().timestamp);
+    fclose(alarms);
+    fclose(history);
+}
+
+// 上报周期的最后一次气体读取失败: 只丢弃这一个样本, 通道状态不变
+static void test_single_failed_gas_read_keeps_status() {
+    TraceRecord records[3] = { makeRecord(0, 25, 50, 1.0f), makeRecord(22000, 25, 50, 1.0f),
+                               makeRecord(22000 + GAS_OVERSAMPLE_INTERVAL_MS, 25, 50, 1.0f) };
+    records[1].rs[GAS_CH_CO] = NAN; // 22000 的上报周期恰好在这次读取之后结束
+    traceSourceBegin(records, 3);
+
+    FILE* alarms = tmpfile();
+    ReplayOptions options = makeOptions(30000, 5000);
+    options.alarmOut = alarms;
+    const ReplaySummary summary = replayRun(TRACE_SENSOR_SOURCE, options, hist);
+
+    const char* text = readBack(alarms);
+    TEST_ASSERT_NULL(strstr(text, "disconnected"));
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasCoStatus);
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasVocStatus);
+    TEST_ASSERT_FLOAT_WITHIN(DEFAULT_R0_CO * 0.02f, DEFAULT_R0_CO, summary.finalState.gasRsValues.co);
+    fclose(alarms);
+}
+
+// -- 气体传感器离线与重新探测 --
+// 按 gas_sensor.cpp 的采集层行为模拟总线: 读取失败后标记离线, 按指数退避间隔重新探测,
+// 期间返回 GAS_READ_ABSENT 且不访问总线. 传感器在 [BUS_OUTAGE_START, BUS_OUTAGE_END) 内无响应,
+// 恢复后 Rs 变为洁净值的 BUS_RECOVERED_RS_SCALE 倍
+
+#define BUS_OUTAGE_START 30000UL
+#define BUS_OUTAGE_END 40000UL
+#define BUS_RECOVERED_RS_SCALE 0.8f
+
+static bool busPresent;
+static uint32_t busConsecutiveFailures;
+static uint32_t busProbes;
+static unsigned long busNextRetryTime;
+
+static void busBegin() {
+    busPresent = true;
+    busConsecutiveFailures = 0;
+    busProbes = 0;
+    busNextRetryTime = 0;
+}
+
+static GasReadResult readFlakyGas(GasRawReading& out) {
+    const unsigned long now = millis();
+    if (!busPresent && (long)(now - busNextRetryTime) < 0) return GAS_READ_ABSENT;
+    if (!busPresent) busProbes++;
+    if (now >= BUS_OUTAGE_START && now < BUS_OUTAGE_END) {
+        uint32_t interval = GAS_SENSOR_RETRY_MIN_MS;
+        for (uint32_t i = 0; i < busConsecutiveFailures && interval < GAS_SENSOR_RETRY_MAX_MS; i++) interval *= 2;
+        busPresent = false;
+        busConsecutiveFailures++;
+        busNextRetryTime = now + min(interval, (uint32_t)GAS_SENSOR_RETRY_MAX_MS);
+        return GAS_READ_FAILED;
+    }
+    busPresent = true;
+    busConsecutiveFailures = 0;
+    const float scale = now >= BUS_OUTAGE_END ? BUS_RECOVERED_RS_SCALE : 1.0f;
+    out.co = (uint32_t)rsToAdc(DEFAULT_R0_CO * scale);
+    out.no2 = (uint32_t)rsToAdc(DEFAULT_R0_NO2);
+    out.c2h5oh = (uint32_t)rsToAdc(DEFAULT_R0_C2H5OH);
+    out.voc = (uint32_t)rsToAdc(DEFAULT_R0_VOC);
+    return GAS_READ_OK;
+}
+
+static DhtRmtResult fetchNoDht(DhtReading& out) { return DHT_RMT_NONE; }
+static void startNoDht() {}
+
+static const SensorSource FLAKY_BUS_SOURCE = { "flaky-bus", readFlakyGas, fetchNoDht, startNoDht };
+
+// 离线 -> 退避重新探测 -> 恢复: 整个上报周期没有成功读取时发布断开, 重新探测成功后的
+// 第一个周期恢复为正常, 且读数只来自恢复后的样本 (不与离线前的滤波状态混合)
+static void test_gas_absent_reprobe_recovers() {
+    busBegin();
+    FILE* alarms = tmpfile();
+    ReplayOptions options = makeOptions(60000, 5000);
+    options.alarmOut = alarms;
+    const ReplaySummary summary = replayRun(FLAKY_BUS_SOURCE, options, hist);
+
+    // 30000 失败后在 32000, 36000 重新探测 (均失败), 44000 探测成功
+    TEST_ASSERT_EQUAL_UINT32(3, busProbes);
+    const char* text = readBack(alarms);
+    const char* lost = strstr(text, "\n32000,co,disconnected,");
+    TEST_ASSERT_NOT_NULL(lost);
+    TEST_ASSERT_NULL(strstr(text, "\n30000,co,disconnected,")); // 失败前本周期已有的样本照常输出
+    const char* back = strstr(lost, ",co,normal,");
+    TEST_ASSERT_NOT_NULL(back);
+    TEST_ASSERT_EQUAL_UINT32(44000, eventTime(text, back));
+
+    const float expectedPpm = gasCurvePpm(GAS_CH_CO, DEFAULT_R0_CO * BUS_RECOVERED_RS_SCALE, DEFAULT_R0_CO);
+    const float recoveredPpm = strtof(back + strlen(",co,normal,"), NULL);
+    TEST_ASSERT_FLOAT_WITHIN(expectedPpm * 0.05f, expectedPpm, recoveredPpm);
+
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasCoStatus);
+    TEST_ASSERT_EQUAL_INT(SS_NORMAL, summary.finalState.gasVocStatus);
+    TEST_ASSERT_FLOAT_WITHIN(DEFAULT_R0_CO * 0.02f, DEFAULT_R0_CO * BUS_RECOVERED_RS_SCALE, summary.finalState.gasRsValues.co);
+    fclose(alarms);
+}
+
+// 外部记录: 未设置 REPLAY_TRACE 时跳过
+static void test_replay_external_trace() {
+    const char* path = getenv("REPLAY_TRACE");
+    if (!path || !*path) TEST_IGNORE_MESSAGE("未设置 REPLAY_TRACE");
+
+    const size_t maxRecords = 1000000;
+    TraceRecord* records = (TraceRecord*)malloc(maxRecords * sizeof(TraceRecord));
+    TEST_ASSERT_NOT_NULL(records);
+    const size_t count = traceLoad(path, records, maxRecords);
+    TEST_ASSERT_TRUE_MESSAGE(count > 0, "无法读取记录 (格式错误或时间倒退)");
+    traceSourceBegin(records, count);
+
+    const char* alarmPath = getenv("REPLAY_ALARM_OUT");
+    const char* historyPath = getenv("REPLAY_HISTORY_OUT");
+    FILE* alarms = alarmPath ? fopen(alarmPath, "w") : stdout;
+    FILE* history = historyPath ? fopen(historyPath, "w") : stdout;
+    TEST_ASSERT_NOT_NULL(alarms);
+    TEST_ASSERT_NOT_NULL(history);
+
+    ReplayOptions options = makeOptions(records[count - 1].timeMs + SENSOR_READ_INTERVAL_MS, GAS_SENSOR_WARMUP_PERIOD_MS);
+    options.alarmOut = alarms;
+    options.historyOut = history;
+    const ReplaySummary summary = replayRun(TRACE_SENSOR_SOURCE, options, hist);
+    printf("[REPLAY] %u 条记录, %u 个上报周期, %u 次报警, 蜂鸣器响 %u 次, %u 个历史点\n", (unsigned)count,
+           summary.reports, summary.warnings, summary.buzzerBeeps, summary.historyPoints);
+
+    if (alarms != stdout) fclose(alarms);
+    if (history != stdout) fclose(history);
+    free(records);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_csv_and_binary_round_trip);
+    RUN_TEST(test_rejects_malformed_traces);
+    RUN_TEST(test_simulator_clean_air_has_no_alarms);
+    RUN_TEST(test_simulator_gas_event_raises_and_clears_alarm);
+    RUN_TEST(test_calibration_runs_on_virtual_time);
+    RUN_TEST(test_rollups_store_compact_values);
+    RUN_TEST(test_trace_replay_streams);
+    RUN_TEST(test_single_failed_gas_read_keeps_status);
+    RUN_TEST(test_gas_absent_reprobe_recovers);
+    RUN_TEST(test_replay_external_trace);
+    return UNITY_END();
+}
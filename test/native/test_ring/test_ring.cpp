@@ -0,0 +1,190 @@
+// ==========================================================================
+// == 环形缓冲区 ==
+// == 视图/迭代的正确性 (包括写满且起点不在缓冲区开头的情况), 以及与原先
+// == CircularBuffer (std::vector + 每次 getData() 复制) 的吞吐量和内存对比.
+// ==========================================================================
+
+#include <unity.h>
+#include <vector>
+#include "bench.h"
+#include "alloc_counter.h"
+#include "ring_buffer.h"
+#include "data_manager.h"
+
+static void assertNoRegression(const BenchResult& result) {
+    char message[192];
+    TEST_ASSERT_TRUE_MESSAGE(benchCheck(result, message, sizeof(message)), message);
+}
+
+// 按视图迭代和按下标访问得到的序列必须都是 first, first+1, ..., first+expected-1
+template <typename View>
+static void assertSequence(const View& view, size_t expected, int first) {
+    TEST_ASSERT_EQUAL_UINT32(expected, view.size());
+    size_t visited = 0;
+    for (typename View::Iterator it = view.begin(); it != view.end(); ++it) {
+        TEST_ASSERT_EQUAL_INT(first + (int)visited, *it);
+        visited++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(expected, visited);
+    for (size_t i = 0; i < expected; i++) TEST_ASSERT_EQUAL_INT(first + (int)i, view[i]);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_view_empty_and_partial() {
+    Ring<int, 8> ring;
+    assertSequence(ring.view(), 0, 0);
+    TEST_ASSERT_TRUE(ring.view().begin() == ring.view().end());
+    for (int i = 0; i < 5; i++) ring.push(i);
+    assertSequence(ring.view(), 5, 0);
+}
+
+// 回归: 写满且起点不在缓冲区开头时, 第二段末尾与第一段开头地址相同, 原先 begin() == end()
+static void test_view_full_with_offset_start() {
+    Ring<int, 8> ring;
+    for (int offset = 0; offset < 8; offset++) {
+        ring.clear();
+        for (int i = 0; i < 8 + offset; i++) ring.push(i);
+        TEST_ASSERT_TRUE(ring.isFull());
+        const RingView<int> view = ring.view();
+        TEST_ASSERT_EQUAL_UINT32(8 - offset, view.firstLen);
+        TEST_ASSERT_EQUAL_UINT32(offset, view.secondLen);
+        TEST_ASSERT_TRUE(view.begin() != view.end());
+        assertSequence(view, 8, offset);
+    }
+}
+
+// SPSC 模式: 消费一部分后视图从中间开始并回绕
+static void test_spsc_view_after_consume() {
+    Ring<int, 8, RING_SPSC> queue;
+    for (int i = 0; i < 8; i++) TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_FALSE(queue.push(8));
+    queue.consume(5);
+    for (int i = 8; i < 13; i++) TEST_ASSERT_TRUE(queue.push(i));
+    assertSequence(queue.view(), 8, 5);
+    int item;
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_INT(5, item);
+    assertSequence(queue.view(), 7, 6);
+}
+
+static void test_overwrite_keeps_newest() {
+    Ring<int, 4> ring;
+    for (int i = 0; i < 11; i++) ring.push(i);
+    TEST_ASSERT_EQUAL_UINT32(4, ring.count());
+    TEST_ASSERT_EQUAL_INT(10, ring.newest());
+    TEST_ASSERT_EQUAL_INT(7, ring[0]);
+    assertSequence(ring.view(), 4, 7);
+}
+
+// ==========================================================================
+// == 对比基准: 原先的历史缓冲区 ==
+// == 与改动前 data_manager 中的 CircularBuffer 相同: 存储在 std::vector 中,
+// == getData() 每次按时间顺序复制全部元素到另一个 vector.
+// ==========================================================================
+
+class LegacyCircularBuffer {
+public:
+    LegacyCircularBuffer(size_t size) : maxSize(size), head(0), tail(0), full(false) { buffer.resize(size); }
+
+    void add(const SensorDataPoint& item) {
+        buffer[head] = item;
+        if (full) tail = (tail + 1) % maxSize;
+        head = (head + 1) % maxSize;
+        full = (head == tail);
+    }
+
+    const std::vector<SensorDataPoint>& getData() const {
+        orderedData.clear();
+        if (!full && head == tail) return orderedData;
+        if (full) {
+            for (size_t i = 0; i < maxSize; ++i) orderedData.push_back(buffer[(tail + i) % maxSize]);
+        } else {
+            for (size_t i = tail; i != head; i = (i + 1) % maxSize) orderedData.push_back(buffer[i]);
+        }
+        return orderedData;
+    }
+
+    // 常驻堆内存: 数据和按序副本
+    size_t heapBytes() const { return (buffer.capacity() + orderedData.capacity()) * sizeof(SensorDataPoint); }
+
+private:
+    std::vector<SensorDataPoint> buffer;
+    mutable std::vector<SensorDataPoint> orderedData;
+    size_t maxSize, head, tail;
+    bool full;
+};
+
+static SensorDataPoint makePoint(uint32_t i) {
+    SensorDataPoint dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.timestamp = i;
+    dp.temp = (int)i;
+    return dp;
+}
+
+// 写入吞吐量
+static void bench_history_add() {
+    static HistoryBuffer ring;
+    static LegacyCircularBuffer legacy(HISTORICAL_DATA_POINTS);
+    const BenchResult r = benchRun("ring_add_history", 2000000, [&](uint32_t i) { ring.push(makePoint(i)); });
+    const BenchResult l = benchRun("legacy_add_history", 2000000, [&](uint32_t i) { legacy.add(makePoint(i)); });
+    assertNoRegression(r);
+    assertNoRegression(l);
+}
+
+// 按时间顺序遍历写满并回绕的缓冲区 (历史数据推送和统计的访问方式)
+static void bench_history_iterate() {
+    static HistoryBuffer ring;
+    static LegacyCircularBuffer legacy(HISTORICAL_DATA_POINTS);
+    for (uint32_t i = 0; i < HISTORICAL_DATA_POINTS + 7; i++) {
+        ring.push(makePoint(i));
+        legacy.add(makePoint(i));
+    }
+    const BenchResult r = benchRun("ring_iterate_history", 200000, [&](uint32_t) {
+        int sum = 0;
+        const RingView<SensorDataPoint> view = ring.view();
+        for (RingView<SensorDataPoint>::Iterator it = view.begin(); it != view.end(); ++it) sum += it->temp;
+        benchSink += sum;
+    });
+    const BenchResult l = benchRun("legacy_iterate_history", 200000, [&](uint32_t) {
+        int sum = 0;
+        const std::vector<SensorDataPoint>& data = legacy.getData();
+        for (size_t i = 0; i < data.size(); i++) sum += data[i].temp;
+        benchSink += sum;
+    });
+    assertNoRegression(r);
+    assertNoRegression(l);
+    TEST_ASSERT_TRUE_MESSAGE(r.nsPerOp * 2 < l.nsPerOp, "零拷贝遍历应明显快于每次复制");
+}
+
+// 内存: Ring 全部在对象内 (静态分配), 原实现在堆上保存数据和一份按序副本
+static void test_history_ram() {
+    const size_t ringBytes = sizeof(HistoryBuffer);
+    TEST_ASSERT_TRUE(ringBytes <= HISTORICAL_DATA_POINTS * sizeof(SensorDataPoint) + 16);
+
+    const AllocStats before = allocStats();
+    LegacyCircularBuffer* legacy = new LegacyCircularBuffer(HISTORICAL_DATA_POINTS);
+    for (uint32_t i = 0; i < HISTORICAL_DATA_POINTS; i++) legacy->add(makePoint(i));
+    benchSink += legacy->getData().size();
+    const AllocStats after = allocStats();
+    const size_t legacyBytes = sizeof(LegacyCircularBuffer) + legacy->heapBytes();
+    printf("[BENCH] 历史缓冲区内存: Ring %u B (静态), CircularBuffer %u B (堆, 填满并读取一次共分配 %u 次)\n",
+           (unsigned)ringBytes, (unsigned)legacyBytes, (unsigned)(after.count - before.count));
+    delete legacy;
+    TEST_ASSERT_TRUE(legacyBytes >= 2 * HISTORICAL_DATA_POINTS * sizeof(SensorDataPoint));
+    TEST_ASSERT_TRUE(ringBytes < legacyBytes);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_view_empty_and_partial);
+    RUN_TEST(test_view_full_with_offset_start);
+    RUN_TEST(test_spsc_view_after_consume);
+    RUN_TEST(test_overwrite_keeps_newest);
+    RUN_TEST(bench_history_add);
+    RUN_TEST(bench_history_iterate);
+    RUN_TEST(test_history_ram);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+// ==========================================================================
+// == WebSocket 广播浸泡测试 ==
+// == 在主机上运行 web_handler.cpp 的发送路径 (WiFi/WebSockets/AsyncWebServer 由 shim
+// == 中的替身代替): 多个客户端 (JSON/二进制, 不同订阅) 连接后反复发布实时数据和
+// == 历史新增点, 稳态下每次广播都不分配堆内存. 健康数据 (HTTP 与 WebSocket, 含采样
+// == 历史) 和 connectWifi 请求同样不分配. 分配只在被测调用期间统计, 写历史日志等
+// == 测试自身的准备工作不计入. TCP 发送缓冲区写满的客户端不阻塞其他客户端.
+// ==========================================================================
+
+#include <unity.h>
+#include <WebSocketsServer.h>
+#include <ESPAsyncWebServer.h>
+#include "alloc_counter.h"
+#include "web_handler.h"
+#include "data_manager.h"
+#include "health_monitor.h"
+#include "sensor_frame.h"
+
+#define CLIENT_JSON 0     // 默认订阅, JSON 增量/关键帧
+#define CLIENT_BINARY 1   // 二进制帧
+#define CLIENT_SLOW 2     // 实时数据每 5 秒一帧 (其余被合并), 另订阅历史新增点
+#define CLIENT_STALLED 3  // 默认订阅, 测试中写满其发送缓冲区
+
+static WebSocketsServer& ws() { return *WebSocketsServer::shimInstance(); }
+static AsyncWebServer& http() { return *AsyncWebServer::shimInstance(); }
+
+// 与 main loop 每个上报周期相同的调用: 发布实时数据, WiFi 状态变化时广播, 发送各客户端到期的主题
+static void networkCycle(const DeviceState& state, bool& published) {
+    published = sendSensorDataChanges(state);
+    sendWifiStatusChanges(wifiState);
+    processWebSocketSubscriptions();
+}
+
+// 温湿度和气体浓度缓慢变化, 大多数周期至少有一个字段超出死区
+static DeviceState makeState(uint32_t i) {
+    DeviceState state;
+    state.temperature = 22 + (int)(i % 7);
+    state.humidity = 45.0f + (float)(i % 11);
+    state.gasPpmValues.co = 1.0f + 0.1f * (float)(i % 13);
+    state.gasPpmValues.no2 = 0.05f + 0.02f * (float)(i % 5);
+    state.gasPpmValues.c2h5oh = 10.0f + (float)(i % 3);
+    state.gasPpmValues.voc = 0.5f + 0.1f * (float)(i % 9);
+    state.tempStatus = state.humStatus = SS_NORMAL;
+    state.gasCoStatus = state.gasNo2Status = state.gasC2h5ohStatus = state.gasVocStatus = SS_NORMAL;
+    return state;
+}
+
+static uint64_t allocsDuring(void (*fn)()) {
+    const AllocStats before = allocStats();
+    fn();
+    return allocStats().count - before.count;
+}
+
+static bool started = false;
+
+// 启动 Web 服务, 连接三个客户端并设置协议和订阅 (连接时的分配不属于稳态, 不统计)
+void setUp() {
+    if (started) return;
+    started = true;
+    initWiFiAndWebServer(currentConfig, wifiState);
+    for (uint8_t num = 0; num <= CLIENT_SLOW; num++) ws().shimConnect(num);
+
+    char request[96];
+    snprintf(request, sizeof(request), "{\"action\":\"setProtocol\",\"binary\":true,\"version\":%d}", SENSOR_FRAME_VERSION);
+    ws().shimReceive(CLIENT_BINARY, request);
+    ws().shimReceive(CLIENT_SLOW, "{\"action\":\"subscribe\",\"topics\":{\"sensor\":5000,\"historyTail\":0}}");
+
+    // 8 个任务, 采样历史写满
+    static int taskTags[HEALTH_MAX_TASKS];
+    static const char* const TASK_NAMES[HEALTH_MAX_TASKS] = { "loopTask", "IDLE0", "IDLE1", "sensorTask", "storageTask",
+                                                              "calibration", "async_tcp", "onenet" };
+    for (uint8_t i = 0; i < HEALTH_MAX_TASKS; i++) healthRegisterTask(&taskTags[i], TASK_NAMES[i], 4096);
+    for (uint32_t k = 0; k < HEALTH_HISTORY_SIZE; k++) {
+        processHealthSampling();
+        shimClockAdvanceMs(HEALTH_SAMPLE_INTERVAL_MS);
+    }
+}
+
+void tearDown() {}
+
+// 稳态: 每个上报周期 (1 秒) 发布一次, 每 10 个周期新增一个历史点
+static void test_steady_state_broadcast_allocates_nothing() {
+    if (!allocCountingAvailable()) TEST_IGNORE_MESSAGE("此平台不支持分配计数");
+    const uint32_t warmup = 100, cycles = 5000;
+    uint64_t allocs = 0;
+    uint32_t broadcasts = 0;
+    uint32_t framesBefore = 0;
+    for (uint32_t i = 0; i < warmup + cycles; i++) {
+        shimClockAdvanceMs(1000);
+        const DeviceState state = makeState(i);
+        if (i % 10 == 0) addHistoricalDataPoint(historicalData, state); // 写日志和聚合, 不统计
+        if (i == warmup) {
+            ws().shimResetStats();
+            framesBefore = ws().shimTotalFrames();
+        }
+        const AllocStats before = allocStats();
+        bool published;
+        networkCycle(state, published);
+        if (i < warmup) continue;
+        allocs += allocStats().count - before.count;
+        broadcasts += published;
+    }
+    const uint32_t frames = ws().shimTotalFrames() - framesBefore;
+    printf("[SOAK] %u 个周期, %u 次广播, 发送 %u 帧 (JSON %u, 二进制 %u, 慢客户端 %u), 堆分配 %u 次\n",
+           (unsigned)cycles, (unsigned)broadcasts, (unsigned)frames, (unsigned)ws().shimStats(CLIENT_JSON).textFrames,
+           (unsigned)ws().shimStats(CLIENT_BINARY).binaryFrames, (unsigned)ws().shimStats(CLIENT_SLOW).textFrames, (unsigned)allocs);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(cycles / 2, broadcasts);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(broadcasts, ws().shimStats(CLIENT_JSON).textFrames);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(broadcasts, ws().shimStats(CLIENT_BINARY).binaryFrames);
+    // 实时数据每 5 秒一帧, 另有每 10 个周期一个历史新增点
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(cycles / 6, ws().shimStats(CLIENT_SLOW).textFrames);
+    TEST_ASSERT_LESS_THAN_UINT32(cycles / 5 + cycles / 10 + 2, ws().shimStats(CLIENT_SLOW).textFrames);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, (uint32_t)allocs, "稳态广播不应分配堆内存");
+}
+
+// -- 健康数据 --
+
+static AsyncWebServerRequest* healthPlain;
+static AsyncWebServerRequest* healthHistory;
+
+static void handleHealthRequests() {
+    http().shimHandle(*healthPlain);
+    healthPlain->shimClose();
+    http().shimHandle(*healthHistory);   // 连接结束前缓冲区保持占用
+}
+
+static void requestHealthOverWebSocket() {
+    ws().shimReceive(CLIENT_JSON, "{\"action\":\"getHealth\",\"history\":true}");
+}
+
+// HTTP 响应直接从静态缓冲区发送; 发送完毕前其他请求得到 503 (WebSocket 得到错误消息)
+static void test_health_allocates_nothing() {
+    if (!allocCountingAvailable()) TEST_IGNORE_MESSAGE("此平台不支持分配计数");
+    AsyncWebServerRequest plain("/api/health");
+    AsyncWebServerRequest history("/api/health");
+    AsyncWebServerRequest busy("/api/health");
+    history.shimAddParam("history", "1");
+    healthPlain = &plain;
+    healthHistory = &history;
+
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)allocsDuring(handleHealthRequests));
+    TEST_ASSERT_EQUAL_INT(200, plain.shimResponse().status);
+    TEST_ASSERT_NOT_NULL(plain.shimResponse().content);
+    TEST_ASSERT_EQUAL_INT(200, history.shimResponse().status);
+    TEST_ASSERT_NOT_NULL(history.shimResponse().content);
+    TEST_ASSERT_GREATER_THAN_UINT32(plain.shimResponse().contentLength, history.shimResponse().contentLength);
+    TEST_ASSERT_LESS_THAN_UINT32(HEALTH_JSON_BUFFER_SIZE, history.shimResponse().contentLength);
+    printf("[SOAK] /api/health: %u B, ?history=1: %u B\n", (unsigned)plain.shimResponse().contentLength,
+           (unsigned)history.shimResponse().contentLength);
+
+    http().shimHandle(busy);
+    TEST_ASSERT_EQUAL_INT(503, busy.shimResponse().status);
+    const uint64_t busyBytes = ws().shimStats(CLIENT_JSON).bytes;
+    requestHealthOverWebSocket();
+    TEST_ASSERT_LESS_THAN_UINT32(200, (uint32_t)(ws().shimStats(CLIENT_JSON).bytes - busyBytes)); // 只有错误消息
+    history.shimClose();
+
+    const uint64_t bytesBefore = ws().shimStats(CLIENT_JSON).bytes;
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)allocsDuring(requestHealthOverWebSocket));
+    TEST_ASSERT_EQUAL_UINT32(history.shimResponse().contentLength, (uint32_t)(ws().shimStats(CLIENT_JSON).bytes - bytesBefore));
+}
+
+// -- connectWifi --
+
+static void requestConnect() {
+    ws().shimReceive(CLIENT_JSON, "{\"action\":\"connectWifi\",\"ssid\":\"HomeNetwork\",\"password\":\"correct horse\"}");
+}
+
+static void requestConnectLongSsid() {
+    ws().shimReceive(CLIENT_JSON, "{\"action\":\"connectWifi\",\"ssid\":\"ssid-longer-than-thirty-two-bytes!\",\"password\":\"x\"}");
+}
+
+static void test_connect_wifi_allocates_nothing() {
+    if (!allocCountingAvailable()) TEST_IGNORE_MESSAGE("此平台不支持分配计数");
+    const uint32_t framesBefore = ws().shimStats(CLIENT_JSON).textFrames;
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)allocsDuring(requestConnect));
+    TEST_ASSERT_EQUAL_INT(WIFI_CP_DISCONNECTING, wifiState.connectProgress);
+    TEST_ASSERT_EQUAL_STRING("HomeNetwork", wifiState.ssidToTry);
+    TEST_ASSERT_EQUAL_STRING("correct horse", wifiState.passwordToTry);
+    TEST_ASSERT_EQUAL_UINT32(framesBefore + 1, ws().shimStats(CLIENT_JSON).textFrames);
+
+    // 超长 SSID 被拒绝, 不截断后连接
+    wifiState.connectProgress = WIFI_CP_IDLE;
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)allocsDuring(requestConnectLongSsid));
+    TEST_ASSERT_EQUAL_INT(WIFI_CP_IDLE, wifiState.connectProgress);
+    TEST_ASSERT_EQUAL_STRING("HomeNetwork", wifiState.ssidToTry);
+}
+
+// -- 发送缓冲区已满的客户端 --
+
+// 不可写的客户端被跳过 (不阻塞, 虚拟时钟不前进), 其他客户端每次发布都收到;
+// 恢复可写后只收到各主题的最新帧
+static void test_stalled_client_does_not_block_others() {
+    ws().shimConnect(CLIENT_STALLED);
+    ws().shimSetWritable(CLIENT_STALLED, false);
+    ws().shimResetStats();
+
+    const uint32_t cycles = 50;
+    uint32_t broadcasts = 0;
+    for (uint32_t i = 0; i < cycles; i++) {
+        shimClockAdvanceMs(1000);
+        const DeviceState state = makeState(i * 3);
+        const unsigned long before = millis();
+        bool published;
+        networkCycle(state, published);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(before, millis(), "发送不应阻塞在不可写的客户端上");
+        broadcasts += published;
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(cycles / 2, broadcasts);
+    TEST_ASSERT_EQUAL_UINT32(broadcasts, ws().shimStats(CLIENT_JSON).textFrames);
+    TEST_ASSERT_EQUAL_UINT32(broadcasts, ws().shimStats(CLIENT_BINARY).binaryFrames);
+    TEST_ASSERT_EQUAL_UINT32(0, ws().shimStats(CLIENT_STALLED).textFrames);
+
+    ws().shimSetWritable(CLIENT_STALLED, true);
+    processWebSocketSubscriptions();
+    TEST_ASSERT_EQUAL_UINT32(1, ws().shimStats(CLIENT_STALLED).textFrames);   // 只有最新的实时数据帧
+    processWebSocketSubscriptions();
+    TEST_ASSERT_EQUAL_UINT32(1, ws().shimStats(CLIENT_STALLED).textFrames);
+    ws().shimDisconnect(CLIENT_STALLED);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_state_broadcast_allocates_nothing);
+    RUN_TEST(test_health_allocates_nothing);
+    RUN_TEST(test_connect_wifi_allocates_nothing);
+    RUN_TEST(test_stalled_client_does_not_block_others);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+#include "trace_replay.h"
+#include "sensor_pipeline.h"
+#include "gas_ppm.h"
+#include <Arduino.h>
+
+// ==========================================================================
+// == CSV ==
+// ==========================================================================
+
+static void writeCsvFloat(FILE* out, float v) {
+    if (isnan(v)) fputs(",", out);
+    else fprintf(out, ",%.4f", v);
+}
+
+bool traceWriteCsv(FILE* out, const TraceRecord* records, size_t count) {
+    fprintf(out, "%s\n", TRACE_CSV_HEADER);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(out, "%u", (unsigned)records[i].timeMs);
+        writeCsvFloat(out, records[i].temperature);
+        writeCsvFloat(out, records[i].humidity);
+        for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) writeCsvFloat(out, records[i].rs[ch]);
+        fputc('\n', out);
+    }
+    return !ferror(out);
+}
+
+// 解析一个字段并跳过其后的逗号, 空字段或 "nan" 为 NaN
+static bool parseCsvFloat(const char*& p, float& out) {
+    char* end;
+    out = strtof(p, &end);
+    if (end == p) out = NAN;
+    p = end;
+    while (*p == ' ') p++;
+    if (*p == ',') { p++; return true; }
+    return *p == '\0' || *p == '\n' || *p == '\r';
+}
+
+size_t traceReadCsv(FILE* in, TraceRecord* out, size_t maxRecords) {
+    char line[256];
+    if (!fgets(line, sizeof(line), in) || strncmp(line, TRACE_CSV_HEADER, strlen(TRACE_CSV_HEADER)) != 0) return 0;
+    size_t count = 0;
+    while (count < maxRecords && fgets(line, sizeof(line), in)) {
+        if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') continue;
+        const char* p = line;
+        char* end;
+        TraceRecord rec;
+        rec.timeMs = (uint32_t)strtoul(p, &end, 10);
+        if (end == p || *end != ',') return 0;
+        p = end + 1;
+        if (!parseCsvFloat(p, rec.temperature) || !parseCsvFloat(p, rec.humidity)) return 0;
+        for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+            if (!parseCsvFloat(p, rec.rs[ch])) return 0;
+        }
+        if (count > 0 && rec.timeMs < out[count - 1].timeMs) return 0;
+        out[count++] = rec;
+    }
+    return count;
+}
+
+// ==========================================================================
+// == 二进制 ==
+// ==========================================================================
+
+static void putLe32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t floatBits(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+bool traceWriteBinary(FILE* out, const TraceRecord* records, size_t count) {
+    if (fwrite(TRACE_BINARY_MAGIC, 1, 4, out) != 4) return false;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t buf[TRACE_BINARY_RECORD_SIZE];
+        putLe32(buf, records[i].timeMs);
+        putLe32(buf + 4, floatBits(records[i].temperature));
+        putLe32(buf + 8, floatBits(records[i].humidity));
+        for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) putLe32(buf + 12 + ch * 4, floatBits(records[i].rs[ch]));
+        if (fwrite(buf, 1, sizeof(buf), out) != sizeof(buf)) return false;
+    }
+    return true;
+}
+
+size_t traceReadBinary(FILE* in, TraceRecord* out, size_t maxRecords) {
+    char magic[4];
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, TRACE_BINARY_MAGIC, 4) != 0) return 0;
+    size_t count = 0;
+    uint8_t buf[TRACE_BINARY_RECORD_SIZE];
+    while (count < maxRecords) {
+        size_t n = fread(buf, 1, sizeof(buf), in);
+        if (n == 0) break;
+        if (n != sizeof(buf)) return 0; // 截断的记录
+        TraceRecord& rec = out[count];
+        rec.timeMs = getLe32(buf);
+        rec.temperature = bitsFloat(getLe32(buf + 4));
+        rec.humidity = bitsFloat(getLe32(buf + 8));
+        for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) rec.rs[ch] = bitsFloat(getLe32(buf + 12 + ch * 4));
+        if (count > 0 && rec.timeMs < out[count - 1].timeMs) return 0;
+        count++;
+    }
+    return count;
+}
+
+size_t traceLoad(const char* path, TraceRecord* out, size_t maxRecords) {
+    FILE* in = fopen(path, "rb");
+    if (!in) return 0;
+    char magic[4];
+    const bool binary = fread(magic, 1, 4, in) == 4 && memcmp(magic, TRACE_BINARY_MAGIC, 4) == 0;
+    rewind(in);
+    size_t count = binary ? traceReadBinary(in, out, maxRecords) : traceReadCsv(in, out, maxRecords);
+    fclose(in);
+    return count;
+}
+
+// ==========================================================================
+// == 回放数据源 ==
+// ==========================================================================
+
+static const TraceRecord* traceRecords = NULL;
+static size_t traceCount = 0;
+static size_t traceCursor = 0;
+static const TraceRecord* traceDhtRecord = NULL; // startDht() 时的记录, 下一次 fetchDht() 返回
+static bool traceDhtStarted = false;
+
+void traceSourceBegin(const TraceRecord* records, size_t count) {
+    traceRecords = records;
+    traceCount = count;
+    traceCursor = 0;
+    traceDhtRecord = NULL;
+    traceDhtStarted = false;
+}
+
+// 不晚于 millis() 的最后一条记录, 第一条记录之前返回 NULL
+static const TraceRecord* currentRecord() {
+    const unsigned long now = millis();
+    if (traceCursor > 0 && traceRecords[traceCursor - 1].timeMs > now) traceCursor = 0; // 时钟回拨 (重新回放)
+    while (traceCursor < traceCount && traceRecords[traceCursor].timeMs <= now) traceCursor++;
+    return traceCursor > 0 ? &traceRecords[traceCursor - 1] : NULL;
+}
+
+static GasReadResult readTraceGas(GasRawReading& out) {
+    const TraceRecord* rec = currentRecord();
+    if (!rec) return GAS_READ_ABSENT;
+    uint32_t* adc[GAS_CHANNEL_COUNT] = { &out.co, &out.no2, &out.c2h5oh, &out.voc };
+    for (size_t ch = 0; ch < GAS_CHANNEL_COUNT; ch++) {
+        if (!(rec->rs[ch] > 0)) return GAS_READ_FAILED;
+        *adc[ch] = (uint32_t)rsToAdc(rec->rs[ch]);
+    }
+    return GAS_READ_OK;
+}
+
+static DhtRmtResult fetchTraceDht(DhtReading& out) {
+    if (!traceDhtStarted) return DHT_RMT_NONE;
+    traceDhtStarted = false;
+    const TraceRecord* rec = traceDhtRecord;
+    if (!rec) return DHT_RMT_NONE;
+    if (isnan(rec->temperature) || isnan(rec->humidity)) return DHT_RMT_FAILED;
+    out.temperature = rec->temperature;
+    out.humidity = rec->humidity;
+    return DHT_RMT_OK;
+}
+
+static void startTraceDht() {
+    traceDhtRecord = currentRecord();
+    traceDhtStarted = true;
+}
+
+const SensorSource TRACE_SENSOR_SOURCE = { "trace", readTraceGas, fetchTraceDht, startTraceDht };
+
+// ==========================================================================
+// == 回放驱动 ==
+// ==========================================================================
+
+static void emitStatusChange(FILE* out, unsigned long t, const char* target, SensorStatusVal before, SensorStatusVal after,
+                             float value, ReplaySummary& summary) {
+    if (before == after) return;
+    if (after == SS_WARNING) summary.warnings++;
+    if (!out) return;
+    fprintf(out, "%lu,%s,%s,", t, target, getSensorStatusString(after));
+    if (!isnan(value)) fprintf(out, "%.3f", value);
+    fputc('\n', out);
+}
+
+static void emitAlarmEvents(FILE* out, unsigned long t, const DeviceState& prev, const DeviceState& s, ReplaySummary& summary) {
+    emitStatusChange(out, t, "temperature", prev.tempStatus, s.tempStatus, (float)s.temperature, summary);
+    emitStatusChange(out, t, "humidity", prev.humStatus, s.humStatus, s.humidity, summary);
+    emitStatusChange(out, t, "co", prev.gasCoStatus, s.gasCoStatus, s.gasPpmValues.co, summary);
+    emitStatusChange(out, t, "no2", prev.gasNo2Status, s.gasNo2Status, s.gasPpmValues.no2, summary);
+    emitStatusChange(out, t, "c2h5oh", prev.gasC2h5ohStatus, s.gasC2h5ohStatus, s.gasPpmValues.c2h5oh, summary);
+    emitStatusChange(out, t, "voc", prev.gasVocStatus, s.gasVocStatus, s.gasPpmValues.voc, summary);
+}
+
+ReplaySummary replayRun(const SensorSource& source, const ReplayOptions& options, HistoryBuffer& hist) {
+    const uint32_t samplesPerReport = SENSOR_READ_INTERVAL_MS / GAS_OVERSAMPLE_INTERVAL_MS;
+    ReplaySummary summary;
+    DeviceState& state = summary.finalState;
+
+    shimClockSetUs(0);
+    shimPinsReset();
+    gasSensorWarmupEndTime = options.warmupMs;
+    resetSensorPipeline();
+    setSensorSource(&source);
+    if (options.alarmOut) fputs("time_ms,target,event,value\n", options.alarmOut);
+    if (options.historyOut) fputs("time_ms,time_str,temp,hum,co,no2,c2h5oh,voc\n", options.historyOut);
+
+    uint32_t sampleCount = 0;
+    int buzzerLevel = LOW;
+    for (unsigned long t = GAS_OVERSAMPLE_INTERVAL_MS; t <= options.durationMs; t += GAS_OVERSAMPLE_INTERVAL_MS) {
+        shimClockSetUs((uint64_t)t * 1000);
+        sampleGasSensor(t);
+        if (++sampleCount >= samplesPerReport) {
+            sampleCount = 0;
+            const DeviceState prev = state;
+            processSensorReport(state, t);
+            summary.reports++;
+            emitAlarmEvents(options.alarmOut, t, prev, state, summary);
+
+            const uint32_t historyRevision = getHistoryRevision();
+            addHistoricalDataPoint(hist, state, t, true);
+            if (getHistoryRevision() != historyRevision) { // 没有有效读数时不记录
+                const SensorDataPoint& dp = hist.newest();
+                summary.historyPoints++;
+                if (options.historyOut) {
+                    fprintf(options.historyOut, "%lu,%s,%d,%d,%.3f,%.3f,%.3f,%.3f\n", t, dp.timeStr, dp.temp, dp.hum,
+                            dp.gas.co, dp.gas.no2, dp.gas.c2h5oh, dp.gas.voc);
+                }
+            }
+        }
+
+        // loop 任务的蜂鸣器节奏, 此处以过采样周期为时间粒度
+        controlBuzzer(state, t);
+        const int level = digitalRead(BUZZER_PIN);
+        if (level != buzzerLevel) {
+            buzzerLevel = level;
+            if (level == HIGH) summary.buzzerBeeps++;
+            if (options.alarmOut) fprintf(options.alarmOut, "%lu,buzzer,%s,\n", t, level == HIGH ? "on" : "off");
+        }
+    }
+
+    setSensorSource(NULL);
+    return summary;
+}
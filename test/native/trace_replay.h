@@ -0,0 +1,61 @@
+#ifndef NATIVE_TRACE_REPLAY_H
+#define NATIVE_TRACE_REPLAY_H
+
+// ==========================================================================
+// == 现场记录回放 (主机) ==
+// == 记录为按时间排列的 Rs/温湿度样本, 可以是 CSV 或紧凑二进制格式.
+// == 回放数据源按虚拟时钟 (millis()) 返回不晚于当前时间的最后一条记录 (采样保持),
+// == Rs 用 rsToAdc() 换回 ADC 码; 值为 NaN 的字段视为该次读取失败.
+// == replayRun() 以与采样任务相同的节奏驱动
+// ==   过采样 -> 上报 (校准 -> 换算 -> 警报 -> 基线) -> 蜂鸣器 -> 历史记录
+// == 并把警报事件流和历史记录流以 CSV 写出.
+// ==========================================================================
+
+#include <stdio.h>
+#include "data_manager.h"
+#include "sensor_source.h"
+
+struct TraceRecord {
+    uint32_t timeMs;
+    float temperature;               // °C, NaN 表示温湿度读取失败
+    float humidity;                  // %
+    float rs[GAS_CHANNEL_COUNT];     // kOhm, 任一通道为 NaN 表示该次气体读取失败
+};
+
+// CSV: 首行为表头 time_ms,temperature,humidity,rs_co,rs_no2,rs_c2h5oh,rs_voc, 空字段或 nan 为 NaN
+#define TRACE_CSV_HEADER "time_ms,temperature,humidity,rs_co,rs_no2,rs_c2h5oh,rs_voc"
+// 二进制: 4字节魔数 "GTR1", 之后每条记录 28 字节 (小端 uint32 时间 + 6 个 float32)
+#define TRACE_BINARY_MAGIC "GTR1"
+#define TRACE_BINARY_RECORD_SIZE 28
+
+bool traceWriteCsv(FILE* out, const TraceRecord* records, size_t count);
+bool traceWriteBinary(FILE* out, const TraceRecord* records, size_t count);
+// 读取到 out (最多 maxRecords 条), 返回条数; 格式错误或时间倒退时返回 0
+size_t traceReadCsv(FILE* in, TraceRecord* out, size_t maxRecords);
+size_t traceReadBinary(FILE* in, TraceRecord* out, size_t maxRecords);
+size_t traceLoad(const char* path, TraceRecord* out, size_t maxRecords); // 按魔数判断格式
+
+// 回放数据源: 引用 records, 回放期间须保持有效
+void traceSourceBegin(const TraceRecord* records, size_t count);
+extern const SensorSource TRACE_SENSOR_SOURCE;
+
+struct ReplayOptions {
+    unsigned long durationMs;        // 回放时长 (虚拟时间, 从 0 开始)
+    unsigned long warmupMs;          // 气体传感器预热时间 (gasSensorWarmupEndTime)
+    FILE* alarmOut;                  // 警报事件流: time_ms,target,event,value (NULL 不输出)
+    FILE* historyOut;                // 历史记录流: time_ms,time_str,temp,hum,co,no2,c2h5oh,voc (NULL 不输出)
+};
+
+struct ReplaySummary {
+    uint32_t reports = 0;            // 上报周期数
+    uint32_t warnings = 0;           // 进入 warning 的次数 (所有通道合计)
+    uint32_t buzzerBeeps = 0;        // 蜂鸣器响的次数
+    uint32_t historyPoints = 0;      // 写入历史的点数
+    DeviceState finalState;
+};
+
+// 用 source 替换当前数据源 (setSensorSource), 结束后恢复硬件数据源.
+// 使用当前发布的运行参数 (publishSensorParams), 历史写入 hist 和 SPIFFS 替身
+ReplaySummary replayRun(const SensorSource& source, const ReplayOptions& options, HistoryBuffer& hist);
+
+#endif // NATIVE_TRACE_REPLAY_H